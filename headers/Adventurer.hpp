@@ -2,43 +2,163 @@
 
 #include "./Entity.hpp"
 #include "./Item.hpp"
+#include "./Inventory.hpp"
+#include "./ItemCooldowns.hpp"
+#include "./Progression.hpp"
 #include "./../source/Enemy.cpp"
 #include "./../source/InputReader.cpp"
 #include <vector>
+#include <functional>
 #include <math.h>
 
+class Adventurer;
+
+// the most abilities any one class can have
+const int MAX_ABILITIES = 5;
+
+// who an ability gets used on. single target abilities prompt the user to pick an enemy
+enum TargetMode{SINGLE_TARGET, ALL_TARGETS, SELF_TARGET};
+
+// what an ability actually does. gets the list of enemies and the picked target (nullptr unless SINGLE_TARGET)
+typedef void (Adventurer::*AbilityEffect)(std::vector<Enemy*>&, Enemy*);
+
+/**
+ * AbilityDef: a row in a class's ability table. 
+ * The ability is unlocked once the character reaches (unlockLevel), and goes on cooldown for (cooldown) turns after it is used. 
+ * */
+struct AbilityDef {
+	const char* name;
+	int cooldown;
+	int unlockLevel;
+	TargetMode target;
+	AbilityEffect effect;
+	const char* description;
+};
+
+// how many numbers a class gets to save its own state in (see classState())
+const int CLASS_STATE_SIZE = 4;
+
+/**
+ * BagSlot: one inventory slot as it stood at some point, see Item::saveState().
+ * */
+struct BagSlot {
+	unsigned id, count;
+	int cooldown;
+	unsigned state;
+
+	bool operator==(const BagSlot& other) const {
+		return id == other.id && count == other.count && cooldown == other.cooldown && state == other.state;
+	}
+};
+
+/**
+ * HeroState: everything about a character that can change during a fight, see Adventurer::captureCombatState().
+ * Gold and experience are left out, they only change once the fight is over.
+ * */
+struct HeroState {
+	EntityState entity;
+	int abilityCD[MAX_ABILITIES];
+	int classState[CLASS_STATE_SIZE];
+	std::vector<BagSlot> bag;
+
+	bool operator==(const HeroState& other) const {
+		for (int i = 0; i < MAX_ABILITIES; ++i) if (abilityCD[i] != other.abilityCD[i]) return false;
+		for (int i = 0; i < CLASS_STATE_SIZE; ++i) if (classState[i] != other.classState[i]) return false;
+		return entity == other.entity && bag == other.bag;
+	}
+};
+
+/**
+ * CombatAction: one thing the hero can do with their turn.
+ * index is the ability's position in the ability table or the item's bag slot, target is the enemy's position in the fight
+ * (-1 when the move doesn't need one).
+ * */
+struct CombatAction {
+	enum Kind{ATTACK, ABILITY, ITEM};
+	Kind kind = ATTACK;
+	int index = -1, target = -1;
+
+	bool operator==(const CombatAction& other) const {
+		return kind == other.kind && index == other.index && target == other.target;
+	}
+};
+
+/**
+ * MovePreview: looks ahead at how the hero's moves would go while the turn menu waits for the player. See TurnPreview.
+ * */
+class MovePreview {
+	public:
+		virtual ~MovePreview() = default;
+		/** Returns a short summary of how a move has gone so far, or an empty string if too little is known yet. */
+		virtual std::string note(const CombatAction&) = 0;
+		/** Stops looking ahead. The turn menu calls this as soon as the player has settled on a move. */
+		virtual void stop() = 0;
+};
+
 class Adventurer : public Entity
 {
+	friend class SaveGame;
 	public:
 		Adventurer(std::string, std::string);
 		~Adventurer();
+		virtual Adventurer* clone() const;
 		// modification methods
-		virtual void levelUp();
+		void levelUp();
+		void applyLevels(int);
 		void addGold(int);
 		void addExp(int);
 		void addItem(Item*);
 		void setHealth(double);
 		void setHealth(int);
+		void setGrowth(const StatGrowth&);
 
 		// viewing methods
 		int getLevel() const; 
                 int getGold() const;
                 int getInvSize() const;
-		virtual void inspect();
+		double xpToNextLevel() const;
+		const StatGrowth& getGrowth() const;
+		void inspect();
 		void checkInventory();
 		virtual void printSpecialFeature();
 		// behaviors
 		void deathPenalty();
 		void turn(std::vector<Enemy*>);
+		void autoTurn(std::vector<Enemy*>&);
 		virtual void attack(Enemy*);
-		int selectTarget(std::vector<Enemy*>);
-		virtual int ability(std::vector<Enemy*>);
+		int selectTarget(std::vector<Enemy*>, const CombatAction* = nullptr);
+		int ability(std::vector<Enemy*>);
+		void useAbility(int, std::vector<Enemy*>&, Enemy*);
+		bool useItem(unsigned, Enemy*);
+		Item* itemAt(unsigned) const;
+		void setHint(std::function<void()>);
+		void setPreview(MovePreview*);
+		bool abilityUnlocked(int) const;
+		bool abilityReady(int) const;
+		std::vector<int> readyAbilities() const;
+		int getAbilityCooldown(int) const;
+		virtual const std::vector<AbilityDef>& abilityTable() const;
+		virtual void classState(int*) const;
+		virtual void setClassState(const int*);
 		void updateCooldowns();
+		void updateItemCooldowns();
+		unsigned itemsOnCooldown() const;
+		HeroState captureCombatState() const;
+		void restoreCombatState(const HeroState&, Item* (*)(unsigned));
 	protected:
+		Adventurer(const Adventurer&);
+		int chooseItem(bool (*)(Item*), bool, bool = false);
+		std::string previewNote(CombatAction::Kind, int, int) const;
+		virtual std::string className() const;
+		virtual std::string levelUpFlavor() const;
+		virtual void onUnlock(int);
 		int level = 1, experience = 0, gold = 0; 
 		int maxHealthBonus = 0, physAtkBonus = 0, physDefBonus = 0, magAtkBonus = 0, magDefBonus = 0, speedBonus = 0;
-		int hpLvl = 0, pAtkLvl = 0, pDefLvl = 0, mAtkLvl = 0, mDefLvl = 0, spdLvl = 0;
-		// max cd is set to -1 if the ability is not unlocked yet. 
-		int abi1CD = 0, abi1MaxCD = -1, abi2CD = 0, abi2MaxCD = -1, abi3CD = 0, abi3MaxCD = -1, abi4CD = 0, abi4MaxCD = -1, abi5CD = 0, abi5MaxCD = -1;
-		std::vector<Item*> inventory;
+		StatGrowth growth = {0, 0, 0, 0, 0, 0};
+		// turns left until each ability in the ability table is ready again
+		int abilityCD[MAX_ABILITIES] = {0, 0, 0, 0, 0};
+		Inventory inventory;
+		ItemCooldowns itemCooldowns;
+		std::function<void()> hint; // offered in the turn menu while it is set, see setHint()
+		MovePreview* preview = nullptr; // shown in the turn menu while it is set, see setPreview()
 }; 
@@ -0,0 +1,154 @@
+#ifndef __BIOME_H__
+#define __BIOME_H__
+
+#include "./Loot.hpp"
+#include "./Progression.hpp"
+#include "./Factory.hpp"
+#include "./Dungeon.hpp"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/**
+ * EncounterEntry: something that can show up in a biome, either an enemy or a room, given by its factory ID.
+ * It only shows up for players between minLevel and maxLevel (inclusive), and is picked in proportion to its weight.
+ * */
+struct EncounterEntry {
+    unsigned id;
+    double weight;
+    int minLevel, maxLevel;
+
+    EncounterEntry(unsigned id, double weight, int minLevel = 1, int maxLevel = LEVEL_CAP)
+        : id(id), weight(weight), minLevel(minLevel), maxLevel(maxLevel) {}
+};
+
+/**
+ * EncounterTable: a weighted list of encounters that depends on the player's level.
+ * Every level bracket boundary splits the levels into ranges where the same entries are allowed. Each range gets its own
+ * alias table when the table is made, so picking an encounter is a binary search over the ranges and an O(1) roll,
+ * no matter how many entries there are.
+ * */
+class EncounterTable {
+private:
+    std::vector<int> starts; // the first level of each range, in order
+    std::vector<std::vector<unsigned> > ids; // the IDs allowed in each range
+    std::vector<AliasTable> tables; // the weights of those IDs
+
+public:
+    EncounterTable() = default;
+
+    explicit EncounterTable(const std::vector<EncounterEntry>& entries){
+        // every place an entry starts or stops being allowed begins a new range
+        starts.push_back(1);
+        for (const EncounterEntry& e : entries){
+            starts.push_back(e.minLevel);
+            starts.push_back(e.maxLevel + 1);
+        }
+        std::sort(starts.begin(), starts.end());
+        starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+        while (!starts.empty() && starts.back() > LEVEL_CAP) starts.pop_back();
+
+        for (int start : starts){
+            std::vector<unsigned> rangeIds;
+            std::vector<double> weights;
+            for (const EncounterEntry& e : entries){
+                if (e.weight <= 0 || start < e.minLevel || start > e.maxLevel) continue;
+                rangeIds.push_back(e.id);
+                weights.push_back(e.weight);
+            }
+            ids.push_back(rangeIds);
+            tables.push_back(AliasTable(weights));
+        }
+    }
+
+    /**
+     * sample(): picks an encounter for a player of a given level.
+     * args: level (the player's level)
+     * outputs: the picked ID, or 0 if nothing is allowed at that level
+     * */
+    unsigned sample(int level) const {
+        unsigned range = rangeOf(level);
+        if (ids[range].empty()) return 0;
+        return ids[range][tables[range].sample()];
+    }
+
+    /** This is a version of the above sample that rolls with a given generator instead of rand(). */
+    unsigned sample(int level, std::mt19937& rng) const {
+        unsigned range = rangeOf(level);
+        if (ids[range].empty()) return 0;
+        return ids[range][tables[range].sample(rng)];
+    }
+
+    /** Returns true if anything at all can be picked at a given level. */
+    bool available(int level) const {
+        return !ids[rangeOf(level)].empty();
+    }
+
+private:
+    unsigned rangeOf(int level) const {
+        level = std::max(1, std::min(level, LEVEL_CAP));
+        return std::upper_bound(starts.begin(), starts.end(), level) - starts.begin() - 1;
+    }
+};
+
+/**
+ * encountersMatching(): turns everything in the content index that passes a query into encounter entries,
+ * using each definition's level range and weight.
+ * args: q (the query)
+ * outputs: the matching encounters
+ * */
+inline std::vector<EncounterEntry> encountersMatching(const ContentQuery& q){
+    std::vector<EncounterEntry> entries;
+    for (unsigned id : contentIndex().query(q)){
+        const ContentDef& def = contentIndex().get(id);
+        entries.push_back(EncounterEntry(id, def.attrs[ATTR_WEIGHT], def.attrs[ATTR_MIN_LEVEL], def.attrs[ATTR_MAX_LEVEL]));
+    }
+    return entries;
+}
+
+/**
+ * QuestLayout: the rules every quest in a biome follows no matter what gets rolled.
+ * dungeon decides the shape of the map and how many arenas, oddities and locked areas it has (see Dungeon.hpp).
+ * */
+struct QuestLayout {
+    DungeonParams dungeon;
+    unsigned arenaMin, arenaMax; // enemies per arena, and per guarded gate
+    unsigned bossAlliesMin, bossAlliesMax; // enemies alongside the boss
+};
+
+/**
+ * Biome: a theme for a quest. Decides which enemies, rooms and oddities show up and how the quest is laid out.
+ * */
+struct Biome {
+    std::string name;
+    EncounterTable enemies, ambientRooms, oddityRooms;
+    QuestLayout layout;
+
+    Biome(std::string name, const std::vector<EncounterEntry>& enemies, const std::vector<EncounterEntry>& ambientRooms,
+          const std::vector<EncounterEntry>& oddityRooms, QuestLayout layout)
+        : name(name), enemies(enemies), ambientRooms(ambientRooms), oddityRooms(oddityRooms), layout(layout) {}
+
+    /** Builds a biome out of every enemy, ambient room and oddity room in the content index that carries a given tag. */
+    Biome(std::string name, ContentTag where, QuestLayout layout)
+        : Biome(name, encountersMatching(ContentQuery().with(TAG_ENEMY).with(where)),
+                encountersMatching(ContentQuery().with(TAG_AMBIENT_ROOM).with(where)),
+                encountersMatching(ContentQuery().with(TAG_ODDITY_ROOM).with(where)), layout) {}
+};
+
+/**
+ * biomeCatalog(): every biome a quest can take place in. Built the first time it is asked for.
+ * What shows up in each one comes from the location tags in contentIndex().
+ * args: none
+ * outputs: the list of biomes
+ * */
+inline const std::vector<Biome>& biomeCatalog(){
+    static const std::vector<Biome> catalog = {
+        Biome("the Crypt", TAG_CRYPT, QuestLayout{{10, 2, 1, 1, 1}, 2, 5, 2, 5}),
+        Biome("the Wilds", TAG_WILDS, QuestLayout{{8, 2, 0, 1, 1}, 1, 5, 2, 6}),
+        Biome("the Caverns", TAG_CAVE, QuestLayout{{12, 3, 1, 2, 1}, 1, 4, 2, 5})
+    };
+    return catalog;
+}
+
+#endif
@@ -0,0 +1,473 @@
+#ifndef __COMBAT_SEARCH_H__
+#define __COMBAT_SEARCH_H__
+
+#include "./Adventurer.hpp"
+#include "./Factory.hpp"
+#include "./Console.hpp"
+#include "./Dice.hpp"
+#include "./CombatSnapshot.hpp"
+#include "./../source/CombatRoom.cpp"
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+// how long the search gets to think about a move when the player asks for advice
+const unsigned SEARCH_HINT_MS = 150;
+// how many moves deep the tree goes before a playout takes over, and how many more turns a playout lasts before it is scored as is
+const unsigned SEARCH_DEPTH = 24;
+const unsigned SEARCH_PLAYOUT_TURNS = 120;
+// the transposition table is split into this many shards, each with its own lock, so workers rarely wait on each other
+const unsigned SEARCH_SHARDS = 64;
+// the most positions one shard remembers. Past that, new positions are played out without being added
+const unsigned SEARCH_SHARD_LIMIT = 4096;
+// how much the search favours trying moves it knows little about over the ones that have done well so far
+const double SEARCH_EXPLORATION = 0.7;
+
+/**
+ * ActionScore: how one move did over the playouts that started with it. value is summed over every visit, see scoreFight().
+ * */
+struct ActionScore {
+    CombatAction action;
+    unsigned visits = 0, wins = 0;
+    double value = 0;
+
+    double averageValue() const {
+        return visits == 0 ? 0 : value / visits;
+    }
+
+    double winChance() const {
+        return visits == 0 ? 0 : (double)wins / visits;
+    }
+};
+
+/**
+ * SearchResult: what a search found. scores are the hero's moves right now, best first.
+ * */
+struct SearchResult {
+    std::vector<ActionScore> scores;
+    unsigned long playouts = 0;
+    unsigned threads = 0;
+
+    bool empty() const {
+        return scores.empty();
+    }
+
+    const CombatAction& best() const {
+        return scores.front().action;
+    }
+};
+
+/**
+ * legalActions(): lists every move the hero can make right now: attacking each enemy still standing, every ready ability (once
+ * per enemy if it needs a target) and every ready item. Items that stop to ask the player something are left out.
+ * args: hero (the one whose turn it is), foes (the enemies still in the fight)
+ * outputs: the moves
+ * */
+inline std::vector<CombatAction> legalActions(const Adventurer* hero, const std::vector<Enemy*>& foes){
+    std::vector<int> targets;
+    for (unsigned t = 0; t < foes.size(); ++t){
+        if (foes[t]->isAlive()) targets.push_back(t);
+    }
+
+    std::vector<CombatAction> actions;
+    CombatAction action;
+    for (int t : targets){
+        action.target = t;
+        actions.push_back(action);
+    }
+
+    const std::vector<AbilityDef>& abilities = hero->abilityTable();
+    action.kind = CombatAction::ABILITY;
+    for (int index : hero->readyAbilities()){
+        action.index = index;
+        if (abilities[index].target != SINGLE_TARGET){
+            action.target = -1;
+            actions.push_back(action);
+        }
+        else for (int t : targets){
+            action.target = t;
+            actions.push_back(action);
+        }
+    }
+
+    action.kind = CombatAction::ITEM;
+    for (unsigned slot = 0; slot < (unsigned)hero->getInvSize(); ++slot){
+        Item* item = hero->itemAt(slot);
+        if (!item->abilityAvailable() || item->asksPlayer()) continue;
+        action.index = slot;
+        if (item->isSelfUse()){
+            action.target = -1;
+            actions.push_back(action);
+        }
+        else for (int t : targets){
+            action.target = t;
+            actions.push_back(action);
+        }
+    }
+    return actions;
+}
+
+/**
+ * describeAction(): puts a move into words, the way the turn menu would lead up to it.
+ * args: action (the move), hero (who makes it), foes (the enemies in the fight)
+ * outputs: the description
+ * */
+inline std::string describeAction(const CombatAction& action, Adventurer* hero, const std::vector<Enemy*>& foes){
+    std::string text;
+    if (action.kind == CombatAction::ATTACK) text = "Attack";
+    else if (action.kind == CombatAction::ABILITY) text = std::string("Use ") + hero->abilityTable()[action.index].name;
+    else text = "Use " + hero->itemAt(action.index)->getName();
+    if (action.target >= 0){
+        text += (action.kind == CombatAction::ATTACK ? " " : " on ") + foes[action.target]->getName()
+                + " (" + std::to_string(action.target + 1) + ")";
+    }
+    return text;
+}
+
+/**
+ * performAction(): makes a move and cycles the hero's cooldowns, like turn() does once a move has been picked.
+ * args: action (a move from legalActions() for this same fight), hero (who makes it), foes (the enemies in the fight)
+ * outputs: none
+ * */
+inline void performAction(const CombatAction& action, Adventurer* hero, std::vector<Enemy*>& foes){
+    Enemy* target = action.target >= 0 ? foes[action.target] : nullptr;
+    if (action.kind == CombatAction::ATTACK) hero->attack(target);
+    else if (action.kind == CombatAction::ABILITY) hero->useAbility(action.index, foes, target);
+    else hero->useItem(action.index, target);
+    hero->updateCooldowns();
+    hero->updateItemCooldowns();
+}
+
+/** Hands every enemy whose bar is full their turn, in fight order, like CombatRoom::interact(). */
+inline void enemiesAct(Adventurer* fighter, std::vector<Enemy*>& foes){
+    for (auto e : foes){
+        if (!fighter->isAlive()) break;
+        if (e->getTurnBar() >= MAX_TURN_BAR){
+            e->turn(fighter);
+            e->updateBuffs();
+            e->setTurnBar(e->getTurnBar() - MAX_TURN_BAR);
+        }
+    }
+}
+
+/** Takes the enemies that have fallen out of the fight and deletes them. */
+inline void removeFallenFoes(std::vector<Enemy*>& foes){
+    for (std::vector<Enemy*>::iterator it = foes.begin(); it != foes.end(); /* nothing */ ){
+        if (!(*it)->isAlive()){
+            delete *it;
+            it = foes.erase(it);
+        }
+        else ++it;
+    }
+}
+
+/** Returns whether the fight is over, for the hero or for the enemies. */
+inline bool fightOver(Adventurer* fighter, const std::vector<Enemy*>& foes){
+    return !fighter->isAlive() || foes.empty();
+}
+
+/**
+ * playToTurn(): ticks the turn bars until the hero's is full or the fight is over. Enemies that fill up first take their turns.
+ * Starting a fight from the top with this puts it at the hero's first turn.
+ * args: fighter (the hero), foes (the enemies in the fight)
+ * outputs: none
+ * */
+inline void playToTurn(Adventurer* fighter, std::vector<Enemy*>& foes){
+    while (!fightOver(fighter, foes)){
+        int ticks = CombatRoom::ticksToFill(fighter);
+        for (auto e : foes) ticks = CombatRoom::fewerTicks(ticks, CombatRoom::ticksToFill(e));
+        if (ticks <= 0) ticks = 1;
+        fighter->addTurnBar(fighter->getSpeed() * ticks);
+        for (auto e : foes) e->addTurnBar(e->getSpeed() * ticks);
+        if (fighter->getTurnBar() >= MAX_TURN_BAR) return;
+        enemiesAct(fighter, foes);
+    }
+}
+
+/**
+ * finishTurn(): plays on from the hero having made their move to their next turn, or to the end of the fight.
+ * Follows the same order as CombatRoom::interact(): the rest of the round first, then ticking the bars until someone is ready.
+ * args: fighter (the hero, who has just moved), foes (the enemies in the fight, fallen ones get deleted)
+ * outputs: none
+ * */
+inline void finishTurn(Adventurer* fighter, std::vector<Enemy*>& foes){
+    fighter->updateBuffs();
+    fighter->setTurnBar(fighter->getTurnBar() - MAX_TURN_BAR);
+    removeFallenFoes(foes);
+    enemiesAct(fighter, foes);
+    playToTurn(fighter, foes);
+}
+
+/**
+ * CombatSearch: works out the hero's best move with a Monte Carlo tree search. Every playout starts from the fight as it is,
+ * picks moves down a tree of the positions seen so far, favouring the ones that have done well while still trying the rest,
+ * then lets autoTurn() play the fight out and scores how it went.
+ * Positions are kept in a transposition table keyed by a hash of every fighter's state, so a position reached by different
+ * moves is only learned about once. Workers each play on their own copy of the fight, and share the table.
+ * The search only plays the hero whose turn it is. In a party, enemies are assumed to always go after them.
+ * The dice aren't part of a position, so everything a move can lead to is averaged into the same place in the tree.
+ * */
+class CombatSearch {
+private:
+    struct Node {
+        std::vector<ActionScore> scores; // one per legal move
+        unsigned visits = 0;
+    };
+
+    struct Shard {
+        std::mutex lock;
+        std::unordered_map<uint64_t, Node> nodes;
+    };
+
+    struct Step {
+        Shard* shard;
+        Node* node; // nodes never move once added, even as the table grows
+        unsigned action;
+    };
+
+    CombatSnapshot root;
+    Adventurer* hero;
+    uint64_t rootKey;
+    int rootFoeHealth = 0;
+    std::vector<Shard> shards;
+    std::atomic<unsigned long> playouts;
+
+    static void mix(uint64_t& seed, uint64_t value){
+        seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    }
+
+    static void mixEntity(uint64_t& seed, const EntityState& state){
+        const int fields[] = {state.health, state.maxHealth, state.physAtk, state.physDef, state.magAtk, state.magDef, state.speed,
+                              state.turnBar, state.pAtkBuff, state.pDefBuff, state.mAtkBuff, state.mDefBuff, state.spdBuff,
+                              state.pAtkOrig, state.pDefOrig, state.mAtkOrig, state.mDefOrig, state.spdOrig, state.extra};
+        for (int field : fields) mix(seed, (uint32_t)field);
+    }
+
+    /**
+     * scoreFight(): how well a playout went, from 0 to 1. A win is worth at least 0.5, more the more health is left.
+     * A loss is worth up to 0.25 for how much of the enemies' health was taken off, so the search still fights back when it
+     * can't win. A playout that ran out of turns gets a bit of both.
+     * */
+    double scoreFight(Adventurer* fighter, const std::vector<Enemy*>& foes, bool& won) const {
+        int foeHealth = 0;
+        for (auto e : foes) foeHealth += std::max(0, e->getCurrentHealth());
+        double dealt = rootFoeHealth <= 0 ? 1 : 1 - (double)foeHealth / rootFoeHealth;
+        double left = fighter->getMaxHealth() <= 0 ? 0 : (double)std::max(0, fighter->getCurrentHealth()) / fighter->getMaxHealth();
+        won = fighter->isAlive() && foes.empty();
+        if (won) return 0.5 + 0.5 * left;
+        if (!fighter->isAlive()) return 0.25 * dealt;
+        return 0.25 * dealt + 0.25 * left;
+    }
+
+    /** Picks the move to try from a position: one that hasn't been tried yet if there is any, otherwise the best by UCB1. */
+    static unsigned select(Node& node, std::minstd_rand& dice){
+        unsigned untried = 0, pick = 0;
+        for (unsigned a = 0; a < node.scores.size(); ++a){
+            // among untried moves, each is equally likely to be picked
+            if (node.scores[a].visits == 0 && dice() % ++untried == 0) pick = a;
+        }
+        if (untried > 0) return pick;
+
+        double best = -1, logVisits = std::log((double)node.visits);
+        for (unsigned a = 0; a < node.scores.size(); ++a){
+            const ActionScore& score = node.scores[a];
+            double ucb = score.averageValue() + SEARCH_EXPLORATION * std::sqrt(logVisits / score.visits);
+            if (ucb > best){
+                best = ucb;
+                pick = a;
+            }
+        }
+        return pick;
+    }
+
+    /**
+     * playout(): one pass of the search on a worker's copy of the fight: down the tree, then autoTurn() to the end,
+     * then the score goes back up every move that led there.
+     * A move's visit is counted on the way down, so other workers see it as taken and spread out over other moves.
+     * */
+    void playout(Adventurer* fighter, std::vector<Enemy*>& foes, std::minstd_rand& dice){
+        CombatTally tally;
+        root.restore(std::vector<Adventurer*>(1, fighter), foes, tally);
+        combatDice().seed(dice());
+
+        std::vector<Step> path;
+        for (unsigned depth = 0; depth < SEARCH_DEPTH && !fightOver(fighter, foes); ++depth){
+            uint64_t key = positionHash(fighter, foes);
+            Shard& shard = shards[key % SEARCH_SHARDS];
+            bool added = false;
+            Step step;
+            step.shard = &shard;
+            {
+                std::unique_lock<std::mutex> guard(shard.lock);
+                std::unordered_map<uint64_t, Node>::iterator it = shard.nodes.find(key);
+                if (it == shard.nodes.end()){
+                    if (shard.nodes.size() >= SEARCH_SHARD_LIMIT) break;
+                    guard.unlock();
+                    Node fresh;
+                    for (const CombatAction& action : legalActions(fighter, foes)){
+                        ActionScore score;
+                        score.action = action;
+                        fresh.scores.push_back(score);
+                    }
+                    guard.lock();
+                    std::pair<std::unordered_map<uint64_t, Node>::iterator, bool> made = shard.nodes.emplace(key, fresh);
+                    it = made.first;
+                    added = made.second;
+                }
+                step.node = &it->second;
+                step.action = select(it->second, dice);
+                it->second.visits++;
+                it->second.scores[step.action].visits++;
+            }
+            path.push_back(step);
+            performAction(step.node->scores[step.action].action, fighter, foes);
+            finishTurn(fighter, foes);
+            if (added) break;
+        }
+
+        for (unsigned turns = 0; turns < SEARCH_PLAYOUT_TURNS && !fightOver(fighter, foes); ++turns){
+            fighter->autoTurn(foes);
+            finishTurn(fighter, foes);
+        }
+
+        bool won;
+        double value = scoreFight(fighter, foes, won);
+        for (const Step& step : path){
+            std::lock_guard<std::mutex> guard(step.shard->lock);
+            step.node->scores[step.action].value += value;
+            step.node->scores[step.action].wins += won;
+        }
+        playouts++;
+    }
+
+public:
+    /**
+     * Constructor
+     * Freezes the fight as it is. The hero's bar should be full, that is, it should be their turn.
+     * args: hero (the one whose turn it is, left untouched), foes (the enemies still in the fight, left untouched)
+     * */
+    CombatSearch(Adventurer* hero, const std::vector<Enemy*>& foes) : hero(hero), shards(SEARCH_SHARDS), playouts(0) {
+        root = CombatSnapshot::take(std::vector<Adventurer*>(1, hero), foes, CombatTally());
+        rootKey = positionHash(hero, foes);
+        for (auto e : foes) rootFoeHealth += std::max(0, e->getCurrentHealth());
+    }
+
+    CombatSearch(const CombatSearch&) = delete;
+    CombatSearch& operator=(const CombatSearch&) = delete;
+
+    /** Returns a hash of a position: the hero's and every enemy's state, in fight order. The dice are left out. */
+    static uint64_t positionHash(const Adventurer* fighter, const std::vector<Enemy*>& foes){
+        HeroState state = fighter->captureCombatState();
+        uint64_t seed = foes.size();
+        mixEntity(seed, state.entity);
+        for (int i = 0; i < MAX_ABILITIES; ++i) mix(seed, (uint32_t)state.abilityCD[i]);
+        for (int i = 0; i < CLASS_STATE_SIZE; ++i) mix(seed, (uint32_t)state.classState[i]);
+        for (const BagSlot& slot : state.bag){
+            mix(seed, slot.id);
+            mix(seed, slot.count);
+            mix(seed, (uint32_t)slot.cooldown);
+            mix(seed, slot.state);
+        }
+        for (auto e : foes){
+            mix(seed, e->getID());
+            mixEntity(seed, e->captureState());
+        }
+        return seed;
+    }
+
+    /**
+     * run(): searches for as long as the budget allows, or until enough playouts have been made. Searching again carries on
+     * from what earlier runs learned.
+     * args: budget (how long to think), threads (how many workers to use, 0 for one per core the machine has),
+     *       maxPlayouts (stop after this many in total, 0 for no limit)
+     * outputs: the hero's moves, best first. Moves are ranked by how often the search went with them
+     * */
+    SearchResult run(std::chrono::milliseconds budget = std::chrono::milliseconds(SEARCH_HINT_MS), unsigned threads = 0,
+                     unsigned long maxPlayouts = 0){
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + budget;
+        CombatDice peek = combatDice(); // a copy, so thinking a fight over doesn't change how it rolls
+        unsigned seed = peek();
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t){
+            workers.push_back(std::thread([&, t](){
+                MutedOutput muted;
+                std::minstd_rand dice(seed + t * 7919 + 1);
+                Adventurer* fighter = hero->clone();
+                std::vector<Enemy*> foes;
+                while (std::chrono::steady_clock::now() < deadline && (maxPlayouts == 0 || playouts < maxPlayouts)){
+                    playout(fighter, foes, dice);
+                }
+                for (auto e : foes) delete e;
+                delete fighter;
+            }));
+        }
+        for (auto& worker : workers) worker.join();
+
+        SearchResult result;
+        result.playouts = playouts;
+        result.threads = threads;
+        Shard& shard = shards[rootKey % SEARCH_SHARDS];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        std::unordered_map<uint64_t, Node>::iterator it = shard.nodes.find(rootKey);
+        if (it == shard.nodes.end()) return result;
+        result.scores = it->second.scores;
+        std::stable_sort(result.scores.begin(), result.scores.end(), [](const ActionScore& a, const ActionScore& b){
+            return a.visits > b.visits || (a.visits == b.visits && a.averageValue() > b.averageValue());
+        });
+        return result;
+    }
+
+    /** Returns how many positions the search has learned about. */
+    unsigned positions(){
+        unsigned total = 0;
+        for (Shard& shard : shards){
+            std::lock_guard<std::mutex> guard(shard.lock);
+            total += shard.nodes.size();
+        }
+        return total;
+    }
+};
+
+/**
+ * searchTurn(): takes the hero's turn with whatever the search thinks is best. Use this as a stronger stand-in for the player
+ * than autoTurn() when playing fights out to test balance.
+ * args: hero (the one whose turn it is), foes (the enemies in the fight), budget (how long to think for), threads (see run())
+ * outputs: none
+ * */
+inline void searchTurn(Adventurer* hero, std::vector<Enemy*>& foes, std::chrono::milliseconds budget, unsigned threads = 0){
+    SearchResult result = CombatSearch(hero, foes).run(budget, threads);
+    if (result.empty()) hero->autoTurn(foes);
+    else performAction(result.best(), hero, foes);
+}
+
+/**
+ * adviseTurn(): the turn menu's advice. Thinks about the fight for a moment and says which move looks best and how it tends to go.
+ * args: hero (the one whose turn it is), foes (the enemies in the fight)
+ * outputs: none
+ * */
+inline void adviseTurn(Adventurer* hero, const std::vector<Enemy*>& foes){
+    SearchResult result = CombatSearch(hero, foes).run();
+    if (result.empty()){
+        std::cout << "You can't make heads or tails of this fight.\n";
+        return;
+    }
+    std::cout << "You size up the fight. Your best bet looks like: " << describeAction(result.best(), hero, foes)
+              << " (won " << (int)round(result.scores.front().winChance() * 100) << "% of the fights you pictured).\n";
+    if (result.scores.size() > 1){
+        std::cout << "Otherwise: " << describeAction(result.scores[1].action, hero, foes)
+                  << " (won " << (int)round(result.scores[1].winChance() * 100) << "%).\n";
+    }
+}
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef __COMBAT_SNAPSHOT_H__
+#define __COMBAT_SNAPSHOT_H__
+
+#include "./Adventurer.hpp"
+#include "./Factory.hpp"
+#include "./Dice.hpp"
+
+#include <vector>
+#include <memory>
+
+/**
+ * CombatTally: the running totals of a fight, handed out once it is won.
+ * */
+struct CombatTally {
+    int goldReward = 0, expReward = 0, turn = 1;
+    std::vector<unsigned> drops; // IDs of the items dropped so far
+
+    bool operator==(const CombatTally& other) const {
+        return goldReward == other.goldReward && expReward == other.expReward && turn == other.turn && drops == other.drops;
+    }
+};
+
+/**
+ * CombatSnapshot: a whole fight frozen at one moment: every party member and enemy, the running totals and the state of
+ * combatDice(), so restoring it and playing on rolls exactly the same way as the first time.
+ * A snapshot never changes once it is taken, and each piece of it is shared rather than copied. Copying a snapshot to
+ * branch off from it only copies pointers, and a snapshot taken with an earlier one as its base reuses every piece that
+ * didn't change since. Thousands of branches from one point only cost what actually differs between them.
+ * */
+class CombatSnapshot {
+private:
+    std::vector<std::shared_ptr<const HeroState> > heroes; // in party order
+    std::vector<std::shared_ptr<const EnemyState> > enemies; // in fight order
+    std::shared_ptr<const CombatTally> tally;
+    std::shared_ptr<const CombatDice> dice;
+
+    /** Reuses the base's piece if it is the same as the new one, so the two snapshots share it. */
+    template <class T>
+    static std::shared_ptr<const T> share(const T& now, const std::vector<std::shared_ptr<const T> >& before, unsigned at){
+        if (at < before.size() && *before[at] == now) return before[at];
+        return std::make_shared<const T>(now);
+    }
+
+    template <class T>
+    static std::shared_ptr<const T> share(const T& now, const std::shared_ptr<const T>& before){
+        if (before && *before == now) return before;
+        return std::make_shared<const T>(now);
+    }
+
+public:
+    CombatSnapshot() = default;
+
+    /**
+     * take(): freezes a fight.
+     * args: party (every party member, standing or not), foes (the enemies still in the fight), totals (the running totals),
+     *       base (an earlier snapshot of the same fight to share unchanged pieces with, or nullptr)
+     * outputs: the snapshot
+     * */
+    static CombatSnapshot take(const std::vector<Adventurer*>& party, const std::vector<Enemy*>& foes, const CombatTally& totals,
+                               const CombatSnapshot* base = nullptr){
+        static const CombatSnapshot none;
+        if (base == nullptr) base = &none;
+        CombatSnapshot snapshot;
+        for (unsigned i = 0; i < party.size(); ++i) snapshot.heroes.push_back(share(party[i]->captureCombatState(), base->heroes, i));
+        for (unsigned i = 0; i < foes.size(); ++i) snapshot.enemies.push_back(share(foes[i]->captureEnemyState(), base->enemies, i));
+        snapshot.tally = share(totals, base->tally);
+        snapshot.dice = share(combatDice(), base->dice);
+        return snapshot;
+    }
+
+    /**
+     * restore(): puts a fight back the way it was. Party members are changed in place. Enemies that are still around are
+     * reused and the ones that have fallen since are made again.
+     * args: party (the same party the snapshot was taken of), foes (the fight's enemies, owned by the caller), totals (the running totals)
+     * outputs: none
+     * */
+    void restore(const std::vector<Adventurer*>& party, std::vector<Enemy*>& foes, CombatTally& totals) const {
+        for (unsigned i = 0; i < party.size() && i < heroes.size(); ++i) party[i]->restoreCombatState(*heroes[i], &makeItem);
+
+        // enemies only ever leave a fight, so the ones still standing are in the same order as in the snapshot
+        EnemyFactory factory;
+        std::vector<Enemy*> restored;
+        unsigned next = 0;
+        for (const std::shared_ptr<const EnemyState>& state : enemies){
+            Enemy* e;
+            if (next < foes.size() && foes[next]->getID() == state->id) e = foes[next++];
+            else e = factory.generate(state->id);
+            e->restoreEnemyState(*state);
+            restored.push_back(e);
+        }
+        for (; next < foes.size(); ++next) delete foes[next];
+        foes.swap(restored);
+
+        totals = *tally;
+        combatDice() = *dice;
+    }
+
+    bool empty() const {
+        return !tally;
+    }
+
+    /** Returns how many pieces the snapshot is made of. */
+    unsigned pieces() const {
+        return heroes.size() + enemies.size() + (tally ? 1 : 0) + (dice ? 1 : 0);
+    }
+
+    /** Returns how many of this snapshot's pieces are shared with another one rather than being copies of their own. */
+    unsigned sharedWith(const CombatSnapshot& other) const {
+        unsigned shared = (tally && tally == other.tally) + (dice && dice == other.dice);
+        for (unsigned i = 0; i < heroes.size() && i < other.heroes.size(); ++i) shared += heroes[i] == other.heroes[i];
+        for (unsigned i = 0; i < enemies.size() && i < other.enemies.size(); ++i) shared += enemies[i] == other.enemies[i];
+        return shared;
+    }
+
+    const HeroState& hero(unsigned member) const {
+        return *heroes[member];
+    }
+
+    unsigned enemyCount() const {
+        return enemies.size();
+    }
+};
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef __COMBAT_SOLVER_H__
+#define __COMBAT_SOLVER_H__
+
+#include "./Adventurer.hpp"
+#include "./Console.hpp"
+#include "./Dice.hpp"
+#include "./CombatSnapshot.hpp"
+#include "./CombatSearch.hpp"
+
+#include <vector>
+#include <functional>
+#include <string>
+#include <typeinfo>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+// the most positions a solver works out before it gives up on being exact
+const unsigned SOLVER_STATE_LIMIT = 250000;
+// a fight still going after this many of the hero's turns counts as lost
+const unsigned SOLVER_TURN_LIMIT = 400;
+
+// how the hero picks their moves. It has to be decided by the fight alone, the same position always gets the same move
+typedef std::function<void(Adventurer*, std::vector<Enemy*>&)> CombatPolicy;
+
+/** The policy simulateFight() plays with. */
+inline void autoTurnPolicy(Adventurer* hero, std::vector<Enemy*>& foes){
+    hero->autoTurn(foes);
+}
+
+/**
+ * FightOdds: how a fight goes, worked out exactly. turns are the hero's turns.
+ * exact is false if the solver had to cut corners: the fight went around in a circle, ran past SOLVER_TURN_LIMIT turns or
+ * needed more than SOLVER_STATE_LIMIT positions. The positions it cut off count as lost.
+ * */
+struct FightOdds {
+    double winChance = 0, expectedTurns = 0;
+    unsigned positions = 0; // how many positions are remembered, over every fight solved so far
+    unsigned long branches = 0; // how many ways a turn could go were played out for this fight
+    bool exact = true;
+};
+
+/**
+ * CombatSolver: works out the exact odds of a one on one (or one against a few) fight, rather than estimating them by playing it
+ * out over and over. Every roll a turn makes is handed to a DiceScript, which plays the turn out once for every way those rolls can
+ * come up and weighs each by how likely it is. Turns that end up in the same place are merged, and the odds of every position are
+ * remembered, so each one is only worked out once.
+ * Rolls that only pick flavour text (flavorRoll()) don't branch, and chance() rolls only branch two ways, so most turns only
+ * have a handful of ways to go.
+ * Nothing gets printed while solving. Enemies that fall and come back for another branch are made again by the EnemyFactory,
+ * which uses up a few spawnDice() rolls.
+ * */
+class CombatSolver {
+private:
+    struct Odds {
+        double win, turns;
+        bool exact;
+    };
+
+    /**
+     * Enumerator: steps through every combination of rolls a turn makes, depth first. The first time a roll comes up it picks the
+     * first outcome. Once the turn is over, advance() moves on to the next combination, and playing the same turn again from the
+     * same position makes the same rolls up to the one that changed.
+     * */
+    class Enumerator : public DiceScript {
+    private:
+        struct Choice {
+            int pick, options, percent; // percent is 0 for roll(), which is uniform
+        };
+        std::vector<Choice> path;
+        unsigned at = 0;
+        double likelihood = 1;
+
+        Choice& next(int options, int percent){
+            if (at == path.size()) path.push_back(Choice{0, options, percent});
+            return path[at++];
+        }
+
+    public:
+        int roll(int sides){
+            if (sides <= 1) return 0;
+            Choice& choice = next(sides, 0);
+            likelihood /= sides;
+            return choice.pick;
+        }
+
+        bool chance(int percent){
+            Choice& choice = next(2, percent);
+            likelihood *= (choice.pick == 0 ? percent : 100 - percent) / 100.0;
+            return choice.pick == 0;
+        }
+
+        /** Starts playing a turn out. */
+        void begin(){
+            at = 0;
+            likelihood = 1;
+        }
+
+        /** Returns how likely the rolls of the turn just played were. */
+        double probability() const {
+            return likelihood;
+        }
+
+        /** Moves on to the next combination of rolls. Returns false once every one has been played. */
+        bool advance(){
+            path.resize(at);
+            while (!path.empty() && path.back().pick + 1 >= path.back().options) path.pop_back();
+            if (path.empty()) return false;
+            path.back().pick++;
+            return true;
+        }
+    };
+
+    /** Somewhere a turn can lead: another position, or the end of the fight. */
+    struct Outcome {
+        uint64_t key;
+        double probability;
+        CombatSnapshot position;
+    };
+
+    CombatPolicy policy;
+    Adventurer* fighter = nullptr; // the copy of the hero that turns get played out with
+    std::vector<Enemy*> foes;
+    std::unordered_map<uint64_t, Odds> solved;
+    std::unordered_set<uint64_t> open; // positions being worked out right now, further up the stack
+    std::string build; // the class and level the remembered positions were worked out for
+    FightOdds current;
+
+    /**
+     * expand(): plays a turn out every way it can go from a position, with the hero's move first or not.
+     * args: from (the position), move (whether the hero moves first, or the bars just tick up to their first turn),
+     *       outcomes (filled with where the turn can lead, the same position only once), won (the chance the turn wins the fight)
+     * outputs: none
+     * */
+    void expand(const CombatSnapshot& from, bool move, std::vector<Outcome>& outcomes, double& won){
+        std::unordered_map<uint64_t, unsigned> seen;
+        CombatTally tally;
+        Enumerator dice;
+        diceScript() = &dice;
+        do {
+            dice.begin();
+            from.restore(std::vector<Adventurer*>(1, fighter), foes, tally);
+            if (move){
+                policy(fighter, foes);
+                finishTurn(fighter, foes);
+            }
+            else playToTurn(fighter, foes);
+            current.branches++;
+
+            if (fightOver(fighter, foes)){
+                if (fighter->isAlive()) won += dice.probability();
+                continue;
+            }
+            uint64_t key = CombatSearch::positionHash(fighter, foes);
+            std::unordered_map<uint64_t, unsigned>::iterator it = seen.find(key);
+            if (it != seen.end()) outcomes[it->second].probability += dice.probability();
+            else {
+                seen[key] = outcomes.size();
+                outcomes.push_back(Outcome{key, dice.probability(),
+                                           CombatSnapshot::take(std::vector<Adventurer*>(1, fighter), foes, tally)});
+            }
+        } while (dice.advance());
+        diceScript() = nullptr;
+    }
+
+    /** Works out the odds from a position where it is the hero's turn. */
+    Odds solve(const CombatSnapshot& position, uint64_t key, unsigned depth){
+        std::unordered_map<uint64_t, Odds>::iterator it = solved.find(key);
+        if (it != solved.end()) return it->second;
+        if (open.count(key) > 0 || depth >= SOLVER_TURN_LIMIT || solved.size() >= SOLVER_STATE_LIMIT){
+            return Odds{0, 0, false};
+        }
+
+        open.insert(key);
+        std::vector<Outcome> outcomes;
+        Odds odds{0, 1, true};
+        expand(position, true, outcomes, odds.win);
+        for (const Outcome& outcome : outcomes){
+            Odds after = solve(outcome.position, outcome.key, depth + 1);
+            odds.win += outcome.probability * after.win;
+            odds.turns += outcome.probability * after.turns;
+            odds.exact = odds.exact && after.exact;
+        }
+        open.erase(key);
+        solved[key] = odds;
+        return odds;
+    }
+
+public:
+    /**
+     * Constructor
+     * args: policy (how the hero picks their moves, autoTurn() unless told otherwise)
+     * */
+    CombatSolver(CombatPolicy policy = autoTurnPolicy) : policy(policy) {}
+
+    ~CombatSolver(){
+        for (auto e : foes) delete e;
+        delete fighter;
+    }
+
+    CombatSolver(const CombatSolver&) = delete;
+    CombatSolver& operator=(const CombatSolver&) = delete;
+
+    /**
+     * solve(): works out a fight from the top, before anyone has moved. Positions worked out for earlier fights are reused as long
+     * as the hero is of the same class and level, so solving fights against the same enemies again is much cheaper.
+     * args: hero (who is fighting, left untouched), enemies (who they are up against, left untouched)
+     * outputs: the odds
+     * */
+    FightOdds solve(const Adventurer* hero, const std::vector<Enemy*>& enemies){
+        MutedOutput muted;
+        current = FightOdds();
+        open.clear();
+        std::string heroBuild = std::string(typeid(*hero).name()) + ":" + std::to_string(hero->getLevel());
+        if (heroBuild != build) forget();
+        build = heroBuild;
+
+        // the fight starts the way simulateFight() starts it
+        if (fighter != nullptr) delete fighter;
+        fighter = hero->clone();
+        CombatTally tally;
+        CombatSnapshot::take(std::vector<Adventurer*>(1, const_cast<Adventurer*>(hero)), enemies, tally).restore(
+            std::vector<Adventurer*>(1, fighter), foes, tally);
+        fighter->initializeOrigStats();
+        for (auto e : foes) e->initializeOrigStats();
+        CombatSnapshot start = CombatSnapshot::take(std::vector<Adventurer*>(1, fighter), foes, tally);
+
+        std::vector<Outcome> outcomes;
+        double won = 0;
+        expand(start, false, outcomes, won);
+        current.winChance = won;
+        for (const Outcome& outcome : outcomes){
+            Odds after = solve(outcome.position, outcome.key, 0);
+            current.winChance += outcome.probability * after.win;
+            current.expectedTurns += outcome.probability * after.turns;
+            current.exact = current.exact && after.exact;
+        }
+        current.positions = solved.size();
+        return current;
+    }
+
+    /** Forgets every position worked out so far. */
+    void forget(){
+        solved.clear();
+    }
+};
+
+#endif
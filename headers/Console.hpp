@@ -0,0 +1,44 @@
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+#include <iostream>
+
+/**
+ * gameOut(): where combat text gets written. This is the console, unless the current thread has muted it with a MutedOutput.
+ * Each thread has its own setting, so fights can be played out on worker threads without any of it showing up on screen.
+ * args: none
+ * outputs: the stream to write to
+ * */
+inline std::ostream*& gameOutSlot(){
+    thread_local std::ostream* out = &std::cout;
+    return out;
+}
+
+inline std::ostream& gameOut(){
+    return *gameOutSlot();
+}
+
+/**
+ * MutedOutput: silences gameOut() on the current thread for as long as it is around.
+ * The text still gets built, it just goes nowhere.
+ * */
+class MutedOutput {
+private:
+    std::ostream nowhere;
+    std::ostream* previous;
+
+public:
+    MutedOutput() : nowhere(nullptr) {
+        previous = gameOutSlot();
+        gameOutSlot() = &nowhere;
+    }
+
+    MutedOutput(const MutedOutput&) = delete;
+    MutedOutput& operator=(const MutedOutput&) = delete;
+
+    ~MutedOutput(){
+        gameOutSlot() = previous;
+    }
+};
+
+#endif
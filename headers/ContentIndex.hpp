@@ -0,0 +1,246 @@
+#ifndef __CONTENT_INDEX_H__
+#define __CONTENT_INDEX_H__
+
+#include <vector>
+#include <bitset>
+#include <utility>
+#include <limits>
+#include <initializer_list>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
+
+/**
+ * ContentTag: labels a piece of content can carry. Add new ones before NUM_TAGS, there is room for 64.
+ * */
+enum ContentTag {
+    // what kind of content it is
+    TAG_ENEMY, TAG_ITEM, TAG_ODDITY_ROOM, TAG_AMBIENT_ROOM,
+    // enemy families
+    TAG_UNDEAD, TAG_BEAST, TAG_SLIME, TAG_FAE,
+    // item kinds. TAG_SHOP marks things the Merchant is willing to stock
+    TAG_CONSUMABLE, TAG_WEAPON, TAG_ARMOR, TAG_TRINKET, TAG_SHOP,
+    // where it can be found
+    TAG_CRYPT, TAG_WILDS, TAG_CAVE,
+    NUM_TAGS
+};
+
+/**
+ * ContentAttr: numbers a piece of content carries. Anything that doesn't use an attribute leaves it at 0.
+ * ATTR_MIN_LEVEL/ATTR_MAX_LEVEL: the levels it shows up for. ATTR_VALUE: price in gold. ATTR_RARITY: the item's Rarity.
+ * ATTR_WEIGHT: how common it is compared to other content of the same kind.
+ * */
+enum ContentAttr {ATTR_MIN_LEVEL, ATTR_MAX_LEVEL, ATTR_VALUE, ATTR_RARITY, ATTR_WEIGHT, NUM_ATTRS};
+
+/** Turns a list of tags into a tag set. */
+inline uint64_t tagSet(std::initializer_list<ContentTag> tags){
+    uint64_t set = 0;
+    for (ContentTag t : tags) set |= (uint64_t)1 << t;
+    return set;
+}
+
+/**
+ * ContentDef: a single piece of content, given by its factory ID, with its tags and attributes.
+ * */
+struct ContentDef {
+    unsigned id;
+    uint64_t tags;
+    int attrs[NUM_ATTRS];
+};
+
+/**
+ * ContentQuery: describes what to look for. Every condition has to hold.
+ * Build one up by chaining, e.g. ContentQuery().with(TAG_ENEMY).with(TAG_UNDEAD).atMost(ATTR_MIN_LEVEL, 4)
+ * */
+class ContentQuery {
+private:
+    struct Range {
+        ContentAttr attr;
+        int low, high;
+    };
+
+    uint64_t required = 0, excluded = 0;
+    std::vector<Range> ranges;
+
+    friend class ContentIndex;
+
+public:
+    ContentQuery& with(ContentTag tag){
+        required |= (uint64_t)1 << tag;
+        return *this;
+    }
+
+    ContentQuery& without(ContentTag tag){
+        excluded |= (uint64_t)1 << tag;
+        return *this;
+    }
+
+    /** Only matches content with low <= attr <= high. */
+    ContentQuery& between(ContentAttr attr, int low, int high){
+        ranges.push_back(Range{attr, low, high});
+        return *this;
+    }
+
+    ContentQuery& atMost(ContentAttr attr, int high){
+        return between(attr, std::numeric_limits<int>::min(), high);
+    }
+
+    ContentQuery& atLeast(ContentAttr attr, int low){
+        return between(attr, low, std::numeric_limits<int>::max());
+    }
+};
+
+/**
+ * ContentIndex: answers ContentQuerys over a catalogue without checking every definition one at a time.
+ * Each tag has a bitset with one bit per definition, and each attribute has a column of (value, definition) pairs sorted by value.
+ * A query starts from all ones and ANDs in a whole 64 definitions at a time. The loops are plain word-wise ANDs so the
+ * compiler can vectorize them. Attribute ranges are found with a binary search on their column.
+ * */
+class ContentIndex {
+private:
+    std::vector<ContentDef> defs;
+    std::unordered_map<unsigned, unsigned> rowOf; // ID -> position in defs
+    unsigned words = 0;
+    std::vector<uint64_t> tagBits[NUM_TAGS];
+    std::vector<std::pair<int, unsigned> > columns[NUM_ATTRS];
+
+    /** Bits past the last definition are never set, so counting and sampling can ignore them. */
+    uint64_t lastWordMask() const {
+        unsigned used = defs.size() % 64;
+        return used == 0 ? ~(uint64_t)0 : (((uint64_t)1 << used) - 1);
+    }
+
+    /**
+     * match: works out which definitions pass a query.
+     * args: q (the query), bits (set to one bit per definition, set for the ones that pass)
+     * outputs: none
+     * */
+    void match(const ContentQuery& q, std::vector<uint64_t>& bits) const {
+        bits.assign(words, ~(uint64_t)0);
+        if (words > 0) bits[words - 1] = lastWordMask();
+
+        for (unsigned t = 0; t < NUM_TAGS; ++t){
+            uint64_t flag = (uint64_t)1 << t;
+            const uint64_t* tag = tagBits[t].data();
+            uint64_t* out = bits.data();
+            if (q.required & flag){
+                for (unsigned w = 0; w < words; ++w) out[w] &= tag[w];
+            } else if (q.excluded & flag){
+                for (unsigned w = 0; w < words; ++w) out[w] &= ~tag[w];
+            }
+        }
+
+        std::vector<uint64_t> inRange;
+        for (const ContentQuery::Range& range : q.ranges){
+            const std::vector<std::pair<int, unsigned> >& column = columns[range.attr];
+            auto first = std::lower_bound(column.begin(), column.end(), std::make_pair(range.low, 0u));
+            auto last = std::upper_bound(column.begin(), column.end(), std::make_pair(range.high, ~0u));
+            inRange.assign(words, 0);
+            for (auto it = first; it != last; ++it) inRange[it->second / 64] |= (uint64_t)1 << (it->second % 64);
+            for (unsigned w = 0; w < words; ++w) bits[w] &= inRange[w];
+        }
+    }
+
+    /** Returns the ID of the (pick)th set bit, counting from 0. */
+    unsigned nth(const std::vector<uint64_t>& bits, unsigned pick) const {
+        for (unsigned w = 0; w < words; ++w){
+            unsigned inWord = std::bitset<64>(bits[w]).count();
+            if (pick >= inWord){
+                pick -= inWord;
+                continue;
+            }
+            for (unsigned bit = 0; bit < 64; ++bit){
+                if ((bits[w] & ((uint64_t)1 << bit)) && pick-- == 0) return defs[w * 64 + bit].id;
+            }
+        }
+        return 0;
+    }
+
+public:
+    /**
+     * ContentIndex(): builds the index for a catalogue.
+     * args: catalogue (every piece of content, IDs must be unique)
+     * */
+    explicit ContentIndex(const std::vector<ContentDef>& catalogue) : defs(catalogue) {
+        words = (defs.size() + 63) / 64;
+        for (unsigned t = 0; t < NUM_TAGS; ++t) tagBits[t].assign(words, 0);
+        for (unsigned row = 0; row < defs.size(); ++row){
+            rowOf[defs[row].id] = row;
+            for (unsigned t = 0; t < NUM_TAGS; ++t){
+                if (defs[row].tags & ((uint64_t)1 << t)) tagBits[t][row / 64] |= (uint64_t)1 << (row % 64);
+            }
+            for (unsigned a = 0; a < NUM_ATTRS; ++a) columns[a].push_back(std::make_pair(defs[row].attrs[a], row));
+        }
+        for (unsigned a = 0; a < NUM_ATTRS; ++a) std::sort(columns[a].begin(), columns[a].end());
+    }
+
+    /**
+     * query(): finds every piece of content that passes a query.
+     * args: q (the query)
+     * outputs: the IDs that match, in catalogue order
+     * */
+    std::vector<unsigned> query(const ContentQuery& q) const {
+        std::vector<uint64_t> bits;
+        match(q, bits);
+        std::vector<unsigned> ids;
+        for (unsigned w = 0; w < words; ++w){
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1){
+                unsigned bit = 0;
+                while (!(word & ((uint64_t)1 << bit))) ++bit;
+                ids.push_back(defs[w * 64 + bit].id);
+            }
+        }
+        return ids;
+    }
+
+    /** Returns how many pieces of content pass a query. */
+    unsigned count(const ContentQuery& q) const {
+        std::vector<uint64_t> bits;
+        match(q, bits);
+        unsigned total = 0;
+        for (unsigned w = 0; w < words; ++w) total += std::bitset<64>(bits[w]).count();
+        return total;
+    }
+
+    /**
+     * sample(): picks one piece of content that passes a query, all of them equally likely.
+     * args: q (the query)
+     * outputs: the picked ID, or 0 if nothing matches
+     * */
+    unsigned sample(const ContentQuery& q) const {
+        std::vector<uint64_t> bits;
+        match(q, bits);
+        unsigned total = 0;
+        for (unsigned w = 0; w < words; ++w) total += std::bitset<64>(bits[w]).count();
+        if (total == 0) return 0;
+
+        return nth(bits, rand() % total);
+    }
+
+    /** This is a version of the above sample that rolls with a given generator instead of rand(). */
+    unsigned sample(const ContentQuery& q, std::mt19937& rng) const {
+        std::vector<uint64_t> bits;
+        match(q, bits);
+        unsigned total = 0;
+        for (unsigned w = 0; w < words; ++w) total += std::bitset<64>(bits[w]).count();
+        if (total == 0) return 0;
+        return nth(bits, rng() % total);
+    }
+
+    /** Looks up the definition for an ID. The ID has to be in the catalogue. */
+    const ContentDef& get(unsigned id) const {
+        return defs[rowOf.at(id)];
+    }
+
+    bool contains(unsigned id) const {
+        return rowOf.count(id) > 0;
+    }
+
+    unsigned size() const {
+        return defs.size();
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef __DICE_H__
+#define __DICE_H__
+
+#include <cstdlib>
+#include <random>
+
+// the generator behind every roll made during a fight. Its whole state is a single number, so it is cheap to copy into a
+// CombatSnapshot, and putting it back makes the fight roll the same way again
+typedef std::minstd_rand CombatDice;
+
+/**
+ * combatDice(): the current thread's combat generator. Each thread has its own, so fights played out on worker threads
+ * don't interfere with each other or with the game. It is seeded from rand() the first time a thread uses it.
+ * args: none
+ * outputs: the generator
+ * */
+inline CombatDice& combatDice(){
+    thread_local CombatDice dice(std::rand());
+    return dice;
+}
+
+/**
+ * spawnDice(): the current thread's generator for the stats enemies are made with, like the bit of speed each one is
+ * given or takes away. It is kept apart from combatDice() so making an enemy never changes how a fight rolls, and each
+ * thread has its own so a tool can seed it and get the same enemies back on whichever thread it runs.
+ * It is seeded from rand() the first time a thread uses it.
+ * args: none
+ * outputs: the generator
+ * */
+inline std::minstd_rand& spawnDice(){
+    thread_local std::minstd_rand dice(std::rand());
+    return dice;
+}
+
+/**
+ * DiceScript: decides rolls instead of combatDice(), for working through every way a fight can go rather than rolling
+ * one of them. See CombatSolver.
+ * */
+class DiceScript {
+public:
+    virtual ~DiceScript() = default;
+    /** Picks a number from 0 to sides - 1, each equally likely. */
+    virtual int roll(int sides) = 0;
+    /** Picks whether something that happens (percent)% of the time happens. percent is always from 1 to 99. */
+    virtual bool chance(int percent) = 0;
+};
+
+/** The current thread's script, or nullptr while the dice are in charge. */
+inline DiceScript*& diceScript(){
+    thread_local DiceScript* script = nullptr;
+    return script;
+}
+
+/** Rolls a number from 0 to sides - 1 on the combat generator. */
+inline int roll(int sides){
+    if (diceScript() != nullptr) return diceScript()->roll(sides);
+    return combatDice()() % sides;
+}
+
+/**
+ * chance(): whether something that happens (percent)% of the time happens this time. Uses up the same roll as roll(100) would,
+ * so switching a roll(100) < percent check over to this doesn't change how a seeded fight goes.
+ * args: percent (how likely it is. 0 or less never happens, 100 or more always does)
+ * outputs: whether it happened
+ * */
+inline bool chance(int percent){
+    if (diceScript() != nullptr && percent > 0 && percent < 100) return diceScript()->chance(percent);
+    if (diceScript() != nullptr) return percent >= 100;
+    return (int)(combatDice()() % 100) < percent;
+}
+
+/** Rolls for something that only changes what gets printed, like which line of flavour text to use. A script always gets 0. */
+inline int flavorRoll(int sides){
+    if (diceScript() != nullptr) return 0;
+    return combatDice()() % sides;
+}
+
+#endif
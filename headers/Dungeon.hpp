@@ -0,0 +1,222 @@
+#ifndef __DUNGEON_H__
+#define __DUNGEON_H__
+
+#include <vector>
+#include <string>
+#include <random>
+#include <utility>
+#include <algorithm>
+#include <deque>
+
+// what goes in each room of a generated dungeon
+enum DungeonRoomKind {ROOM_AMBIENT, ROOM_ARENA, ROOM_ODDITY, ROOM_GATE, ROOM_BOSS};
+
+/**
+ * DungeonParams: what the generator should build.
+ * rooms: the total number of rooms, including the start and the boss room. At least 3.
+ * loops: extra connections added between rooms that are already reachable from each other, so there is more than one way around.
+ * lockedAreas: side areas that can only be entered through a guarded room (a ROOM_GATE).
+ * arenas, oddities: how many fights and oddity rooms get scattered around. If there isn't enough space, fewer get placed.
+ * */
+struct DungeonParams {
+    unsigned rooms;
+    unsigned loops;
+    unsigned lockedAreas;
+    unsigned arenas, oddities;
+};
+
+/**
+ * DungeonGraph: the layout of a dungeon, with rooms numbered from 0.
+ * Exits are stored in compressed sparse row form: the exits of room i are targets[offsets[i]] up to targets[offsets[i + 1]].
+ * Exit labels aren't stored, the (k)th exit of a room is labelled k + 1.
+ * */
+struct DungeonGraph {
+    std::vector<unsigned> offsets;
+    std::vector<unsigned> targets;
+    std::vector<unsigned char> kinds; // a DungeonRoomKind for each room
+    std::vector<unsigned> areas; // which locked area each room is in, given by its gate. 0 for the open dungeon
+    unsigned start = 0, boss = 0;
+
+    unsigned roomCount() const {
+        return kinds.size();
+    }
+
+    unsigned exitCount(unsigned room) const {
+        return offsets[room + 1] - offsets[room];
+    }
+
+    /** Returns the room the (k)th exit of a room leads to, starting at 0. */
+    unsigned exit(unsigned room, unsigned k) const {
+        return targets[offsets[room] + k];
+    }
+
+    /** Returns the label for the (k)th exit of a room, starting at 0. */
+    std::string exitLabel(unsigned /* room */, unsigned k) const {
+        return std::to_string(k + 1);
+    }
+
+    DungeonRoomKind kind(unsigned room) const {
+        return (DungeonRoomKind)kinds[room];
+    }
+
+    /**
+     * reachable(): works out which rooms can be reached from the start.
+     * args: blocked (a room that can't be walked through, or roomCount() to not block anything)
+     * outputs: one flag per room, set if it can be reached
+     * */
+    std::vector<bool> reachable(unsigned blocked) const {
+        std::vector<bool> seen(roomCount(), false);
+        std::vector<unsigned> frontier(1, start);
+        seen[start] = true;
+        while (!frontier.empty()){
+            unsigned room = frontier.back();
+            frontier.pop_back();
+            for (unsigned e = offsets[room]; e < offsets[room + 1]; ++e){
+                unsigned next = targets[e];
+                if (seen[next] || next == blocked) continue;
+                seen[next] = true;
+                frontier.push_back(next);
+            }
+        }
+        return seen;
+    }
+
+    /**
+     * routeToBoss(): finds the way from the start to the boss room that walks through the fewest fights (arenas and gates).
+     * Rooms without a fight are free, so this is a breadth first search that looks at free rooms before fights.
+     * args: none
+     * outputs: the rooms along the way, from the start to the boss room
+     * */
+    std::vector<unsigned> routeToBoss() const {
+        const unsigned unseen = ~0u;
+        std::vector<unsigned> cost(roomCount(), unseen), from(roomCount(), unseen);
+        std::deque<unsigned> frontier(1, start);
+        cost[start] = 0;
+        while (!frontier.empty()){
+            unsigned room = frontier.front();
+            frontier.pop_front();
+            for (unsigned e = offsets[room]; e < offsets[room + 1]; ++e){
+                unsigned next = targets[e];
+                bool fight = kind(next) == ROOM_ARENA || kind(next) == ROOM_GATE;
+                if (cost[room] + fight >= cost[next]) continue;
+                cost[next] = cost[room] + fight;
+                from[next] = room;
+                if (fight) frontier.push_back(next);
+                else frontier.push_front(next);
+            }
+        }
+        std::vector<unsigned> route;
+        for (unsigned room = boss; room != unseen; room = from[room]) route.push_back(room);
+        std::reverse(route.begin(), route.end());
+        return route;
+    }
+
+    /**
+     * validate(): checks that every room, including the boss room, can be reached from the start.
+     * args: none
+     * outputs: true if the dungeon is fine
+     * */
+    bool validate() const {
+        if (roomCount() == 0 || start >= roomCount() || boss >= roomCount()) return false;
+        std::vector<bool> seen = reachable(roomCount());
+        return std::find(seen.begin(), seen.end(), false) == seen.end();
+    }
+};
+
+/**
+ * generateDungeon(): builds a random dungeon. The same params and seed always give the same dungeon.
+ * There is a main path from the start to the boss room. Every other room hangs off of an earlier room, either
+ * continuing a corridor or branching off somewhere else, which leaves dead ends wherever a branch stops.
+ * Side areas behind a gate only connect to the rest of the dungeon through that gate, loops never cut around one.
+ * Every connection except the one into the boss room goes both ways, and the boss room has no way out.
+ * Takes time roughly linear in the number of rooms.
+ * args: params (what to build), seed (the random seed)
+ * outputs: the dungeon
+ * */
+inline DungeonGraph generateDungeon(DungeonParams params, unsigned seed){
+    std::mt19937 rng(seed);
+    unsigned n = std::max(3u, params.rooms);
+    unsigned spine = std::max(3u, n / 2);
+    DungeonGraph graph;
+    graph.kinds.assign(n, ROOM_AMBIENT);
+    graph.areas.assign(n, 0);
+    graph.start = 0;
+    graph.boss = spine - 1;
+    graph.kinds[graph.boss] = ROOM_BOSS;
+
+    std::vector<std::pair<unsigned, unsigned> > edges;
+    edges.reserve(4 * n + 2 * params.loops);
+    std::vector<unsigned> parent(n, 0);
+
+    // the main path. the boss room is the end of the line
+    for (unsigned i = 1; i < spine; ++i){
+        parent[i] = i - 1;
+        edges.push_back(std::make_pair(i - 1, i));
+        if (i != graph.boss) edges.push_back(std::make_pair(i, i - 1));
+    }
+
+    // everything else hangs off an earlier room. half the time it carries on from the last room to make a corridor
+    for (unsigned i = spine; i < n; ++i){
+        unsigned p = i - 1;
+        if (p == graph.boss || rng() % 2 == 0){
+            p = rng() % (i - 1);
+            if (p >= graph.boss) ++p; // skip over the boss room
+        }
+        parent[i] = p;
+        edges.push_back(std::make_pair(p, i));
+        edges.push_back(std::make_pair(i, p));
+    }
+
+    // gates go on side rooms that branch straight off the main path, so the whole branch behind them is locked
+    std::vector<unsigned> gateSpots;
+    for (unsigned i = spine; i < n; ++i){
+        if (parent[i] < spine) gateSpots.push_back(i);
+    }
+    for (unsigned g = 0; g < params.lockedAreas && g < gateSpots.size(); ++g){
+        std::swap(gateSpots[g], gateSpots[g + rng() % (gateSpots.size() - g)]);
+        graph.kinds[gateSpots[g]] = ROOM_GATE;
+    }
+    // parents always come first, so one pass is enough to tell every room which area it's in
+    for (unsigned i = spine; i < n; ++i){
+        graph.areas[i] = graph.kinds[i] == ROOM_GATE ? i : graph.areas[parent[i]];
+    }
+
+    // loops only join rooms in the same area, so they can never lead around a gate. tries that don't fit are skipped
+    for (unsigned l = 0; l < params.loops; ++l){
+        unsigned a = rng() % n, b = rng() % n;
+        if (a == b || a == graph.boss || b == graph.boss || graph.areas[a] != graph.areas[b]) continue;
+        edges.push_back(std::make_pair(a, b));
+        edges.push_back(std::make_pair(b, a));
+    }
+
+    // scatter fights and oddities over the plain rooms, leaving the start alone
+    std::vector<unsigned> plain;
+    for (unsigned i = 1; i < n; ++i){
+        if (graph.kinds[i] == ROOM_AMBIENT) plain.push_back(i);
+    }
+    unsigned special = std::min<unsigned>(params.arenas + params.oddities, plain.size());
+    for (unsigned i = 0; i < special; ++i){
+        std::swap(plain[i], plain[i + rng() % (plain.size() - i)]);
+        graph.kinds[plain[i]] = i < params.arenas ? ROOM_ARENA : ROOM_ODDITY;
+    }
+
+    // counting sort the edges into rows, then sort each row and drop duplicate connections
+    std::vector<unsigned> degree(n + 1, 0);
+    for (const std::pair<unsigned, unsigned>& e : edges) ++degree[e.first + 1];
+    for (unsigned i = 0; i < n; ++i) degree[i + 1] += degree[i];
+    std::vector<unsigned> fill(degree.begin(), degree.end() - 1);
+    std::vector<unsigned> targets(edges.size());
+    for (const std::pair<unsigned, unsigned>& e : edges) targets[fill[e.first]++] = e.second;
+
+    graph.offsets.assign(n + 1, 0);
+    graph.targets.reserve(targets.size());
+    for (unsigned i = 0; i < n; ++i){
+        std::vector<unsigned>::iterator first = targets.begin() + degree[i], last = targets.begin() + degree[i + 1];
+        std::sort(first, last);
+        graph.targets.insert(graph.targets.end(), first, std::unique(first, last));
+        graph.offsets[i + 1] = graph.targets.size();
+    }
+    return graph;
+}
+
+#endif
@@ -3,9 +3,28 @@
 
 #include <iostream>
 #include <string>
+#include "./Console.hpp"
 
 enum Stat{MAX_HEALTH, PHYS_ATK, PHYS_DEF, MAG_ATK, MAG_DEF, SPEED};
 
+/**
+ * EntityState: everything about an entity that can change during a fight, see Entity::captureState().
+ * */
+struct EntityState {
+    int health, maxHealth, physAtk, physDef, magAtk, magDef, speed, turnBar;
+    int pAtkBuff, pDefBuff, mAtkBuff, mDefBuff, spdBuff;
+    int pAtkOrig, pDefOrig, mAtkOrig, mDefOrig, spdOrig;
+    int extra; // see Entity::extraState()
+
+    bool operator==(const EntityState& other) const {
+        return health == other.health && maxHealth == other.maxHealth && physAtk == other.physAtk && physDef == other.physDef
+            && magAtk == other.magAtk && magDef == other.magDef && speed == other.speed && turnBar == other.turnBar
+            && pAtkBuff == other.pAtkBuff && pDefBuff == other.pDefBuff && mAtkBuff == other.mAtkBuff && mDefBuff == other.mDefBuff
+            && spdBuff == other.spdBuff && pAtkOrig == other.pAtkOrig && pDefOrig == other.pDefOrig && mAtkOrig == other.mAtkOrig
+            && mDefOrig == other.mDefOrig && spdOrig == other.spdOrig && extra == other.extra;
+    }
+};
+
 class Entity{
 protected:
     std::string name;
@@ -90,6 +109,10 @@ public:
         return turnBar;
     }
 
+    unsigned getID(){
+        return ID;
+    }
+
     std::string getName(){
         return name;
     }
@@ -223,20 +246,20 @@ public:
     /**
      * displayBuffs(): prints out a list of buffs.
      * No newline. Print this after the HP display. 
-     * args: none
+     * args: os (the stream to print to, defaults to the console)
      * outputs: none
      * */
-    void displayBuffs(){
-        if (pAtkBuff > 0) std::cout << "[+PATK] ";
-        else if (pAtkBuff < 0) std::cout << "[-PATK] ";
-        if (mAtkBuff > 0) std::cout << "[+MATK] ";
-        else if (mAtkBuff < 0) std::cout << "[-MATK] ";
-        if (pDefBuff > 0) std::cout << "[+PDEF] ";
-        else if (pDefBuff < 0) std::cout << "[-PDEF] ";
-        if (mDefBuff > 0) std::cout << "[+MDEF] ";
-        else if (mDefBuff < 0) std::cout << "[-MDEF] ";
-        if (spdBuff > 0) std::cout << "[+SPD] ";
-        else if (spdBuff < 0) std::cout << "[-SPD] ";
+    void displayBuffs(std::ostream& os = std::cout){
+        if (pAtkBuff > 0) os << "[+PATK] ";
+        else if (pAtkBuff < 0) os << "[-PATK] ";
+        if (mAtkBuff > 0) os << "[+MATK] ";
+        else if (mAtkBuff < 0) os << "[-MATK] ";
+        if (pDefBuff > 0) os << "[+PDEF] ";
+        else if (pDefBuff < 0) os << "[-PDEF] ";
+        if (mDefBuff > 0) os << "[+MDEF] ";
+        else if (mDefBuff < 0) os << "[-MDEF] ";
+        if (spdBuff > 0) os << "[+SPD] ";
+        else if (spdBuff < 0) os << "[-SPD] ";
     }
 
     /**
@@ -362,6 +385,49 @@ public:
         }
     }
 
+    /**
+     * captureState(): copies out the entity's stats, turn bar and buffs, so they can be put back later with restoreState().
+     * args: none
+     * outputs: the state
+     * */
+    EntityState captureState() const{
+        return EntityState{health, maxHealth, physAtk, physDef, magAtk, magDef, speed, turnBar,
+                           pAtkBuff, pDefBuff, mAtkBuff, mDefBuff, spdBuff,
+                           pAtkOrig, pDefOrig, mAtkOrig, mDefOrig, spdOrig, extraState()};
+    }
+
+    void restoreState(const EntityState& state){
+        health = state.health;
+        maxHealth = state.maxHealth;
+        physAtk = state.physAtk;
+        physDef = state.physDef;
+        magAtk = state.magAtk;
+        magDef = state.magDef;
+        speed = state.speed;
+        turnBar = state.turnBar;
+        pAtkBuff = state.pAtkBuff;
+        pDefBuff = state.pDefBuff;
+        mAtkBuff = state.mAtkBuff;
+        mDefBuff = state.mDefBuff;
+        spdBuff = state.spdBuff;
+        pAtkOrig = state.pAtkOrig;
+        pDefOrig = state.pDefOrig;
+        mAtkOrig = state.mAtkOrig;
+        mDefOrig = state.mDefOrig;
+        spdOrig = state.spdOrig;
+        setExtraState(state.extra);
+    }
+
+    /**
+     * extraState(): anything else a kind of entity keeps track of during a fight, packed into an int, like whether a
+     * Shield Skeleton has its shield up. Override both of these together.
+     * */
+    virtual int extraState() const{
+        return 0;
+    }
+
+    virtual void setExtraState(int /* state */){}
+
     virtual ~Entity() = default;
 };
 
@@ -0,0 +1,489 @@
+#ifndef __EVENT_H__
+#define __EVENT_H__
+
+#include <iostream>
+#include <istream>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <cstdlib>
+
+/*
+ * Oddity events are choice graphs loaded from a content pack and run by runEvent().
+ * A pack is plain text, one statement per line. Blank lines and lines starting with # are skipped.
+ *
+ *   event <id> <room name>         starts a new event for the oddity room with that factory ID
+ *   node <name>                    starts a new node. The first node of an event is where it starts
+ *   say <text>                     prints a line. \n and \t work, and so do {amount} {name} {name16} {patk} {matk} {gold} {health} {maxhealth}
+ *   gold <min> [max]               adds between min and max gold. {amount} is how much
+ *   pdamage <n> / mdamage <n>      deals damage to the player. {amount} is how much got through
+ *   heal <n> / sethealth <n>       heals the player, or sets their health outright
+ *   item <id>                      gives the player the item with that factory ID
+ *   add <var> <n>                  adds to one of the event's counters. Counters start at 0 every time the event runs
+ *   choice <key> <node> <label>    asks the player. Picking the key moves to the node
+ *   goto <node> [if <what> <op> <n> | chance <percent>]
+ *                                  moves on without asking. The first goto that passes is taken. <what> is a stat
+ *                                  (patk, matk, speed, gold, health, maxhealth, level) or a counter, <op> is < <= > >= == or !=
+ *
+ * When a node is entered its say and effect lines run in order, then it asks its choices if it has any,
+ * otherwise it takes its first passing goto. A node with neither ends the event.
+ */
+
+// the stats an event can check
+enum EventStat {STAT_PATK, STAT_MATK, STAT_SPEED, STAT_GOLD, STAT_HEALTH, STAT_MAX_HEALTH, STAT_LEVEL, NUM_EVENT_STATS};
+const char* const EVENT_STAT_NAMES[] = {"patk", "matk", "speed", "gold", "health", "maxhealth", "level"};
+
+// the things an event can do to the player. EFFECT_ADD only touches the event's own counters
+enum EventEffect {EFFECT_GOLD, EFFECT_PDAMAGE, EFFECT_MDAMAGE, EFFECT_HEAL, EFFECT_SET_HEALTH, EFFECT_ITEM, EFFECT_ADD, EFFECT_SAY};
+
+enum EventTest {TEST_ALWAYS, TEST_CHANCE, TEST_STAT, TEST_COUNTER};
+enum EventCompare {CMP_LT, CMP_LE, CMP_GT, CMP_GE, CMP_EQ, CMP_NE};
+
+// the most counters one event can use
+const unsigned EVENT_MAX_COUNTERS = 8;
+// runEvent() gives up after this many node transitions, in case a pack loops forever
+const unsigned EVENT_STEP_LIMIT = 100000;
+
+struct EventOp {
+    EventEffect effect;
+    int a, b; // gold: min and max. add: counter and amount. say: text index. everything else: a is the amount or ID
+};
+
+struct EventCondition {
+    EventTest test;
+    EventCompare compare;
+    int subject; // an EventStat or a counter
+    int value; // what to compare against, or the percent chance
+};
+
+struct EventChoice {
+    int key;
+    unsigned label; // text index
+    unsigned target;
+};
+
+struct EventGoto {
+    EventCondition when;
+    unsigned target;
+};
+
+/** EventNode: one step of an event. Its ops, choices and gotos are ranges in the pack's flat arrays. */
+struct EventNode {
+    unsigned firstOp, endOp;
+    unsigned firstChoice, endChoice;
+    unsigned firstGoto, endGoto;
+};
+
+struct EventDef {
+    unsigned id;
+    std::string name;
+    unsigned start; // the first node
+};
+
+/**
+ * EventActor: whoever an event happens to. Events never touch the player directly, so the same event can run against
+ * a real Adventurer, a stand-in for testing, or nothing in particular for benchmarks.
+ * */
+class EventActor {
+public:
+    virtual ~EventActor() = default;
+    virtual std::string name() = 0;
+    virtual int stat(EventStat stat) = 0;
+    /**
+     * apply: carries out an effect on the actor.
+     * args: effect (what to do), amount (the amount, or the item ID for EFFECT_ITEM)
+     * outputs: how much actually happened, e.g. the damage that got through
+     * */
+    virtual int apply(EventEffect effect, int amount) = 0;
+};
+
+class EventPack;
+
+/**
+ * EventChooser: picks a choice whenever an event asks. This is where a person, a script or a bot plugs in.
+ * */
+class EventChooser {
+public:
+    virtual ~EventChooser() = default;
+    /**
+     * choose: picks one of a node's choices.
+     * args: pack (the pack being run), node (the node asking)
+     * outputs: which choice, counting from 0 in the order they were written
+     * */
+    virtual unsigned choose(const EventPack& pack, const EventNode& node) = 0;
+};
+
+/**
+ * EventPack: a set of compiled events. Node names are turned into indices and all text goes into one pool when the pack
+ * is loaded, so running an event never looks anything up by name.
+ * */
+class EventPack {
+private:
+    std::vector<EventDef> events;
+    std::vector<EventNode> nodes;
+    std::vector<EventOp> ops;
+    std::vector<EventChoice> choices;
+    std::vector<EventGoto> gotos;
+    std::vector<std::string> texts;
+    std::unordered_map<unsigned, unsigned> byId; // factory ID -> position in events
+
+    static std::string unescape(const std::string& text) {
+        std::string out;
+        for (unsigned i = 0; i < text.size(); ++i) {
+            if (text[i] == '\\' && i + 1 < text.size() && (text[i + 1] == 'n' || text[i + 1] == 't')) {
+                out += text[++i] == 'n' ? '\n' : '\t';
+            } else out += text[i];
+        }
+        return out;
+    }
+
+    /** Reads the rest of a line, dropping the space in front of it. */
+    static std::string rest(std::istringstream& line) {
+        std::string text;
+        std::getline(line, text);
+        if (!text.empty() && text[0] == ' ') text.erase(0, 1);
+        return text;
+    }
+
+    unsigned addText(const std::string& text) {
+        texts.push_back(unescape(text));
+        return texts.size() - 1;
+    }
+
+public:
+    /**
+     * parse(): compiles a pack and adds its events to this one.
+     * args: in (the pack text), error (set to what went wrong, with the line number, if it fails)
+     * outputs: true if the whole pack was read. If it wasn't, don't run anything from this pack
+     * */
+    bool parse(std::istream& in, std::string& error) {
+        // node targets can point forward, so they are kept by name until the event is finished.
+        // each one is a choice ('c') or goto ('g') index along with the node name
+        std::unordered_map<std::string, unsigned> nodeNames;
+        std::vector<std::pair<std::pair<char, unsigned>, std::string> > pending;
+        std::unordered_map<std::string, int> counters;
+        bool inEvent = false;
+        unsigned lineNumber = 0;
+        std::string text;
+
+        auto fail = [&](const std::string& why) {
+            error = "line " + std::to_string(lineNumber) + ": " + why;
+            return false;
+        };
+        auto closeNode = [&]() {
+            if (nodes.empty()) return;
+            nodes.back().endOp = ops.size();
+            nodes.back().endChoice = choices.size();
+            nodes.back().endGoto = gotos.size();
+        };
+        auto closeEvent = [&]() -> bool {
+            if (nodes.size() == events.back().start) return fail("event " + std::to_string(events.back().id) + " has no nodes");
+            closeNode();
+            for (auto& p : pending) {
+                if (nodeNames.count(p.second) == 0) return fail("no node called " + p.second + " in event " + std::to_string(events.back().id));
+                unsigned& target = p.first.first == 'c' ? choices[p.first.second].target : gotos[p.first.second].target;
+                target = nodeNames[p.second];
+            }
+            pending.clear();
+            nodeNames.clear();
+            counters.clear();
+            return true;
+        };
+
+        while (std::getline(in, text)) {
+            ++lineNumber;
+            std::istringstream line(text);
+            std::string word;
+            if (!(line >> word) || word[0] == '#') continue;
+
+            if (word == "event") {
+                if (inEvent && !closeEvent()) return false;
+                EventDef def;
+                if (!(line >> def.id)) return fail("event needs an ID");
+                if (byId.count(def.id)) return fail("event " + std::to_string(def.id) + " is already defined");
+                def.name = rest(line);
+                def.start = nodes.size();
+                byId[def.id] = events.size();
+                events.push_back(def);
+                inEvent = true;
+                continue;
+            }
+            if (!inEvent) return fail("expected an event first");
+
+            if (word == "node") {
+                std::string name = rest(line);
+                if (name.empty() || nodeNames.count(name)) return fail("node needs a new name");
+                closeNode();
+                nodeNames[name] = nodes.size();
+                nodes.push_back(EventNode{(unsigned)ops.size(), 0, (unsigned)choices.size(), 0, (unsigned)gotos.size(), 0});
+                continue;
+            }
+            if (nodes.size() == events.back().start) return fail("expected a node first");
+
+            if (word == "say") {
+                ops.push_back(EventOp{EFFECT_SAY, (int)addText(rest(line)), 0});
+            } else if (word == "gold") {
+                int low, high;
+                if (!(line >> low)) return fail("gold needs an amount");
+                if (!(line >> high)) high = low;
+                if (high < low) return fail("gold range is backwards");
+                ops.push_back(EventOp{EFFECT_GOLD, low, high});
+            } else if (word == "pdamage" || word == "mdamage" || word == "heal" || word == "sethealth" || word == "item") {
+                int amount;
+                if (!(line >> amount)) return fail(word + " needs a number");
+                EventEffect effect = word == "pdamage" ? EFFECT_PDAMAGE : word == "mdamage" ? EFFECT_MDAMAGE
+                                   : word == "heal" ? EFFECT_HEAL : word == "sethealth" ? EFFECT_SET_HEALTH : EFFECT_ITEM;
+                ops.push_back(EventOp{effect, amount, 0});
+            } else if (word == "add") {
+                std::string counter;
+                int amount;
+                if (!(line >> counter >> amount)) return fail("add needs a counter and an amount");
+                if (counters.count(counter) == 0) {
+                    if (counters.size() == EVENT_MAX_COUNTERS) return fail("too many counters");
+                    int slot = counters.size();
+                    counters[counter] = slot;
+                }
+                ops.push_back(EventOp{EFFECT_ADD, counters[counter], amount});
+            } else if (word == "choice") {
+                int key;
+                std::string target;
+                if (!(line >> key >> target)) return fail("choice needs a key and a node");
+                choices.push_back(EventChoice{key, addText(rest(line)), 0});
+                pending.push_back(std::make_pair(std::make_pair('c', (unsigned)choices.size() - 1), target));
+            } else if (word == "goto") {
+                std::string target, kind;
+                if (!(line >> target)) return fail("goto needs a node");
+                EventCondition when{TEST_ALWAYS, CMP_EQ, 0, 0};
+                if (line >> kind) {
+                    if (kind == "chance") {
+                        when.test = TEST_CHANCE;
+                        if (!(line >> when.value)) return fail("chance needs a percent");
+                    } else if (kind == "if") {
+                        std::string subject, op;
+                        if (!(line >> subject >> op >> when.value)) return fail("if needs a stat, a comparison and a number");
+                        when.test = TEST_COUNTER;
+                        for (unsigned s = 0; s < NUM_EVENT_STATS; ++s) {
+                            if (subject == EVENT_STAT_NAMES[s]) {
+                                when.test = TEST_STAT;
+                                when.subject = s;
+                            }
+                        }
+                        if (when.test == TEST_COUNTER) {
+                            if (counters.count(subject) == 0) return fail("no stat or counter called " + subject);
+                            when.subject = counters[subject];
+                        }
+                        if (op == "<") when.compare = CMP_LT;
+                        else if (op == "<=") when.compare = CMP_LE;
+                        else if (op == ">") when.compare = CMP_GT;
+                        else if (op == ">=") when.compare = CMP_GE;
+                        else if (op == "==") when.compare = CMP_EQ;
+                        else if (op == "!=") when.compare = CMP_NE;
+                        else return fail("unknown comparison " + op);
+                    } else return fail("expected if or chance after goto");
+                }
+                gotos.push_back(EventGoto{when, 0});
+                pending.push_back(std::make_pair(std::make_pair('g', (unsigned)gotos.size() - 1), target));
+            } else {
+                return fail("unknown statement " + word);
+            }
+        }
+        return inEvent ? closeEvent() : true;
+    }
+
+    /** Reads a pack from a file. See parse(). */
+    bool load(const std::string& path, std::string& error) {
+        std::ifstream file(path);
+        if (!file) {
+            error = "could not open " + path;
+            return false;
+        }
+        return parse(file, error);
+    }
+
+    bool contains(unsigned id) const {
+        return byId.count(id) > 0;
+    }
+
+    /** Looks up an event by its factory ID. The ID has to be in the pack. */
+    const EventDef& event(unsigned id) const {
+        return events[byId.at(id)];
+    }
+
+    unsigned eventCount() const {
+        return events.size();
+    }
+
+    const EventDef& eventAt(unsigned index) const {
+        return events[index];
+    }
+
+    const EventNode& node(unsigned index) const { return nodes[index]; }
+    const EventOp& op(unsigned index) const { return ops[index]; }
+    const EventChoice& choice(unsigned index) const { return choices[index]; }
+    const EventGoto& jump(unsigned index) const { return gotos[index]; }
+    const std::string& text(unsigned index) const { return texts[index]; }
+};
+
+/**
+ * ConsoleChooser: asks the player through standard input, the way every other menu in the game does.
+ * */
+class ConsoleChooser : public EventChooser {
+public:
+    unsigned choose(const EventPack& pack, const EventNode& node) {
+        std::vector<int> keys;
+        for (unsigned c = node.firstChoice; c < node.endChoice; ++c) keys.push_back(pack.choice(c).key);
+        std::string input;
+        while (true) {
+            std::cin >> input;
+            if (!std::cin) return 0;
+            for (unsigned i = 0; i < keys.size(); ++i) {
+                if (input == std::to_string(keys[i])) return i;
+            }
+            std::cout << "Invalid input, please enter a valid number.\n";
+        }
+    }
+};
+
+/**
+ * ScriptedChooser: answers from a list of keys, in order. Once the list runs out, or a key isn't on offer, it picks the
+ * first choice. Handy for tests and replays.
+ * */
+class ScriptedChooser : public EventChooser {
+private:
+    std::vector<int> keys;
+    unsigned next = 0;
+
+public:
+    ScriptedChooser(const std::vector<int>& keys) : keys(keys) {}
+
+    unsigned choose(const EventPack& pack, const EventNode& node) {
+        if (next >= keys.size()) return 0;
+        int key = keys[next++];
+        for (unsigned c = node.firstChoice; c < node.endChoice; ++c) {
+            if (pack.choice(c).key == key) return c - node.firstChoice;
+        }
+        return 0;
+    }
+};
+
+/**
+ * RandomChooser: a bot that picks uniformly at random. Given the same seed it always plays the same way.
+ * */
+class RandomChooser : public EventChooser {
+private:
+    std::mt19937 rng;
+
+public:
+    RandomChooser(unsigned seed) : rng(seed) {}
+
+    unsigned choose(const EventPack& /* pack */, const EventNode& node) {
+        return rng() % (node.endChoice - node.firstChoice);
+    }
+};
+
+/**
+ * formatEventText(): fills in the {placeholders} of a say line.
+ * args: text (the line), actor (who the event is happening to), amount (the result of the last effect)
+ * outputs: the finished line
+ * */
+inline std::string formatEventText(const std::string& text, EventActor& actor, int amount) {
+    if (text.find('{') == std::string::npos) return text;
+    std::string out;
+    for (unsigned i = 0; i < text.size(); ++i) {
+        std::string::size_type close = text[i] == '{' ? text.find('}', i) : std::string::npos;
+        if (close == std::string::npos) {
+            out += text[i];
+            continue;
+        }
+        std::string key = text.substr(i + 1, close - i - 1);
+        if (key == "amount") out += std::to_string(amount);
+        else if (key == "name") out += actor.name();
+        else if (key == "name16") out += (actor.name() + std::string(16, ' ')).substr(0, 16);
+        else {
+            bool found = false;
+            for (unsigned s = 0; s < NUM_EVENT_STATS && !found; ++s) {
+                if (key == EVENT_STAT_NAMES[s]) {
+                    out += std::to_string(actor.stat((EventStat)s));
+                    found = true;
+                }
+            }
+            if (!found) out += text.substr(i, close - i + 1);
+        }
+        i = close;
+    }
+    return out;
+}
+
+/**
+ * runEvent(): runs an event from its first node until it ends.
+ * args: pack (where the event lives), id (the event's factory ID), actor (who it happens to), chooser (who makes the choices),
+ *       rng (used for gold amounts and chance gotos), out (where the text goes, or nullptr to run silently)
+ * outputs: the number of node transitions taken
+ * */
+inline unsigned runEvent(const EventPack& pack, unsigned id, EventActor& actor, EventChooser& chooser, std::mt19937& rng, std::ostream* out) {
+    int counters[EVENT_MAX_COUNTERS] = {0};
+    int amount = 0;
+    unsigned at = pack.event(id).start, steps = 0;
+
+    while (steps < EVENT_STEP_LIMIT) {
+        const EventNode& node = pack.node(at);
+        for (unsigned o = node.firstOp; o < node.endOp; ++o) {
+            const EventOp& op = pack.op(o);
+            switch (op.effect) {
+                case EFFECT_SAY:
+                    if (out != nullptr) *out << formatEventText(pack.text(op.a), actor, amount) << "\n";
+                    break;
+                case EFFECT_ADD: counters[op.a] += op.b; break;
+                case EFFECT_GOLD: amount = actor.apply(EFFECT_GOLD, op.a + (int)(rng() % (op.b - op.a + 1))); break;
+                default: amount = actor.apply(op.effect, op.a); break;
+            }
+        }
+
+        if (node.firstChoice != node.endChoice) {
+            if (out != nullptr) {
+                for (unsigned c = node.firstChoice; c < node.endChoice; ++c) {
+                    *out << pack.choice(c).key << ":\t" << pack.text(pack.choice(c).label) << "\n";
+                }
+            }
+            unsigned pick = chooser.choose(pack, node);
+            at = pack.choice(node.firstChoice + pick).target;
+            ++steps;
+            continue;
+        }
+
+        bool moved = false;
+        for (unsigned g = node.firstGoto; g < node.endGoto && !moved; ++g) {
+            const EventCondition& when = pack.jump(g).when;
+            bool pass = true;
+            int value = 0;
+            switch (when.test) {
+                case TEST_ALWAYS: break;
+                case TEST_CHANCE: pass = (int)(rng() % 100) < when.value; break;
+                case TEST_STAT: value = actor.stat((EventStat)when.subject); break;
+                case TEST_COUNTER: value = counters[when.subject]; break;
+            }
+            if (when.test == TEST_STAT || when.test == TEST_COUNTER) {
+                switch (when.compare) {
+                    case CMP_LT: pass = value < when.value; break;
+                    case CMP_LE: pass = value <= when.value; break;
+                    case CMP_GT: pass = value > when.value; break;
+                    case CMP_GE: pass = value >= when.value; break;
+                    case CMP_EQ: pass = value == when.value; break;
+                    case CMP_NE: pass = value != when.value; break;
+                }
+            }
+            if (pass) {
+                at = pack.jump(g).target;
+                moved = true;
+            }
+        }
+        if (!moved) break;
+        ++steps;
+    }
+    return steps;
+}
+
+#endif
@@ -3,7 +3,10 @@
 
 #include "./../source/Enemy.cpp"
 #include "./Item.hpp"
+#include "./Progression.hpp"
+#include "./ContentIndex.hpp"
 #include "./../source/OddityRoom.cpp"
+#include "./../source/AmbientRoom.cpp"
 
 /*		   ENEMY    ITEM    O.ROOM    ROOM
  *	   ID   : 10-### , 20-### , 30-### , 35-###
@@ -48,6 +51,62 @@ unsigned NUM_CONSUMABLES = 4; //Leave this be for now please!
 unsigned NUM_ODDITY_ROOMS = 4;
 unsigned NUM_AMBIENT_ROOMS = 11;
 
+/**
+ * contentIndex(): the tags and attributes of everything the factories below can make, indexed for queries.
+ * Add an entry here whenever something is added to a factory.
+ * Attributes are, in order: min level, max level, value, rarity, weight.
+ * args: none
+ * outputs: the index
+ * */
+inline const ContentIndex& contentIndex() {
+    static const ContentIndex index({
+        {10001, tagSet({TAG_ENEMY, TAG_UNDEAD, TAG_CRYPT}),                     {1, LEVEL_CAP, 0, 0, 30}},
+        {10002, tagSet({TAG_ENEMY, TAG_BEAST, TAG_CRYPT, TAG_WILDS, TAG_CAVE}), {1, LEVEL_CAP, 0, 0, 15}},
+        {10003, tagSet({TAG_ENEMY, TAG_SLIME, TAG_WILDS, TAG_CAVE}),            {2, LEVEL_CAP, 0, 0, 12}},
+        {10004, tagSet({TAG_ENEMY, TAG_UNDEAD, TAG_CRYPT}),                     {2, LEVEL_CAP, 0, 0, 20}},
+        {10005, tagSet({TAG_ENEMY, TAG_FAE, TAG_WILDS}),                        {1, LEVEL_CAP, 0, 0, 15}},
+        {10006, tagSet({TAG_ENEMY, TAG_SLIME, TAG_WILDS, TAG_CAVE}),            {1, LEVEL_CAP, 0, 0, 25}},
+        {10007, tagSet({TAG_ENEMY, TAG_UNDEAD, TAG_CRYPT}),                     {3, LEVEL_CAP, 0, 0, 15}},
+        {10008, tagSet({TAG_ENEMY, TAG_BEAST, TAG_CRYPT, TAG_CAVE}),            {3, LEVEL_CAP, 0, 0, 12}},
+        {10009, tagSet({TAG_ENEMY, TAG_BEAST, TAG_WILDS, TAG_CAVE}),            {1, LEVEL_CAP, 0, 0, 20}},
+
+        {20001, tagSet({TAG_ITEM, TAG_WEAPON, TAG_SHOP}),     {1, LEVEL_CAP, 100, Common, 1}},
+        {20002, tagSet({TAG_ITEM, TAG_WEAPON, TAG_SHOP}),     {1, LEVEL_CAP, 300, Rare, 1}},
+        {20003, tagSet({TAG_ITEM, TAG_WEAPON, TAG_SHOP}),     {1, LEVEL_CAP, 100, Common, 1}},
+        {20004, tagSet({TAG_ITEM, TAG_CONSUMABLE, TAG_SHOP}), {1, LEVEL_CAP, 30, Common, 1}},
+        {20005, tagSet({TAG_ITEM, TAG_CONSUMABLE, TAG_SHOP}), {1, LEVEL_CAP, 60, Uncommon, 1}},
+        {20006, tagSet({TAG_ITEM, TAG_CONSUMABLE, TAG_SHOP}), {1, LEVEL_CAP, 120, Rare, 1}},
+        {20007, tagSet({TAG_ITEM, TAG_CONSUMABLE, TAG_SHOP}), {1, LEVEL_CAP, 400, Epic, 1}},
+        {20008, tagSet({TAG_ITEM, TAG_ARMOR, TAG_SHOP}),      {1, LEVEL_CAP, 300, Uncommon, 1}},
+        {20009, tagSet({TAG_ITEM, TAG_TRINKET, TAG_SHOP}),    {1, LEVEL_CAP, 500, Rare, 1}},
+        {20010, tagSet({TAG_ITEM, TAG_TRINKET}),              {1, LEVEL_CAP, 400, Unique, 1}},
+        {20011, tagSet({TAG_ITEM, TAG_TRINKET}),              {1, LEVEL_CAP, 400, Unique, 1}},
+        {20012, tagSet({TAG_ITEM, TAG_TRINKET}),              {1, LEVEL_CAP, 1000, Unique, 1}},
+        {20013, tagSet({TAG_ITEM, TAG_WEAPON}),               {1, LEVEL_CAP, 1331, Unique, 1}},
+        {20014, tagSet({TAG_ITEM, TAG_WEAPON}),               {1, LEVEL_CAP, 0, Unique, 1}},
+        {20015, tagSet({TAG_ITEM, TAG_CONSUMABLE}),           {1, LEVEL_CAP, 30, Common, 1}},
+        {20016, tagSet({TAG_ITEM, TAG_TRINKET}),              {1, LEVEL_CAP, 1000, Legendary, 1}},
+
+        {30001, tagSet({TAG_ODDITY_ROOM, TAG_CRYPT, TAG_CAVE}),  {1, LEVEL_CAP, 0, 0, 1}},
+        {30002, tagSet({TAG_ODDITY_ROOM, TAG_CRYPT, TAG_CAVE}),  {1, LEVEL_CAP, 0, 0, 1}},
+        {30003, tagSet({TAG_ODDITY_ROOM, TAG_WILDS}),            {1, LEVEL_CAP, 0, 0, 2}},
+        {30004, tagSet({TAG_ODDITY_ROOM, TAG_CRYPT, TAG_WILDS}), {1, LEVEL_CAP, 0, 0, 1}},
+
+        {35001, tagSet({TAG_AMBIENT_ROOM, TAG_WILDS}),           {1, LEVEL_CAP, 0, 0, 20}},
+        {35002, tagSet({TAG_AMBIENT_ROOM, TAG_CRYPT}),           {1, LEVEL_CAP, 0, 0, 30}},
+        {35003, tagSet({TAG_AMBIENT_ROOM, TAG_WILDS}),           {1, LEVEL_CAP, 0, 0, 25}},
+        {35004, tagSet({TAG_AMBIENT_ROOM, TAG_WILDS, TAG_CAVE}), {1, LEVEL_CAP, 0, 0, 15}},
+        {35005, tagSet({TAG_AMBIENT_ROOM, TAG_WILDS}),           {1, LEVEL_CAP, 0, 0, 15}},
+        {35006, tagSet({TAG_AMBIENT_ROOM, TAG_CAVE}),            {1, LEVEL_CAP, 0, 0, 30}},
+        {35007, tagSet({TAG_AMBIENT_ROOM, TAG_CRYPT, TAG_CAVE}), {1, LEVEL_CAP, 0, 0, 10}},
+        {35008, tagSet({TAG_AMBIENT_ROOM, TAG_CAVE}),            {1, LEVEL_CAP, 0, 0, 25}},
+        {35009, tagSet({TAG_AMBIENT_ROOM, TAG_CRYPT}),           {1, LEVEL_CAP, 0, 0, 20}},
+        {35010, tagSet({TAG_AMBIENT_ROOM, TAG_CRYPT}),           {1, LEVEL_CAP, 0, 0, 20}},
+        {35011, tagSet({TAG_AMBIENT_ROOM, TAG_WILDS, TAG_CAVE}), {1, LEVEL_CAP, 0, 0, 12}}
+    });
+    return index;
+}
+
 class EnemyFactory {
 public:
     Enemy* generate(unsigned int id) {
@@ -91,29 +150,26 @@ public:
     }
 };
 
+/** Builds an item from its factory ID. Oddity rooms use this to hand out their rewards. */
+inline Item* makeItem(unsigned id) {
+    ItemFactory items;
+    return items.generate(id);
+}
+
 class RoomFactory {
 public:
     Room* generate(unsigned int id) {
-        switch(id) {
-            //ODDITY ROOMS BASE FROM ID 30000
-            case 30001: return new GoldStatueRoom();
-            case 30002: return new DartTrapRoom();
-            case 30003: return new CatRoom();
-            case 30004: return new MirrorRoom();
-            //AMBIENT ROOMS BASE FROM ID 35000
-            case 35001: return new Room("A room with a tree","This room has a small tree growing from the cracked earth.\nYou're not quite sure how it is surviving, but you quietly cheer it on.");
-            case 35002: return new Room("A stone hallway","Your footsteps echo as you walk down this stone corridor.\nIt's a bit too quiet... you check behind yourself just to make sure, but you're safe.");
-            case 35003: return new Room("A meadow","You wander into a calm meadow. It feels out of place, but the spot of tranquility nevertheless is appreciated.");
-            case 35004: return new Room("A small lake","To call this a lake is an overstatement... more like a small pool of murky water.\nYou aren't even close to thirsty enough to drink from it.");
-            case 35005: return new Room("A room of grey sand","The ground beneath your feet crumbles, and you realize it is sand. A small, broken rake lies in the rubble.\nWas this a zen garden of some kind?");
-            case 35006: return new Room("A cave","You hear water droplets echo through this small cave, dripping from a stalactite nearby.\nYou cautiously hold your hand out and taste it.");
-            case 35007: return new Room("An abandoned forge","The remains of a forge lay scattered around this room. It seems like it hasn't seen activitiy in years.");
-            case 35008: return new Room("A stone hallway","Your footsteps echo as you walk down--- ECKPTH!! You walked into a spiderweb!!");
-            case 35009: return new Room("A well-lit hall","This hallway has several torches bolted into their brackets.\nSome are extinguished, but the rest pleasantly light the way.");
-            case 35010: return new Room("A stone hallway","Your footsteps echo as you walk down the stone corridor. You hear the click of a pressure plate...\nbut nothing happens. You breathe a sigh of relief for outdated tech.");
-            case 35011: return new Room("A wooden bridge","You make your way to a narrow chasm with planks of wood percariously bridging the gap.\nYou take extreme caution, but you make it across without issue.");
-            default: std::cout << "There was an error in generating oddity room. Is the ID correct?\n"; exit(1);
-        }
+        //ODDITY ROOMS BASE FROM ID 30000, their events are in OddityEvents.hpp
+        if (oddityEvents().contains(id)) return new EventRoom(oddityEvents(), id, &makeItem);
+        //AMBIENT ROOMS BASE FROM ID 35000, their text is in AmbientRoom.cpp
+        if (AmbientRoom::isAmbient(id)) return new AmbientRoom(id);
+        std::cout << "There was an error in generating oddity room. Is the ID correct?\n"; exit(1);
+    }
+
+    /** This is a version of the above generate that hands rooms which roll while they play out a seed to roll with. */
+    Room* generate(unsigned int id, unsigned seed) {
+        if (oddityEvents().contains(id)) return new EventRoom(oddityEvents(), id, &makeItem, seed);
+        return generate(id);
     }
 };
 
@@ -0,0 +1,216 @@
+#ifndef __INVENTORY_H__
+#define __INVENTORY_H__
+
+#include "./Item.hpp"
+
+#include <vector>
+#include <unordered_map>
+
+// how many slots are shown at once when browsing the bag
+const unsigned INVENTORY_PAGE_SIZE = 10;
+
+/**
+ * InventorySlot: a single entry in the bag.
+ * Consumables with the same ID share one slot and only keep a single copy of the item around.
+ * Everything else gets a slot of its own, since items like the Mirror's Edge carry their own state.
+ * */
+struct InventorySlot {
+    Item* item;
+    unsigned count;
+};
+
+/** A filter for Inventory::view() that only lets consumables through. */
+inline bool consumablesOnly(Item* item){
+    return item->isConsumable();
+}
+
+class Inventory {
+private:
+    std::vector<InventorySlot> slots;
+    std::unordered_multimap<unsigned, unsigned> index; // item ID -> slot(s) holding it
+    unsigned total = 0;
+
+    /**
+     * reindex: points the index entry for an item at a different slot.
+     * args: id (the item's ID), from (the slot it used to be in), to (the slot it is in now)
+     * outputs: none
+     * */
+    void reindex(unsigned id, unsigned from, unsigned to){
+        auto range = index.equal_range(id);
+        for (auto it = range.first; it != range.second; ++it){
+            if (it->second == from){
+                it->second = to;
+                return;
+            }
+        }
+    }
+
+    /** Removes the index entry for an item in a given slot. */
+    void unindex(unsigned id, unsigned slot){
+        auto range = index.equal_range(id);
+        for (auto it = range.first; it != range.second; ++it){
+            if (it->second == slot){
+                index.erase(it);
+                return;
+            }
+        }
+    }
+
+public:
+    Inventory() = default;
+    Inventory(const Inventory&) = delete;
+    Inventory& operator=(const Inventory&) = delete;
+
+    ~Inventory(){
+        clear();
+    }
+
+    /**
+     * add: puts an item into the bag. The bag takes ownership of the item.
+     * Consumables stack onto an existing slot with the same ID if there is one, in which case the new copy is deleted.
+     * args: item (the item to be added)
+     * outputs: the slot the item ended up in
+     * */
+    unsigned add(Item* item){
+        ++total;
+        if (item->isConsumable()){
+            int existing = find(item->getID());
+            if (existing != -1){
+                ++slots[existing].count;
+                delete item;
+                return existing;
+            }
+        }
+        slots.push_back(InventorySlot{item, 1});
+        index.insert(std::make_pair(item->getID(), (unsigned)(slots.size() - 1)));
+        return slots.size() - 1;
+    }
+
+    /**
+     * restore: puts a whole slot back into the bag as it was saved, without looking for a stack to add it to.
+     * Use this when loading a save, where every slot is already known to be separate.
+     * args: item (the item, the bag takes ownership of it), count (how many of it are in the slot)
+     * outputs: none
+     * */
+    void restore(Item* item, unsigned count){
+        total += count;
+        slots.push_back(InventorySlot{item, count});
+        index.insert(std::make_pair(item->getID(), (unsigned)(slots.size() - 1)));
+    }
+
+    /**
+     * consume: uses up one item from a slot. If that was the last one, the slot is removed.
+     * Removal swaps the last slot into the freed position, so slot numbers past this one may change.
+     * args: slot (the slot to take from)
+     * outputs: none
+     * */
+    void consume(unsigned slot){
+        --total;
+        if (--slots[slot].count > 0) return;
+
+        unsigned id = slots[slot].item->getID();
+        delete slots[slot].item;
+        unindex(id, slot);
+
+        unsigned last = slots.size() - 1;
+        if (slot != last){
+            slots[slot] = slots[last];
+            reindex(slots[slot].item->getID(), last, slot);
+        }
+        slots.pop_back();
+    }
+
+    /**
+     * find: looks up an item by its ID.
+     * args: id (the ID to search for)
+     * outputs: a slot holding that item, or -1 if there isn't one
+     * */
+    int find(unsigned id) const {
+        auto it = index.find(id);
+        if (it == index.end()) return -1;
+        return it->second;
+    }
+
+    /** This is a version of the above that only matches an item in a given state (see Item::saveState()). */
+    int find(unsigned id, unsigned state) const {
+        auto range = index.equal_range(id);
+        for (auto it = range.first; it != range.second; ++it){
+            if (slots[it->second].item->saveState() == state) return it->second;
+        }
+        return -1;
+    }
+
+    /** Returns the total number of items with a given ID. */
+    unsigned count(unsigned id) const {
+        unsigned amount = 0;
+        auto range = index.equal_range(id);
+        for (auto it = range.first; it != range.second; ++it) amount += slots[it->second].count;
+        return amount;
+    }
+
+    /** Getters for individual slots. */
+    Item* at(unsigned slot) const {
+        return slots[slot].item;
+    }
+
+    unsigned countAt(unsigned slot) const {
+        return slots[slot].count;
+    }
+
+    /** Returns the total number of items in the bag, counting every item in a stack. */
+    unsigned size() const {
+        return total;
+    }
+
+    /** Returns the number of occupied slots. */
+    unsigned slotCount() const {
+        return slots.size();
+    }
+
+    bool empty() const {
+        return slots.empty();
+    }
+
+    /**
+     * view: gets one page of slots that pass a filter.
+     * args: filter (returns true for items to show, nullptr shows everything), page (which page, starting at 0),
+     *       pageSize (slots per page), hasMore (set to true if there are more matching slots after this page)
+     * outputs: the slot numbers on this page
+     * */
+    std::vector<unsigned> view(bool (*filter)(Item*), unsigned page, unsigned pageSize, bool& hasMore) const {
+        std::vector<unsigned> result;
+        hasMore = false;
+        unsigned skip = page * pageSize;
+
+        // with no filter the page can be sliced out directly
+        if (filter == nullptr){
+            for (unsigned i = skip; i < slots.size() && result.size() < pageSize; ++i) result.push_back(i);
+            hasMore = skip + pageSize < slots.size();
+            return result;
+        }
+
+        for (unsigned i = 0; i < slots.size(); ++i){
+            if (!filter(slots[i].item)) continue;
+            if (skip > 0){
+                --skip;
+                continue;
+            }
+            if (result.size() == pageSize){
+                hasMore = true;
+                break;
+            }
+            result.push_back(i);
+        }
+        return result;
+    }
+
+    /** Deletes everything in the bag. */
+    void clear(){
+        for (auto& slot : slots) delete slot.item;
+        slots.clear();
+        index.clear();
+        total = 0;
+    }
+};
+
+#endif
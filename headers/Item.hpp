@@ -2,6 +2,8 @@
 #define __ITEM_H__
 
 #include "./../source/InputReader.cpp"
+#include "./Dice.hpp"
+#include "./Console.hpp"
 
 #include <iostream>
 #include <string>
@@ -18,7 +20,13 @@ enum Rarity{Common, Uncommon, Rare, Epic, Legendary, Unique};
  * Unique: A one-of-a-kind item. Reserve this rarity for quest items and special items. 
  * */
 
+class ItemCooldowns;
+
 class Item{
+    friend class ItemCooldowns;
+private:
+    int cooldownSlot = -1; // position in the owner's ItemCooldowns list, -1 while not on cooldown
+
 protected:
     std::string name;
     std::string description;
@@ -26,6 +34,7 @@ protected:
     std::string abilityDescription;
 	int maxHealth = 0, physAtk = 0, physDef = 0, magAtk = 0, magDef = 0, speed = 0, cooldown = 0, maxCooldown = 0, value = 0;
     unsigned ID;
+    Rarity rarity = Common;
     bool consumable = false, selfUse = false; 
     // items with the self-use flag set to true should not make use of the second target field in their ability().
     // items with the consumable flag set to true should never have any stat bonuses. 
@@ -36,6 +45,8 @@ public:
         this->description = "a description";
     }
 
+    virtual ~Item() = default;
+
     void inspect(){
         std::cout << name << ": " << description << "\n" << abilityName << ": " << abilityDescription << "\n";
         if (maxHealth > 0) std::cout << "Max Health: +" << maxHealth << "\n";
@@ -105,6 +116,10 @@ public:
         return abilityDescription;
     }
 
+    Rarity getRarity(){
+        return rarity;
+    }
+
     /** These methods handle the ability's cooldown, if it has one. */
     bool abilityAvailable(){
         return cooldown <= 0;
@@ -121,6 +136,28 @@ public:
     void updateCooldown(){
         if (cooldown > 0) --cooldown;
     }
+
+    void setCooldown(int turns){
+        cooldown = turns;
+    }
+
+    /**
+     * saveState(): packs whatever an item changes about itself while it is being used into a single number, for save files.
+     * Most items don't change, so the default saves nothing.
+     * args: none
+     * outputs: the packed state
+     * */
+    virtual unsigned saveState() const {
+        return 0;
+    }
+
+    /** Undoes saveState() on a freshly made item. */
+    virtual void loadState(unsigned /* state */){}
+
+    /** Returns whether using the item right now stops to ask the player something, so nothing can use it on their behalf. */
+    virtual bool asksPlayer() const {
+        return false;
+    }
 };
 
 
@@ -137,7 +174,7 @@ public:
 	}
 
 	void ability(Entity* user, Entity* target) {
-		std::cout << "You slash at " << target->getName() << " with the blade, dealing " 
+		gameOut() << "You slash at " << target->getName() << " with the blade, dealing " 
         << target->dealPDamage(user->getPAtk() * 1.2) << " physical damage.\n";
 	}
 };
@@ -154,11 +191,12 @@ public:
         physAtk = 10;
         speed = 10;
         value = 300;
+        rarity = Rare;
         ID = 20002;
     }
 
     void ability(Entity* user, Entity* target) {
-		std::cout << "Channeling its power, you slash at " << target->getName() << " with the " << name << ". "
+		gameOut() << "Channeling its power, you slash at " << target->getName() << " with the " << name << ". "
         << "The very air splits where you cut it, sending several sharp blades of air towards your target. They deal " 
         << target->dealPDamage(user->getPAtk() * 1.2 + user->getSpeed() * 0.2) << " physical damage. \n";
 	}
@@ -178,7 +216,7 @@ public:
 	}
 
 	void ability(Entity* user, Entity* target) {
-		std::cout << "You wave your " << name << " while summoning the traces of magical energy within, dealing " 
+		gameOut() << "You wave your " << name << " while summoning the traces of magical energy within, dealing " 
         << target->dealMDamage(user->getMAtk() * 1.2) << " damage.\n";
 	}
 };
@@ -201,7 +239,7 @@ public:
 	}
 
 	void ability(Entity* user, Entity* target) {
-		std::cout << "You pop off the cap and down the potion, restoring " << healstrength << " health. It tastes faintly of cherries.\n";
+		gameOut() << "You pop off the cap and down the potion, restoring " << healstrength << " health. It tastes faintly of cherries.\n";
         user->heal(healstrength);
 	}
 };
@@ -220,11 +258,12 @@ public:
         consumable = true;
         selfUse = true;
         value = 60;
+        rarity = Uncommon;
         ID = 20005;
 	}
 
 	void ability(Entity* user, Entity* target) {
-		std::cout << "You pop off the cap and down the potion, restoring " << healstrength << " health. It tastes of cherries and mint.\n";
+		gameOut() << "You pop off the cap and down the potion, restoring " << healstrength << " health. It tastes of cherries and mint.\n";
         user->heal(healstrength);
 	}
 };
@@ -243,11 +282,12 @@ public:
         consumable = true;
         selfUse = true;
         value = 120;
+        rarity = Rare;
         ID = 20006;
 	}
 
 	void ability(Entity* user, Entity* target) {
-		std::cout << "You pop off the cap and down the potion, restoring " << healstrength << " health. It tastes of strong mint mixed with cherries.\n";
+		gameOut() << "You pop off the cap and down the potion, restoring " << healstrength << " health. It tastes of strong mint mixed with cherries.\n";
         user->heal(healstrength);
 	}
 };
@@ -266,11 +306,12 @@ public:
         consumable = true;
         selfUse = true;
         value = 400;
+        rarity = Epic;
         ID = 20007;
 	}
 
 	void ability(Entity* user, Entity* target) {
-		std::cout << "You pop off the cap and down the potion, restoring " << healstrength << " health. Healer who??? I only know the Super Mega Healing Potion!\n";
+		gameOut() << "You pop off the cap and down the potion, restoring " << healstrength << " health. Healer who??? I only know the Super Mega Healing Potion!\n";
         user->heal(healstrength);
 	}
 };
@@ -285,11 +326,12 @@ public:
 		speed = 20;
         consumable = false;
         value = 300;
+        rarity = Uncommon;
         ID = 20008;
 	}
 	
 	void ability(Entity* user, Entity* target) {
-        std::cout << "You pull the shoes off your feet and slap " << target->getName() << ". "
+        gameOut() << "You pull the shoes off your feet and slap " << target->getName() << ". "
                   << "It does " << target->dealPDamage(user->getPAtk() * 0.5) << " damage.\n";
 	}
 };
@@ -307,13 +349,14 @@ public:
         magDef = 5;
         maxCooldown = 3;
         value = 500;
+        rarity = Rare;
         ID = 20009;
     }
 
     void ability(Entity* user, Entity* target) {
-        int modifier = rand() % 100 + 1;
+        int modifier = roll(100) + 1;
         int damage = user->getMAtk() * (200 + modifier) / 100;
-        std::cout << "You hold the orb out towards " << target->getName() << " and focus your mind. A magical fire engulfs your arm "
+        gameOut() << "You hold the orb out towards " << target->getName() << " and focus your mind. A magical fire engulfs your arm "
                   << "briefly before billowing outwards towards your target. It deals " << target->dealMDamage(damage) << " magical damage.\n";
         cooldown = maxCooldown;
     }
@@ -329,11 +372,12 @@ public:
         physAtk = 20;
         physDef = 10;
         value = 400;
+        rarity = Unique;
         ID = 20010;
     }
 
     void ability(Entity* user, Entity* target) {
-        std::cout << "You press on the red cat's paw. It squeaks.\n";
+        gameOut() << "You press on the red cat's paw. It squeaks.\n";
     }
 };
 
@@ -347,11 +391,12 @@ public:
         magAtk = 20;
         magDef = 10;
         value = 400;
+        rarity = Unique;
         ID = 20011;
     }
 
     void ability(Entity* user, Entity* target) {
-        std::cout << "You press on the blue cat's paw. It squeaks.\n";
+        gameOut() << "You press on the blue cat's paw. It squeaks.\n";
     }
 };
 
@@ -365,11 +410,12 @@ public:
         speed = 10;
         magAtk = 5;
         value = 1000;
+        rarity = Unique;
         ID = 20012;
     }
 
     void ability(Entity* user, Entity* target) {
-        std::cout << "You press on the gold cat's paw. It squeaks. All of a sudden, a golden ray of light blasts out towards "
+        gameOut() << "You press on the gold cat's paw. It squeaks. All of a sudden, a golden ray of light blasts out towards "
                   << target->getName() << ", dealing " << target->dealMDamage(user->getMAtk() * 0.8) << " magic damage. Additionally, "
                   << "the paw bathes you in warm golden sparkles, curing some of your wounds and restoring " << (int)round(user->getMaxHealth() * 0.06) << " health.\n";
         user->heal((int)round(user->getMaxHealth() * 0.06));
@@ -394,12 +440,40 @@ public:
         consumable = false;
         sheathed = true;
         damage = 0;
+        rarity = Unique;
         ID = 20013;
     }
 
+    /** The lowest bit is whether the blade is sheathed, the rest is the damage it has soaked up. */
+    unsigned saveState() const {
+        return (damage << 1) | (sheathed ? 1 : 0);
+    }
+
+    /** Wielding the blade asks whether to throw it or put it away. */
+    bool asksPlayer() const {
+        return !sheathed;
+    }
+
+    void loadState(unsigned state) {
+        damage = state >> 1;
+        sheathed = (state & 1) != 0;
+        if (sheathed) {
+            abilityName = "Unsheathe";
+            abilityDescription = "Draw the blade from its scabbard.";
+            physAtk = 0;
+            magAtk = 22;
+        }
+        else {
+            abilityName = "Wield";
+            abilityDescription = "Throw the blade, or return it to its home.";
+            physAtk = 22;
+            magAtk = 0;
+        }
+    }
+
     void ability(Entity* user, Entity* target) {
         if (sheathed) {
-            std::cout << "You unsheathe the knife. It makes a sound like resonating crystal.\n";
+            gameOut() << "You unsheathe the knife. It makes a sound like resonating crystal.\n";
             sheathed = false;
             abilityName = "Wield";
             abilityDescription = "Throw the blade, or return it to its home.";
@@ -409,22 +483,22 @@ public:
         else {
             InputReader read;
             int choices[2] = {1, 2};
-            std::cout << "You grip the Mirror's Edge in your hand. It feels ";
-            if (damage == 0) { std::cout << "cold.\n"; }
-            else if (damage <= 100) { std::cout << "warm.\n"; }
-            else { std::cout << "hot.\n"; }
-            std::cout << "1.\tThrow the blade\n"
+            gameOut() << "You grip the Mirror's Edge in your hand. It feels ";
+            if (damage == 0) { gameOut() << "cold.\n"; }
+            else if (damage <= 100) { gameOut() << "warm.\n"; }
+            else { gameOut() << "hot.\n"; }
+            gameOut() << "1.\tThrow the blade\n"
                       << "2.\tSheathe the blade\n";
             int select = read.readInput(choices,2);
             if (select == 1) {
                 int dmg = target->dealPDamage(user->getPAtk());
-                std::cout << "You twirl the knife in your hand and hurl it at " << target->getName()
+                gameOut() << "You twirl the knife in your hand and hurl it at " << target->getName()
                           << ", dealing " << dmg << " physical damage.\n"
                           << "You see it hit, and yet the knife stays in your hand.\n";
                 damage += dmg;
             }
             else {
-                std::cout << ".latsyrc gnitanoser ekil dnuos a sekam tI .efink eht ehtaehs uoY\n"
+                gameOut() << ".latsyrc gnitanoser ekil dnuos a sekam tI .efink eht ehtaehs uoY\n"
                           << ".dloc sleef niaga edalb ehT\n";
                 user->heal(damage);
                 damage = 0;
@@ -445,11 +519,12 @@ public:
         description = "for testing";
         abilityName = "debufftest";
         abilityDescription = "debufftest";
+        rarity = Unique;
         ID = 20014;
     }
 
     void ability(Entity* user, Entity* target){
-        std::cout << "Apply all buffs to user and all debuffs to target.\n";
+        gameOut() << "Apply all buffs to user and all debuffs to target.\n";
         user->buff(PHYS_ATK, 2);
         user->buff(PHYS_DEF, 2);
         user->buff(MAG_ATK, 2);
@@ -483,7 +558,7 @@ public:
         }
 
         void ability(Entity* user, Entity* target){
-                std::cout << "As you hold up the bottle, the alluring smell of something sweet yet musty fills your senses. Quickly, you pop off the cap and are hit with the sickening smell of roses. You peer into the bottle and notice droplets of....is that blood?. Somehow, you can't resist anymore despite your slight disgust and you down the potion quickly, feeling a bit of a burning sensation. You feel good and gain " << healStrength << " health, but then you start to cough violently and you end up losing " << damageStrength << " health. Darn, you're worse for wear now. Never trust mysterious items again.\n";
+                gameOut() << "As you hold up the bottle, the alluring smell of something sweet yet musty fills your senses. Quickly, you pop off the cap and are hit with the sickening smell of roses. You peer into the bottle and notice droplets of....is that blood?. Somehow, you can't resist anymore despite your slight disgust and you down the potion quickly, feeling a bit of a burning sensation. You feel good and gain " << healStrength << " health, but then you start to cough violently and you end up losing " << damageStrength << " health. Darn, you're worse for wear now. Never trust mysterious items again.\n";
         user->heal(healStrength);
         user->dealPDamage(damageStrength);
         }
@@ -503,10 +578,11 @@ public:
 		healStrength = 50; 
 		consumable = false; 
 		selfUse = true;  
+		rarity = Legendary;
 		ID = 20016; 
 	}
 	void ability(Entity* user, Entity* target){
-		std::cout << "Grasping the metal, it feels cool in the palm of your hand but begins to warm slightly from within. You have a rising urge to push the knob and open it but...you're scared. You know it's not just for telling the time. Taking a breath, you close your eyes and open the watch, feeling a sort of energy slither throughout your body and restore " << healStrength << " of your health. You then lift your hands and channel its power towards " << target->getName() << ", knocking them back and dealing " << target->dealMDamage(user->getMAtk() * 1.2) << " damage. You pocket it for later use.\n"; 
+		gameOut() << "Grasping the metal, it feels cool in the palm of your hand but begins to warm slightly from within. You have a rising urge to push the knob and open it but...you're scared. You know it's not just for telling the time. Taking a breath, you close your eyes and open the watch, feeling a sort of energy slither throughout your body and restore " << healStrength << " of your health. You then lift your hands and channel its power towards " << target->getName() << ", knocking them back and dealing " << target->dealMDamage(user->getMAtk() * 1.2) << " damage. You pocket it for later use.\n"; 
 	}
 }; 
 
@@ -0,0 +1,75 @@
+#ifndef __ITEM_COOLDOWNS_H__
+#define __ITEM_COOLDOWNS_H__
+
+#include "./Item.hpp"
+
+#include <vector>
+
+/**
+ * ItemCooldowns: keeps track of the items that are currently on cooldown so only those get ticked.
+ * Each tracked item remembers its own position in the active list, which makes adding and removing an item O(1)
+ * and keeps a tick proportional to the number of items recovering rather than the size of the bag.
+ * This does not own the items. Release an item before deleting it.
+ * */
+class ItemCooldowns {
+private:
+    std::vector<Item*> active;
+
+    /** Removes the item at a position in the active list by swapping the last one into its place. */
+    void removeAt(unsigned position){
+        active[position]->cooldownSlot = -1;
+        if (position != active.size() - 1){
+            active[position] = active.back();
+            active[position]->cooldownSlot = position;
+        }
+        active.pop_back();
+    }
+
+public:
+    ItemCooldowns() = default;
+    ItemCooldowns(const ItemCooldowns&) = delete;
+    ItemCooldowns& operator=(const ItemCooldowns&) = delete;
+
+    /**
+     * track: starts ticking an item if it was just put on cooldown. Call this after an item's ability is used.
+     * Items that aren't on cooldown or are already being tracked are left alone.
+     * args: item (the item that was used)
+     * outputs: none
+     * */
+    void track(Item* item){
+        if (item->abilityAvailable() || item->cooldownSlot != -1) return;
+        item->cooldownSlot = active.size();
+        active.push_back(item);
+    }
+
+    /** Stops tracking an item, e.g. because it is about to be deleted. Does nothing if it isn't tracked. */
+    void release(Item* item){
+        if (item->cooldownSlot != -1) removeAt(item->cooldownSlot);
+    }
+
+    /**
+     * tick: counts down every tracked item by one turn. Items that become ready again are dropped from the list.
+     * args: none
+     * outputs: none
+     * */
+    void tick(){
+        for (unsigned i = 0; i < active.size();){
+            active[i]->updateCooldown();
+            if (active[i]->abilityAvailable()) removeAt(i); // the swapped in item still needs its tick, so don't advance
+            else ++i;
+        }
+    }
+
+    /** Returns the number of items currently recovering. */
+    unsigned size() const {
+        return active.size();
+    }
+
+    /** Stops tracking everything. */
+    void clear(){
+        for (auto item : active) item->cooldownSlot = -1;
+        active.clear();
+    }
+};
+
+#endif
@@ -0,0 +1,449 @@
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+#include "./SaveGame.hpp"
+#include "./Town.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * Journal file layout. The journal sits next to the save and only ever gets appended to:
+ *      JournalHeader               which save it continues from
+ *      JournalEntry, payload       one per change, in the order they happened
+ * Every entry carries its sequence number and a CRC-32 of itself and its payload. If the game dies halfway through writing
+ * one, the torn entry won't check out, and it and anything after it are thrown away the next time the game is loaded.
+ * */
+const char JOURNAL_MAGIC[4] = {'L', 'B', 'D', 'J'};
+const uint32_t JOURNAL_VERSION = 1;
+// once the journal holds this many entries it gets folded into the save the next time the player gets to a town
+const unsigned JOURNAL_COMPACT_AT = 256;
+
+enum JournalKind {
+    JOURNAL_GOLD = 1,       // int32_t, gold gained (or lost)
+    JOURNAL_EXPERIENCE,     // int32_t, experience gained
+    JOURNAL_HEALTH,         // int32_t, health now
+    JOURNAL_HERO,           // SavedHero, for anything else about the character, like a level up
+    JOURNAL_ITEM_GAINED,    // JournalItem
+    JOURNAL_ITEM_LOST,      // JournalItem
+    JOURNAL_TOWN,           // SavedTown, a new town or a quest picked
+    JOURNAL_SCORE,          // uint64_t, the score now
+    JOURNAL_QUEST_STARTED,  // nothing
+    JOURNAL_ROOM_CLEARED,   // uint32_t, the room
+    JOURNAL_QUEST_ENDED     // nothing
+};
+
+struct JournalHeader {
+    char magic[4];
+    uint32_t version, byteOrder;
+    uint32_t generation; // the SaveHeader::generation of the save this journal goes on from
+};
+
+struct JournalEntry {
+    uint32_t sequence;
+    uint16_t kind, length; // a JournalKind, and the size of the payload after this
+    uint32_t checksum; // CRC-32 of this entry, with the checksum set to 0, followed by the payload
+};
+
+struct JournalItem {
+    uint32_t id, state, count; // see Item::saveState()
+};
+
+/**
+ * crc32(): the usual CRC-32 (the one zip files use). Pass the result back in as crc to carry on over more data.
+ * args: data (the bytes), size (how many), crc (the CRC so far)
+ * outputs: the CRC
+ * */
+inline uint32_t crc32(const void* data, size_t size, uint32_t crc = 0) {
+    static const std::vector<uint32_t> table = []() {
+        std::vector<uint32_t> built(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            built[i] = c;
+        }
+        return built;
+    }();
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/**
+ * JournalProgress: what replaying a journal found out beyond the character and the town.
+ * */
+struct JournalProgress {
+    bool inQuest = false; // the game stopped partway through a quest
+    std::vector<unsigned> cleared; // the rooms of that quest already played out, in order
+    unsigned entries = 0; // how many entries were replayed
+    bool torn = false; // whether a damaged tail had to be thrown away
+};
+
+/**
+ * Autosave: keeps the save up to date while the game is played. Rather than writing the whole game out every time something
+ * changes, it compares the character and the town with what it last wrote down and appends only the differences to the journal,
+ * all in a single write. Every so often the journal is folded into a fresh save and started over (see compact()).
+ * A save and its journal are tied together by a generation number, so a journal left over from an older save is never replayed on a newer one.
+ * */
+class Autosave : public TownListener {
+private:
+    typedef std::map<std::pair<uint32_t, uint32_t>, uint32_t> ItemCounts;
+
+    std::string savePath, journalPath;
+    int journal = -1;
+    uint32_t generation = 0, sequence = 0;
+    unsigned entries = 0; // in the journal since the last compaction
+    std::string pending; // entries waiting for flush()
+
+    // the game as far as the save and journal know
+    SavedHero hero;
+    SavedTown town;
+    uint64_t score = 0;
+    ItemCounts items;
+
+    static bool writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t done = ::write(fd, data, size);
+            if (done == -1) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += done;
+            size -= done;
+        }
+        return true;
+    }
+
+    void append(JournalKind kind, const void* payload, uint16_t length) {
+        JournalEntry entry{sequence++, (uint16_t)kind, length, 0};
+        entry.checksum = crc32(payload, length, crc32(&entry, sizeof(entry)));
+        pending.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        if (length > 0) pending.append(static_cast<const char*>(payload), length);
+        ++entries;
+    }
+
+    void flush() {
+        if (!pending.empty() && journal != -1 && !writeAll(journal, pending.data(), pending.size())) {
+            close(journal); // a journal with a hole in it is worse than none, stop here and keep the last good save
+            journal = -1;
+        }
+        pending.clear();
+    }
+
+    /** Starts an empty journal for the current generation. */
+    void startJournal() {
+        if (journal != -1) close(journal);
+        journal = open(journalPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        JournalHeader header;
+        memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        header.version = JOURNAL_VERSION;
+        header.byteOrder = SAVE_BYTE_ORDER;
+        header.generation = generation;
+        if (journal != -1 && !writeAll(journal, reinterpret_cast<const char*>(&header), sizeof(header))) {
+            close(journal);
+            journal = -1;
+        }
+        sequence = 0;
+        entries = 0;
+    }
+
+    /** Writes down how the character changed since the last time. */
+    void noteHero(const Adventurer* player) {
+        SavedHero now = SaveGame::heroRecord(player);
+        SavedHero same = hero; // the last record, with only the small changes applied
+        same.gold = now.gold;
+        same.experience = now.experience;
+        same.health = now.health;
+        if (memcmp(&same, &now, sizeof(now)) != 0) append(JOURNAL_HERO, &now, sizeof(now));
+        else {
+            int32_t change;
+            if (now.gold != hero.gold) { change = now.gold - hero.gold; append(JOURNAL_GOLD, &change, sizeof(change)); }
+            if (now.experience != hero.experience) { change = now.experience - hero.experience; append(JOURNAL_EXPERIENCE, &change, sizeof(change)); }
+            if (now.health != hero.health) append(JOURNAL_HEALTH, &now.health, sizeof(now.health));
+        }
+        hero = now;
+
+        ItemCounts bag;
+        SaveGame::countItems(player, bag);
+        ItemCounts::const_iterator before = items.begin(), after = bag.begin();
+        while (before != items.end() || after != bag.end()) {
+            if (after == bag.end() || (before != items.end() && before->first < after->first)) {
+                JournalItem lost{before->first.first, before->first.second, before->second};
+                append(JOURNAL_ITEM_LOST, &lost, sizeof(lost));
+                ++before;
+            }
+            else if (before == items.end() || after->first < before->first) {
+                JournalItem gained{after->first.first, after->first.second, after->second};
+                append(JOURNAL_ITEM_GAINED, &gained, sizeof(gained));
+                ++after;
+            }
+            else {
+                if (before->second != after->second) {
+                    bool more = after->second > before->second;
+                    JournalItem change{after->first.first, after->first.second, more ? after->second - before->second : before->second - after->second};
+                    append(more ? JOURNAL_ITEM_GAINED : JOURNAL_ITEM_LOST, &change, sizeof(change));
+                }
+                ++before;
+                ++after;
+            }
+        }
+        items.swap(bag);
+    }
+
+    /** Writes down the town if it changed since the last time. */
+    void noteTown(const Town* place) {
+        SavedTown now = SaveGame::townRecord(place);
+        if (memcmp(&now, &town, sizeof(now)) != 0) append(JOURNAL_TOWN, &now, sizeof(now));
+        town = now;
+    }
+
+    void noteScore(uint64_t now) {
+        if (now != score) append(JOURNAL_SCORE, &now, sizeof(now));
+        score = now;
+    }
+
+    /** Returns the payload size an entry of some kind must have, or -1 for kinds this version doesn't know. */
+    static int payloadSize(uint16_t kind) {
+        switch (kind) {
+            case JOURNAL_GOLD: case JOURNAL_EXPERIENCE: case JOURNAL_HEALTH: return sizeof(int32_t);
+            case JOURNAL_HERO: return sizeof(SavedHero);
+            case JOURNAL_ITEM_GAINED: case JOURNAL_ITEM_LOST: return sizeof(JournalItem);
+            case JOURNAL_TOWN: return sizeof(SavedTown);
+            case JOURNAL_SCORE: return sizeof(uint64_t);
+            case JOURNAL_ROOM_CLEARED: return sizeof(uint32_t);
+            case JOURNAL_QUEST_STARTED: case JOURNAL_QUEST_ENDED: return 0;
+            default: return -1;
+        }
+    }
+
+    /**
+     * replay(): applies the journal on top of the save that was just loaded. Stops at the first entry that doesn't check out
+     * and cuts the journal off there, so new entries carry on right after the last good one.
+     * */
+    void replay(Adventurer* player, Town*& place, uint64_t& points, JournalProgress& progress) {
+        int fd = open(journalPath.c_str(), O_RDWR);
+        std::string data;
+        struct stat info;
+        if (fd != -1 && fstat(fd, &info) == 0 && info.st_size > 0) {
+            data.resize(info.st_size);
+            size_t got = 0;
+            while (got < data.size()) {
+                ssize_t done = pread(fd, &data[got], data.size() - got, got);
+                if (done <= 0) break;
+                got += done;
+            }
+            data.resize(got);
+        }
+
+        JournalHeader header;
+        if (fd == -1 || data.size() < sizeof(header)) {
+            if (fd != -1) close(fd);
+            startJournal();
+            return;
+        }
+        memcpy(&header, data.data(), sizeof(header));
+        if (memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 || header.version != JOURNAL_VERSION
+            || header.byteOrder != SAVE_BYTE_ORDER || header.generation != generation) {
+            close(fd); // belongs to some other save, the save on its own is all there is
+            startJournal();
+            return;
+        }
+
+        bool townChanged = false;
+        size_t at = sizeof(header);
+        sequence = 0;
+        while (at < data.size()) {
+            JournalEntry entry;
+            if (data.size() - at < sizeof(entry)) break;
+            memcpy(&entry, data.data() + at, sizeof(entry));
+            if (entry.sequence != sequence || payloadSize(entry.kind) != entry.length || data.size() - at - sizeof(entry) < entry.length) break;
+            const char* payload = data.data() + at + sizeof(entry);
+            uint32_t checksum = entry.checksum;
+            entry.checksum = 0;
+            if (crc32(payload, entry.length, crc32(&entry, sizeof(entry))) != checksum) break;
+            if (entry.kind == JOURNAL_TOWN) {
+                SavedTown record;
+                memcpy(&record, payload, sizeof(record));
+                if (!validTownRecord(record)) break; // a town the game couldn't have made counts as damage like a bad checksum
+            }
+
+            int32_t value;
+            JournalItem item;
+            switch (entry.kind) {
+                case JOURNAL_GOLD: memcpy(&value, payload, sizeof(value)); hero.gold += value; break;
+                case JOURNAL_EXPERIENCE: memcpy(&value, payload, sizeof(value)); hero.experience += value; break;
+                case JOURNAL_HEALTH: memcpy(&hero.health, payload, sizeof(hero.health)); break;
+                case JOURNAL_HERO: memcpy(&hero, payload, sizeof(hero)); break;
+                case JOURNAL_ITEM_GAINED:
+                    memcpy(&item, payload, sizeof(item));
+                    if (SaveGame::gainItems(player, item.id, item.state, item.count)) items[std::make_pair(item.id, item.state)] += item.count;
+                    break;
+                case JOURNAL_ITEM_LOST: {
+                    memcpy(&item, payload, sizeof(item));
+                    ItemCounts::iterator held = items.find(std::make_pair(item.id, item.state));
+                    uint32_t taken = SaveGame::loseItems(player, item.id, item.state, item.count);
+                    if (held != items.end() && (held->second -= std::min(taken, held->second)) == 0) items.erase(held);
+                    break;
+                }
+                case JOURNAL_TOWN: memcpy(&town, payload, sizeof(town)); townChanged = true; break;
+                case JOURNAL_SCORE: memcpy(&points, payload, sizeof(points)); break;
+                case JOURNAL_QUEST_STARTED: progress.inQuest = true; progress.cleared.clear(); break;
+                case JOURNAL_ROOM_CLEARED: {
+                    uint32_t room;
+                    memcpy(&room, payload, sizeof(room));
+                    progress.cleared.push_back(room);
+                    break;
+                }
+                case JOURNAL_QUEST_ENDED: progress.inQuest = false; progress.cleared.clear(); break;
+            }
+            at += sizeof(entry) + entry.length;
+            ++sequence;
+        }
+        progress.entries = sequence;
+        entries = sequence;
+        score = points;
+        if (at < data.size()) {
+            progress.torn = true;
+            if (ftruncate(fd, at) != 0) { /* the next load will just cut it off again */ }
+        }
+        close(fd);
+
+        SaveGame::applyHero(player, hero);
+        if (townChanged) {
+            delete place;
+            place = SaveGame::buildTown(town);
+        }
+        journal = open(journalPath.c_str(), O_WRONLY | O_APPEND);
+    }
+
+public:
+    /**
+     * Autosave(): sets up autosaving to a save file and the journal next to it. Nothing is written until compact() or resume().
+     * args: path (where the save goes, the journal gets ".jnl" added)
+     * */
+    explicit Autosave(const std::string& path = SAVE_PATH) : savePath(path), journalPath(path + ".jnl") {
+        memset(&hero, 0, sizeof(hero));
+        memset(&town, 0, sizeof(town));
+        SaveFile existing(savePath.c_str());
+        if (existing.valid()) generation = existing.header().generation; // a new save has to outnumber any journal lying around
+    }
+
+    Autosave(const Autosave&) = delete;
+    Autosave& operator=(const Autosave&) = delete;
+
+    ~Autosave() {
+        flush();
+        if (journal != -1) close(journal);
+    }
+
+    /**
+     * compact(): writes the whole game out as a fresh save and starts an empty journal after it.
+     * Only call this in town, a save can't hold a quest that is partway done.
+     * args: player (the player), place (the town they are in), points (the score so far)
+     * outputs: true if the save was written. If it wasn't, the old save and journal are left as they were
+     * */
+    bool compact(const Adventurer* player, const Town* place, uint64_t points) {
+        flush();
+        if (!SaveGame::write(savePath.c_str(), player, place, points, generation + 1)) return false;
+        ++generation;
+        hero = SaveGame::heroRecord(player);
+        town = SaveGame::townRecord(place);
+        score = points;
+        SaveGame::countItems(player, items);
+        startJournal();
+        return true;
+    }
+
+    /**
+     * resume(): loads the save and replays its journal on top of it.
+     * args: player, place, points (set to the loaded game, the caller owns the first two), progress (what else the journal said)
+     * outputs: false if there is no usable save, in which case nothing is set
+     * */
+    bool resume(Adventurer*& player, Town*& place, uint64_t& points, JournalProgress& progress) {
+        SaveFile save(savePath.c_str());
+        if (!save.valid()) return false;
+        player = SaveGame::hero(save);
+        place = SaveGame::town(save);
+        points = save.header().score;
+        generation = save.header().generation;
+        hero = save.header().hero;
+        town = save.header().town;
+        SaveGame::countItems(player, items);
+        progress = JournalProgress();
+        replay(player, place, points, progress);
+        return true;
+    }
+
+    /** Writes down whatever the player did in town. */
+    void changed(const Adventurer* player, const Town* place) {
+        noteHero(player);
+        noteTown(place);
+        flush();
+    }
+
+    /** Writes down that the player set out on the quest they picked in a town. */
+    void questStarted(const Adventurer* player, const Town* place) {
+        noteHero(player);
+        noteTown(place);
+        append(JOURNAL_QUEST_STARTED, nullptr, 0);
+        flush();
+    }
+
+    /** Writes down a room the player got through, and what they got out of it. */
+    void roomCleared(const Adventurer* player, unsigned room) {
+        noteHero(player);
+        uint32_t index = room;
+        append(JOURNAL_ROOM_CLEARED, &index, sizeof(index)); // last, so the room only counts once everything it gave is in
+        flush();
+    }
+
+    /** Writes down that the quest is over, and the score after it. */
+    void questEnded(const Adventurer* player, uint64_t points) {
+        noteHero(player);
+        noteScore(points);
+        append(JOURNAL_QUEST_ENDED, nullptr, 0);
+        flush();
+    }
+
+    /**
+     * arrived(): writes down the town the player just got to, and folds the journal into the save if it has gotten long.
+     * args: player (the player), place (the new town), points (the score so far)
+     * outputs: none
+     * */
+    void arrived(const Adventurer* player, const Town* place, uint64_t points) {
+        if (entries >= JOURNAL_COMPACT_AT && compact(player, place, points)) return;
+        noteHero(player);
+        noteTown(place);
+        noteScore(points);
+        flush();
+    }
+
+    /** Returns how many entries are in the journal since the last compaction. */
+    unsigned journalEntries() const {
+        return entries;
+    }
+
+    uint32_t getGeneration() const {
+        return generation;
+    }
+
+    /** Returns whether changes are still being written down. This stops if the journal can't be written to. */
+    bool active() const {
+        return journal != -1;
+    }
+
+    const std::string& getJournalPath() const {
+        return journalPath;
+    }
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef __LOOT_H__
+#define __LOOT_H__
+
+#include "./Item.hpp"
+
+#include <vector>
+#include <random>
+#include <cstdlib>
+
+/**
+ * How likely each rarity is to drop, relative to a Common item with the same base weight.
+ * Unique items are quest and event rewards and never come out of a loot table.
+ * */
+const double RARITY_WEIGHT[] = {1.0, 0.5, 0.2, 0.05, 0.01, 0.0};
+
+/**
+ * AliasTable: a weighted die that can be rolled in constant time (Vose's alias method).
+ * Building the table is linear in the number of outcomes. After that each roll is one bucket pick
+ * and one coin flip, no matter how many outcomes there are.
+ * */
+class AliasTable {
+private:
+    std::vector<double> prob;
+    std::vector<unsigned> alias;
+
+public:
+    AliasTable() = default;
+
+    /**
+     * AliasTable(): builds the table from a list of weights. Weights don't need to add up to anything in particular.
+     * args: weights (how likely each outcome is, must not all be 0)
+     * */
+    explicit AliasTable(const std::vector<double>& weights) : prob(weights.size(), 0.0), alias(weights.size(), 0) {
+        unsigned n = weights.size();
+        double sum = 0;
+        for (double w : weights) sum += w;
+        if (n == 0 || sum <= 0) return;
+
+        // scale so the average bucket is exactly 1, then pair up underfull buckets with overfull ones
+        std::vector<double> scaled(n);
+        std::vector<unsigned> small, large;
+        for (unsigned i = 0; i < n; ++i){
+            scaled[i] = weights[i] * n / sum;
+            if (scaled[i] < 1.0) small.push_back(i);
+            else large.push_back(i);
+        }
+        while (!small.empty() && !large.empty()){
+            unsigned s = small.back(), l = large.back();
+            small.pop_back();
+            prob[s] = scaled[s];
+            alias[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0){
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // whatever is left over is full up to rounding error
+        for (unsigned i : large) prob[i] = 1.0;
+        for (unsigned i : small) prob[i] = 1.0;
+    }
+
+    /**
+     * sample(): rolls the table.
+     * args: none
+     * outputs: the index of the picked outcome
+     * */
+    unsigned sample() const {
+        unsigned bucket = rand() % prob.size();
+        return (double)rand() / ((double)RAND_MAX + 1.0) < prob[bucket] ? bucket : alias[bucket];
+    }
+
+    /**
+     * This is a version of the above sample that rolls with a given generator instead of rand(),
+     * so the same generator state always gives the same outcome.
+     * */
+    template <class Engine>
+    unsigned sample(Engine& rng) const {
+        unsigned bucket = (rng() - Engine::min()) % prob.size();
+        return (double)(rng() - Engine::min()) / ((double)(Engine::max() - Engine::min()) + 1.0) < prob[bucket] ? bucket : alias[bucket];
+    }
+
+    unsigned size() const {
+        return prob.size();
+    }
+};
+
+/**
+ * LootEntry: one item an enemy can drop.
+ * rarity should match the item's own rarity, it scales the base weight by RARITY_WEIGHT.
+ * */
+struct LootEntry {
+    unsigned itemID;
+    Rarity rarity;
+    double weight;
+};
+
+/**
+ * LootTable: what an enemy might drop when it dies. Rolling it either gives an item ID or nothing.
+ * The weights are turned into an alias table once when the table is made, so rolling never looks through the entries.
+ * */
+class LootTable {
+private:
+    std::vector<LootEntry> drops;
+    AliasTable table; // outcome 0 is no drop, outcome i is drops[i - 1]
+
+public:
+    /**
+     * LootTable(): builds a loot table.
+     * args: entries (the possible drops), nothingWeight (the weight of dropping nothing at all, on the same scale as the entries)
+     * */
+    LootTable(const std::vector<LootEntry>& entries, double nothingWeight){
+        std::vector<double> weights;
+        weights.push_back(nothingWeight);
+        for (const LootEntry& entry : entries){
+            double weight = entry.weight * RARITY_WEIGHT[entry.rarity];
+            if (weight <= 0) continue;
+            drops.push_back(entry);
+            weights.push_back(weight);
+        }
+        table = AliasTable(weights);
+    }
+
+    /**
+     * roll(): rolls for a drop on the combat generator, since drops are rolled as enemies fall.
+     * args: none
+     * outputs: the ID of the dropped item, or 0 if nothing dropped
+     * */
+    unsigned roll() const {
+        unsigned outcome = table.sample(combatDice());
+        return outcome == 0 ? 0 : drops[outcome - 1].itemID;
+    }
+
+    /** Returns the number of different items this table can drop. */
+    unsigned dropCount() const {
+        return drops.size();
+    }
+
+    /** Returns the (index)th item this table can drop, starting at 0. */
+    const LootEntry& dropAt(unsigned index) const {
+        return drops[index];
+    }
+};
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef __ODDITY_EVENTS_H__
+#define __ODDITY_EVENTS_H__
+
+#include "./Event.hpp"
+
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+/**
+ * The content pack for the oddity rooms that ship with the game, in the format described in Event.hpp.
+ * */
+const char* const ODDITY_EVENT_PACK = R"PACK(
+# ID 30001
+event 30001 A room with a marble statue
+node start
+say You're in a damp stone room illuminated by torches. There's a small marble statue in the shape of an angel with gold engravings sitting on a pedestal in the center of the room.
+choice 1 touch Touch the statue
+choice 2 smash Break the statue
+node touch
+say You rub the statue. You feel a surge of magical energy flow through your fingertips and into your body. You feel reinvigorated.
+heal 1000
+node smash
+gold 100 299
+say You raise your weapon and smash the statue. Turns out it was full of gold coins! You scoop them all up, adding {amount} gold to your funds.
+
+# ID 30002
+event 30002 An empty stone room
+node start
+say You enter an empty room with stone walls. Vines are obscuring what look like carvings on the walls. As you walk forwards into the center of the room, you hear a click under your feet as darts suddenly fly out from hidden openings in the wall.
+goto dodge if speed > 100
+goto hit
+node dodge
+say However, you're quick on your feet, and jump out of the way before they can hit you.
+node hit
+pdamage 30
+say You make an attempt to jump out of the way, but you're not fast enough. You dodge most of them but some of them still connect, causing painful wounds. You take {amount} physical damage.
+
+# ID 30003
+event 30003 strange door with cat ears
+node start
+say The entrance to this room is blocked by a round wooden door. You push it open, revealing a cozy interior. The floor is padded with a soft carpet. One side of the room has a cozy brick fireplace, its coals glowing softly. Next to it is a small arrangement of pillows and blankets. A small black cat sits on it. As you enter the room, it turns to face you with its gleaming yellow eyes.
+say HUMAN, an uncharacteristically deep voice resonates directly within your mind, presumably coming from the cat. \nWHAT BRINGS YOU HERE?
+choice 1 talk "You can talk?"
+node talk
+say OF COURSE I CAN. DON'T TELL ME YOU'VE NEVER SEEN A TALKING CAT?
+choice 1 greatness "Uhh..."
+node greatness
+say I KNOW, I CAN TELL YOU'RE TAKEN ABACK BY MY GREATNESS. IT'S NOT EVERY DAY THAT I, THE GREAT MORT, LORD OF THE DARK NIGHT, SLAYER OF THE FOULEST OF VERMIN, WIELDER OF THE ETERNAL BLACK FLAME, DECIDES TO BESTOW HIS PRESENCE UPON MERE MORTALS!
+choice 1 wish "Okay... What do you want?"
+choice 2 wish "Get to the point."
+choice 3 mock "What did you say your name was? *pfft* M-mort?"
+node mock
+say If cats could make expressions, Mort would probably be fuming right now. You can feel his embarrassment through your telepathic link. \nCEASE YOUR USELESS CHATTER. I DO NOT RECOGNIZE THIS LABEL. YOU AGREE, DO YOU NOT? WHAT KIND OF DARK LORD IS CALLED "MORT"? ALL THE TOWNSFOLK COWER IN TERROR WHEN THEY HEAR EVEN WHISPERS OF MY PRESENCE. I AM FEARED BY EVERY KIND OF BEING ACROSS THE LAND. MY DARK POWER IS LIMITLESS, LIKE THE BLACKEST OF MIDNIGHT. I COULD CRUSH YOUR PUNY HUMAN BODY IN AN INSTANT. AND YET I AM STUCK WITH THIS ACCURSED HUMAN LABEL, THAT OF WHICH I DID NOT ASK FOR. CURSE THAT OLD HAG AND HER AWFUL NAMING SENSE. I WILL GET HER BACK ONE DAY. BUT FOR NOW, I WILL NOT HAVE YOU, A MERE HUMAN, TAUNTING ME.
+choice 1 wish Try to hold back your laughter. "Okay, I'm sorry. What do you want from me?"
+choice 2 snicker Snicker. "Mort."
+node snicker
+say Mort's hair prickles a bit. \nYOU ARE PLAYING WITH FIRE, HUMAN. ETERNAL BLACK FIRE, TO BE EXACT. BE CAREFUL YOU DO NOT GET BURNED.
+choice 1 wish "Okay, I'm sorry. What do you want from me?"
+choice 2 whisper Under your breath, whisper again "Mort. Can you believe it?"
+node whisper
+say LAST WARNING, HUMAN. IT WAS FUNNY EARLIER. NOW IT'S NOT.
+choice 1 wish "Okay, I'm sorry. What do you want from me?"
+choice 2 laugh Stop holding it in.
+node laugh
+say Unable to hold it in any longer, you burst out laughing. It's just too funny. A self-proclaimed dark lord, wielder of the whatever whatever, but he's stuck with a name as dumb as MORT? It's almost too comedic.
+say Mort gets up from his bed. He stretches his back and a golden aura flares up around him. \nPREPARE YOURSELF, HUMAN.
+say You're almost too busy laughing to ready your weapon.
+goto fight
+node fight
+say NAME                    00%-----25%------50%------75%-----100%
+say                         [        |        |        |        ]
+say {name16} (100%) [----------------------------------o] ({health}/{maxhealth})
+say Mort             (100%) [--------------------------=^ owo ^=] (????/????)
+say ================================[TURN 1]===============================
+say It's your turn. Available options:
+choice 1 flail Flail helplessly
+choice 2 pray Pray to Jesus
+choice 3 flop Flop around on the floor like a fish
+choice 4 flee Flee
+node flail
+say You start wildly flapping your arms around. It doesn't seem to have much of an effect. In your flailing, you trip on the pillows on the floor and land face-first on the carpet.
+goto doom
+node pray
+say You get down on your knees, clasp your hands together and pray that somebody, anybody up there might help you. But nobody came...
+goto doom
+node flop
+say You lay down on your stomach and start flopping on the floor. It's oddly comfy because of the carpet. You flop for a bit before you eventually get tired. Your flopping doesn't seem to have any effect.
+goto doom
+node flee
+say You sprint out the door in the back and slam it behind you. That was close. You weren't expecting him to be that powerful.
+say You find yourself in a small passageway. You can see a faint light coming from a room in front of you.
+say Available exits:
+choice 1 dragged Forward
+node dragged
+say WHERE DO YOU THINK YOU'RE GOING?
+say A tendril made of golden light wraps around you and forcibly drags you back into the room, where you find a very angry-looking Mort standing over you.
+goto doom
+node doom
+say You look up at Mort. "Hey."
+say ANY LAST WORDS?
+say Mort doesn't even give you time to speak before the golden aura around him flares up, illuminating the room around you in bright yellow light. Golden rays shoot out from Mort's small frame, piercing your body. Each of them shocks your nerves with searing, white-hot lances of pain. You can only stay conscious for a couple of seconds before passing out.
+say You wake up what seems like an eternity later. The fireplace has long burnt out, and Mort is nowhere to be seen. Your head is pounding. You stretch your aching limbs, rolling over onto something solid? You reach out your hand to grab it. It's a... golden severed cat paw? Perplexed, you pocket the cat's paw and proceed onward.
+sethealth 1
+item 20012
+node wish
+say Mort straightens up a little. \nI COME BEARING GIFTS, HUMAN. FROM THE OLD HAG HERSELF. STATE YOUR WISH.
+choice 1 power Power.
+choice 2 wealth Wealth.
+choice 3 wisdom Wisdom.
+node power
+say CONSIDER IT DONE. The cat gets up, stretches a little, then stares intensely at the spot in front of your feet. A flash of light, a bit of smoke, and a red cat's paw materializes in front of you.
+say YOU ARE WELCOME, HUMAN. SQUASH SOME VERMIN FOR ME.
+item 20010
+goto vanish
+node wealth
+gold 50 649
+say CONSIDER IT DONE. The cat gets up, stretches a little, then stares intensely at the spot in front of your feet. A flash of light, a bit of smoke, and a pile of gold materializes in front of you.
+say YOU ARE WELCOME, HUMAN. DON'T SPEND IT ALL IN ONE PLACE.
+say You gained {amount} gold.
+goto vanish
+node wisdom
+say CONSIDER IT DONE. The cat gets up, stretches a little, then stares intensely at the spot in front of your feet. A flash of light, a bit of smoke, and a blue cat's paw materializes in front of you.
+say YOU ARE WELCOME, HUMAN. EXPAND YOUR BRAIN POWER BEYOND THE HORIZONS.
+item 20011
+goto vanish
+node vanish
+say Mort abruptly disappears in a puff of smoke. You can still faintly sense his presence, but it seems like he's had his fun for the day. Still a bit perplexed, you head towards the exit.
+
+# ID 30004
+event 30004 A hallway of mirrors
+node start
+say \nYou step into a hallway full of mirrors.
+say Many of them are cracked; some are broken entirely, piles of shards in their frames.
+say You come to a stop in front of an intact mirror, face to face with your reflection.\n
+choice 1 appearance Check your appearance
+choice 2 challenge Play Rock-Paper-Scissors
+choice 3 smash Break the mirror
+choice 0 ignore Ignore the mirror and carry on
+node ignore
+say \nYou're pretty familiar with yourself, having been you for many years.
+say A mirror is nothing to be surprised about. You turn away and carry on.
+node appearance
+say \nYou check your current state, fuss with your hair, dust off your clothes.
+say After a few minutes, you conclude that you're probably the hottest thing in this place.
+say Well... maybe except for a monster made of fire or something.
+say You finger-gun your reflection and walk away, feeling much more confident.
+node smash
+say \nYou know better than to trust anything in this place, least of all yourself.
+say You spin your trusty weapon into your hand and thrust it into the mirror, dealing {patk} physical damage.
+say With a deafening crash, the mirror splinters into tiny shards.
+goto spirit if matk > 100
+goto panic
+node spirit
+say \nAn eerie sense of dread makes your nerves stand on end and tingles your spine.
+say Being familiar with magic, you know whatever spirit lived in that mirror perished with it.
+node panic
+say \nFear suddenly sets in as you begin to doubt your actions.
+say You fall to your knees and crawl away from the broken mirror, but this leads you to another-\nYou crawl away from that one, but this leads you to yet another.
+say The panic sends you scampering across hundreds of tiny glass shards in a madness.\nWhen you regain your composure, you are left with many tiny bleeding cuts and a splitting headache.
+pdamage 20
+mdamage 20
+
+# every throw is a tie, until the thirteenth
+node challenge
+say \nYou bring your hand up, challenging your reflection in a classic showdown of ro-sham-bo.
+goto match
+node match
+say You stare intently at your reflection, preparing your next move.\n
+choice 1 rock Rock
+choice 2 paper Paper
+choice 3 scissors Scissors
+choice 0 quit This is stupid, give up and leave.
+node quit
+say \nYou can't believe you were really playing rock paper scissors with your reflection.
+say With an ashamed chuckle at your own stupidity, you turn away and carry on.
+node rock
+add rounds 1
+goto rockWin if rounds >= 13
+goto rockTie
+node rockTie
+say \nYou make up your mind.\nOne...\tTwo...\tThree!!!\nYou threw Rock. Your reflection threw Rock.\n\tIt's a tie!\n
+goto match
+node paper
+add rounds 1
+goto paperWin if rounds >= 13
+goto paperTie
+node paperTie
+say \nYou make up your mind.\nOne...\tTwo...\tThree!!!\nYou threw Paper. Your reflection threw Paper.\n\tIt's a tie!\n
+goto match
+node scissors
+add rounds 1
+goto scissorsWin if rounds >= 13
+goto scissorsTie
+node scissorsTie
+say \nYou make up your mind.\nOne...\tTwo...\tThree!!!\nYou threw Scissors. Your reflection threw Scissors.\n\tIt's a tie!\n
+goto match
+node rockWin
+say \nYou make up your mind.\nOne...\tTwo...\tThree!!!\nYou threw Rock. Your reflection threw Scissors.\n\tYou... won?\n
+choice 1 rockStare "What..."
+node rockStare
+say \nYou stare in shock at your reflection, then back at your own hand.\nYou hold Rock, and your reflection holds Scissors.
+goto stunned
+node paperWin
+say \nYou make up your mind.\nOne...\tTwo...\tThree!!!\nYou threw Paper. Your reflection threw Rock.\n\tYou... won?\n
+choice 1 paperStare "What..."
+node paperStare
+say \nYou stare in shock at your reflection, then back at your own hand.\nYou hold Paper, and your reflection holds Rock.
+goto stunned
+node scissorsWin
+say \nYou make up your mind.\nOne...\tTwo...\tThree!!!\nYou threw Scissors. Your reflection threw Paper.\n\tYou... won?\n
+choice 1 scissorsStare "What..."
+node scissorsStare
+say \nYou stare in shock at your reflection, then back at your own hand.\nYou hold Scissors, and your reflection holds Paper.
+goto stunned
+node stunned
+say Your reflection looks equally stunned! Their eyes meet yours.\n
+choice 1 press Press your hand to the mirror.
+choice 2 runAway Run away and try to forget this ever happened.
+node press
+say \nYou uncurl your hand and gently bring it to the mirror.
+say Your reflection does the same, and you watch each other intently.
+say You expect the mirror to be cold, but it is... warm, and... soft?
+say \t...Like your hand.\n
+choice 1 clasp Try to clasp your reflection's hand.
+choice 2 runAway This is terrifying. Leave immediately.
+node clasp
+say \nYou slowly close your fingers, preparing for the most existential hand holding you've ever seen.
+say ...but your fingers slide hopelessly against the mirror.
+say Your reflection seems disappointed for a moment...
+say But then their eyes go wide!
+say They give an excited grin. You forget to wonder if you're grinning back.
+say Your reflection holds up something shimmery, and slips it into their pocket.
+say You feel your own pocket get heavier.\n
+say Your reflection holds their hands up in a heart, and waves goodbye.
+say The mirror shatters.\n
+item 20013
+node runAway
+say \nThat's enough existential crisis for today.
+say You turn and break into a sprint out of the hallway, never looking back.
+)PACK";
+
+/**
+ * oddityEvents(): the oddity events that ship with the game, compiled the first time they're asked for.
+ * args: none
+ * outputs: the pack
+ * */
+inline const EventPack& oddityEvents() {
+    static const EventPack pack = []() {
+        EventPack compiled;
+        std::istringstream in(ODDITY_EVENT_PACK);
+        std::string error;
+        if (!compiled.parse(in, error)) {
+            std::cout << "There was an error in the oddity event pack, " << error << "\n";
+            exit(1);
+        }
+        return compiled;
+    }();
+    return pack;
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef __PROGRESSION_H__
+#define __PROGRESSION_H__
+
+#include <algorithm>
+#include <vector>
+
+// nobody levels past this. experience still accumulates, it just doesn't go anywhere
+const int LEVEL_CAP = 100;
+
+/**
+ * StatGrowth: how much each stat goes up by per level. Every class has its own.
+ * */
+struct StatGrowth {
+    int hp, pAtk, pDef, mAtk, mDef, spd;
+};
+
+/**
+ * xpCurve(): the experience needed to go from a level to the next one, 75 * 1.1^level.
+ * Works out at compile time, so use the XpTable below rather than calling this at runtime.
+ * args: level (the current level)
+ * outputs: the experience threshold
+ * */
+constexpr double xpCurve(int level){
+    return level <= 0 ? 75.0 : 1.1 * xpCurve(level - 1);
+}
+
+/**
+ * xpCost(): the experience that actually gets used up when leveling from a level to the next.
+ * You have to have more than xpCurve(level) experience to level, and experience is stored as a whole number,
+ * so this comes out to one more than the threshold rounded down.
+ * */
+constexpr long long xpCost(int level){
+    return (long long)xpCurve(level) + 1;
+}
+
+/**xpTotal(): the total experience used up going from level 1 to a given level.*/
+constexpr long long xpTotal(int level){
+    return level <= 1 ? 0 : xpTotal(level - 1) + xpCost(level - 1);
+}
+
+// builds the list 0, 1, ..., N - 1 so the table below can be filled in at compile time
+template <int... Levels> struct LevelList {};
+template <int N, int... Levels> struct MakeLevelList : MakeLevelList<N - 1, N - 1, Levels...> {};
+template <int... Levels> struct MakeLevelList<0, Levels...> { typedef LevelList<Levels...> type; };
+
+template <typename List> struct XpTableOf;
+template <int... Levels> struct XpTableOf<LevelList<Levels...> > {
+    static constexpr double threshold[sizeof...(Levels)] = { xpCurve(Levels)... };
+    static constexpr long long total[sizeof...(Levels)] = { xpTotal(Levels)... };
+};
+template <int... Levels> constexpr double XpTableOf<LevelList<Levels...> >::threshold[sizeof...(Levels)];
+template <int... Levels> constexpr long long XpTableOf<LevelList<Levels...> >::total[sizeof...(Levels)];
+
+// XpTable::threshold[level] and XpTable::total[level] for every level up to the cap
+typedef XpTableOf<MakeLevelList<LEVEL_CAP + 1>::type> XpTable;
+
+/**
+ * levelsAffordable(): works out how many levels a character can gain from their current experience in one go.
+ * args: level (the current level), experience (the experience the character has right now)
+ * outputs: the number of levels gained. spent is set to the experience that gets used up
+ * */
+inline int levelsAffordable(int level, long long experience, long long& spent){
+    spent = 0;
+    if (level >= LEVEL_CAP || level < 1) return 0;
+    const long long* first = XpTable::total + level;
+    const long long* last = XpTable::total + LEVEL_CAP + 1;
+    const long long* reached = std::upper_bound(first, last, XpTable::total[level] + experience) - 1;
+    spent = *reached - XpTable::total[level];
+    return reached - first;
+}
+
+#endif
@@ -0,0 +1,242 @@
+#ifndef __QUEST_BOARD_H__
+#define __QUEST_BOARD_H__
+
+#include "./../source/Quest.cpp"
+#include "./Factory.hpp"
+#include "./Biome.hpp"
+#include "./Simulation.hpp"
+#include "./Dice.hpp"
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+
+// the enemies that can be put up as bosses on the board, by factory ID
+const unsigned BOARD_FIRST_BOSS = 10001, BOARD_BOSS_KINDS = 5;
+const char* const BOARD_TASKS[] = {"Defeat a dangerous ", "Eliminate an evil ", "Hunt down a notorious ", "Put an end to a vicious "};
+
+/**
+ * BossProfile: what the board knows about a kind of boss without making one.
+ * */
+struct BossProfile {
+    std::string name;
+    int maxHealth, pAtk, mAtk, speed;
+};
+
+/**
+ * bossProfile(): looks up a boss kind. Each kind is built once, the first time it is asked for, and remembered after that.
+ * They're built from a fixed spawnDice() seed, so a board only depends on its own seed whichever thread sizes the bosses up.
+ * args: id (the enemy's factory ID)
+ * outputs: the profile
+ * */
+inline const BossProfile& bossProfile(unsigned id) {
+    static const std::vector<BossProfile> profiles = []() {
+        EnemyFactory enemies;
+        std::vector<BossProfile> built;
+        std::minstd_rand kept = spawnDice();
+        spawnDice().seed(BOARD_FIRST_BOSS);
+        for (unsigned i = 0; i < BOARD_BOSS_KINDS; ++i) {
+            Enemy* e = enemies.generate(BOARD_FIRST_BOSS + i);
+            built.push_back(BossProfile{e->getName(), e->getMaxHealth(), e->getPAtk(), e->getMAtk(), e->getSpeed()});
+            delete e;
+        }
+        spawnDice() = kept;
+        return built;
+    }();
+    return profiles[id - BOARD_FIRST_BOSS];
+}
+
+/**
+ * questRisk(): a rough guess of how dangerous a quest is, about the number of enemies the player will have to get through,
+ * with the boss counted by how much damage it can take and deal compared to a plain Skeleton.
+ * args: boss (the boss), layout (the biome's layout)
+ * outputs: the estimate
+ * */
+inline double questRisk(const BossProfile& boss, const QuestLayout& layout) {
+    double fights = layout.dungeon.arenas + layout.dungeon.lockedAreas;
+    double perFight = (layout.arenaMin + layout.arenaMax) / 2.0;
+    double allies = (layout.bossAlliesMin + layout.bossAlliesMax) / 2.0;
+    double bossPower = boss.maxHealth * (double)(boss.pAtk + boss.mAtk) * boss.speed / (150.0 * 22.0 * 75.0);
+    return fights * perFight + allies + 4.0 * bossPower;
+}
+
+/**
+ * calibratedReward(): scales a posted reward by how a quest went when it was played out for a hero. A quest the hero walks
+ * through without a scratch pays half, one that is sure to kill them pays two and a half times as much.
+ * args: posted (the reward the quest was posted with), estimate (how the quest went), maxHealth (the hero's maximum health)
+ * outputs: the reward
+ * */
+inline unsigned calibratedReward(unsigned posted, const QuestEstimate& estimate, int maxHealth) {
+    double danger = (1 - estimate.winChance()) + std::min(1.0, estimate.averageHpLost() / std::max(1, maxHealth));
+    return posted * (0.5 + danger) + 0.5;
+}
+
+/**
+ * QuestStub: a quest as it appears on the board. It is only a description plus a seed, the Quest itself gets built
+ * when the stub is accepted.
+ * */
+struct QuestStub {
+    unsigned int reward; //what the quest pays, see QuestBoard::calibrate()
+    unsigned int postedReward; //what the quest paid before anyone sized it up
+    unsigned boss; //the boss's factory ID
+    std::string task;
+    unsigned biome; //index into biomeCatalog()
+    unsigned seed; //the seed the quest is built from
+    double risk; //see questRisk()
+    QuestEstimate estimate; //no runs until the board has been calibrated
+    size_t calibratedFor = 0; //the build (see QuestEstimator::buildHash()) the reward was calibrated for, 0 if it hasn't been
+
+    double rewardPerRisk() const {
+        return reward / risk;
+    }
+};
+
+enum QuestSort {SORT_POSTED, SORT_RISK, SORT_REWARD_PER_RISK};
+
+/**
+ * QuestBoard: every quest on offer in a town. Posting a quest only rolls its stub, so a large board is cheap.
+ * The board keeps its quests indexed by risk and by reward per risk (both sorted once when the board is made) and
+ * by boss kind, so sorted and filtered views don't need to sort anything.
+ * */
+class QuestBoard {
+private:
+    std::vector<QuestStub> stubs;
+    std::vector<unsigned> byRisk, byValue; // positions in stubs, easiest and best paying first
+    std::unordered_map<unsigned, std::vector<unsigned> > byBoss; // boss ID -> positions in stubs, in posted order
+
+    void sortByValue() {
+        byValue.clear();
+        for (unsigned i = 0; i < stubs.size(); ++i) byValue.push_back(i);
+        std::stable_sort(byValue.begin(), byValue.end(), [this](unsigned a, unsigned b) { return stubs[a].rewardPerRisk() > stubs[b].rewardPerRisk(); });
+    }
+
+    std::vector<unsigned> posted() const {
+        std::vector<unsigned> all(stubs.size());
+        for (unsigned i = 0; i < all.size(); ++i) all[i] = i;
+        return all;
+    }
+
+public:
+    QuestBoard() = default;
+
+    /**
+     * QuestBoard(): posts a number of quests.
+     * args: size (how many quests), rng (where the rolls come from)
+     * */
+    QuestBoard(unsigned size, std::mt19937& rng) {
+        stubs.reserve(size);
+        for (unsigned i = 0; i < size; ++i) {
+            QuestStub stub;
+            stub.boss = BOARD_FIRST_BOSS + rng() % BOARD_BOSS_KINDS;
+            stub.task = BOARD_TASKS[rng() % (sizeof(BOARD_TASKS) / sizeof(BOARD_TASKS[0]))];
+            stub.biome = rng() % biomeCatalog().size();
+            stub.seed = rng();
+            stub.risk = questRisk(bossProfile(stub.boss), biomeCatalog()[stub.biome].layout);
+            //7 to 10 gold for every point of risk, kept within the 50 to 150 gold quests have always paid
+            stub.reward = std::max(50.0, std::min(150.0, stub.risk * (7.0 + (rng() % 300) / 100.0)));
+            stub.postedReward = stub.reward;
+            stubs.push_back(stub);
+            byBoss[stub.boss].push_back(i);
+        }
+        for (unsigned i = 0; i < size; ++i) byRisk.push_back(i);
+        std::stable_sort(byRisk.begin(), byRisk.end(), [this](unsigned a, unsigned b) { return stubs[a].risk < stubs[b].risk; });
+        sortByValue();
+    }
+
+    unsigned size() const {
+        return stubs.size();
+    }
+
+    const QuestStub& at(unsigned position) const {
+        return stubs[position];
+    }
+
+    /**
+     * view(): lists the board's quests in some order, optionally only the ones with a certain kind of boss.
+     * args: sort (the order), boss (the boss's factory ID, or 0 for every quest)
+     * outputs: positions on the board
+     * */
+    std::vector<unsigned> view(QuestSort sort, unsigned boss = 0) const {
+        if (sort == SORT_POSTED) {
+            if (boss == 0) return posted();
+            std::unordered_map<unsigned, std::vector<unsigned> >::const_iterator it = byBoss.find(boss);
+            return it == byBoss.end() ? std::vector<unsigned>() : it->second;
+        }
+        const std::vector<unsigned>& index = sort == SORT_RISK ? byRisk : byValue;
+        if (boss == 0) return index;
+        std::vector<unsigned> matching;
+        for (unsigned position : index) {
+            if (stubs[position].boss == boss) matching.push_back(position);
+        }
+        return matching;
+    }
+
+    /**
+     * page(): cuts one page out of a view.
+     * args: view (from view()), page (which page, starting at 0), pageSize (how many quests on a page)
+     * outputs: the quests on that page. Empty if the page is past the end
+     * */
+    static std::vector<unsigned> page(const std::vector<unsigned>& view, unsigned page, unsigned pageSize) {
+        unsigned first = std::min<unsigned>(page * pageSize, view.size());
+        unsigned last = std::min<unsigned>(first + pageSize, view.size());
+        return std::vector<unsigned>(view.begin() + first, view.begin() + last);
+    }
+
+    /** Returns how many pages a view takes up, at least 1. */
+    static unsigned pageCount(const std::vector<unsigned>& view, unsigned pageSize) {
+        return std::max<unsigned>(1, (view.size() + pageSize - 1) / pageSize);
+    }
+
+    /**
+     * calibrate(): sizes some of the board's quests up for a hero by playing them out with their current build at full health
+     * (see QuestEstimator), then sets each reward from how that went. Only the quests asked for get built, usually the ones
+     * on screen, and a quest already calibrated for the same build is left as it is, so looking at the board again costs nothing.
+     * Quests that didn't get any runs in time keep their posted reward, and ones that didn't get all of them get another go
+     * next time, building on the runs they already had.
+     * args: hero (who is looking at the board), positions (the quests to size up), budget (how long they may take together)
+     * outputs: none
+     * */
+    void calibrate(Adventurer* hero, const std::vector<unsigned>& positions,
+                   std::chrono::milliseconds budget = std::chrono::milliseconds(SIM_BUDGET_MS)) {
+        size_t build = QuestEstimator::buildHash(*hero);
+        std::vector<unsigned> pending;
+        std::vector<QuestPlan> plans;
+        for (unsigned position : positions) {
+            if (stubs[position].calibratedFor == build) continue;
+            Quest* quest = accept(position, hero->getLevel());
+            plans.push_back(quest->encounters());
+            pending.push_back(position);
+            delete quest;
+        }
+        if (pending.empty()) return;
+
+        std::vector<QuestEstimate> estimates = questEstimator().estimate(*hero, plans, budget);
+        for (unsigned i = 0; i < pending.size(); ++i) {
+            QuestStub& stub = stubs[pending[i]];
+            stub.estimate = estimates[i];
+            stub.reward = estimates[i].runs > 0 ? calibratedReward(stub.postedReward, estimates[i], hero->getMaxHealth()) : stub.postedReward;
+            stub.calibratedFor = estimates[i].runs >= SIM_RUNS_PER_QUEST ? build : 0;
+        }
+        sortByValue();
+    }
+
+    /**
+     * accept(): builds the quest for a stub. This is the only time a quest's boss and dungeon are made.
+     * args: position (the quest on the board), level (the level of the player taking it)
+     * outputs: the quest. The caller owns it
+     * */
+    Quest* accept(unsigned position, int level) const {
+        return accept(position, level, stubs[position].reward);
+    }
+
+    /** This is a version of the above that pays a given reward instead, e.g. the one the quest had when a save was made. */
+    Quest* accept(unsigned position, int level, unsigned reward) const {
+        const QuestStub& stub = stubs[position];
+        EnemyFactory enemies;
+        return new Quest(reward, enemies.generate(stub.boss), stub.task, biomeCatalog()[stub.biome], level, stub.seed);
+    }
+};
+
+#endif
@@ -3,19 +3,29 @@
 
 #include <iostream>
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include "./Entity.hpp"
 #include "./Adventurer.hpp"
 
+// the largest party that can be linked into a room at once
+const unsigned MAX_PARTY_SIZE = 8;
+
 class Room{
 protected:
     std::string name;
     std::string description;
     int weight;
-    std::vector<Room*> exits;
+    std::vector<Room*> exits; // an exit's id is its position in here
     std::vector<std::string> exitLabels;
-    Adventurer* player;
+    std::unordered_map<std::string, unsigned> exitIndex; // label -> exit id
+    Adventurer* player = nullptr; // the party leader. rooms built around a single adventurer only deal with this one
+    std::vector<Adventurer*> party;
     bool end = false;
 public:
+    // returned by exitId() when no exit has the label
+    static const unsigned NO_EXIT = ~0u;
+
     virtual ~Room() = default;
 
     /**
@@ -45,6 +55,18 @@ public:
      * */
     void linkPlayer(Adventurer* player){
         this->player = player;
+        party.assign(1, player);
+    }
+
+    /**
+     * linkParty: links a whole party to this room. The first member is treated as the party leader.
+     * Anyone past MAX_PARTY_SIZE is left out.
+     * args: members (pointers to the party's adventurers)
+     * outputs: none
+     * */
+    void linkParty(const std::vector<Adventurer*>& members){
+        party.assign(members.begin(), members.begin() + std::min<size_t>(members.size(), MAX_PARTY_SIZE));
+        player = party.empty() ? nullptr : party.front();
     }
 
     /**
@@ -53,7 +75,7 @@ public:
      * args: none
      * outputs: a std::string containing the name
      * */
-    std::string getName(){
+    virtual std::string getName(){
         return name;
     }
 
@@ -89,8 +111,7 @@ public:
      * outputs: none
      * */
     void addExit(Room* r){
-        exits.push_back(r);
-        exitLabels.push_back(std::to_string(exits.size()));
+        addExit(r, std::to_string(exits.size() + 1));
     }
 
     /**
@@ -99,32 +120,60 @@ public:
      * outputs: none
      * */
     void addExit(Room* r, std::string l){
+        exitIndex.emplace(l, exits.size()); // if a label is used twice, the first exit keeps it
         exits.push_back(r);
         exitLabels.push_back(l);
     }
 
     /**
-     * getExit: takes in an input label. Returns the matching room if one exists, prints an error if otherwise
+     * addExitLabel: adds an exit that only has a label and an id, for rooms whose neighbours aren't built yet.
+     * Quests use this and work out where the exit leads from its id themselves (see Quest::exitTo()). getExit() gives nullptr for it.
+     * args: l (the label for the exit)
+     * outputs: none
+     * */
+    void addExitLabel(const std::string& l){
+        addExit(nullptr, l);
+    }
+
+    /**
+     * exitId: takes in an input label and looks up the id of the matching exit. Takes constant time no matter how many exits there are.
+     * args: input (the label for the exit we want to search for)
+     * outputs: the exit's id, or NO_EXIT if nothing is found
+     * */
+    unsigned exitId(const std::string& input) const {
+        std::unordered_map<std::string, unsigned>::const_iterator it = exitIndex.find(input);
+        return it == exitIndex.end() ? NO_EXIT : it->second;
+    }
+
+    /**
+     * getExit: takes in an input label and looks up the matching room, see exitId().
      * args: input (the label for the room we want to search for)
      * outputs: the desired room. Returns nullptr if nothing is found
      * */
-    Room& getExit(std::string input){
-        for (int i = 0; i < exitLabels.size(); ++i){
-            if (exitLabels[i] == input) return *exits[i];
-        }
-        std::cout << "Invalid exit. Please try again.\n"; //theoretically you should never reach this
-        //return NULL;
+    Room* getExit(const std::string& input) const {
+        unsigned id = exitId(input);
+        return id == NO_EXIT ? nullptr : exits[id];
     }
 
     /**
      * This is an integer version of the above getExit. 
      * */
-    Room& getExit(int input){
-        for (int i = 0; i < exitLabels.size(); ++i){
-            if (std::stoi(exitLabels[i]) == input) return *exits[i];
-        }
-        std::cout << "Invalid exit. Please try again.\n";
-        //return NULL;
+    Room* getExit(int input) const {
+        return getExit(std::to_string(input));
+    }
+
+    /**
+     * getExitById: gets an exit by its id, which is the order it was added in starting at 0.
+     * args: id (the exit's id)
+     * outputs: the room, or nullptr if there is no such exit
+     * */
+    Room* getExitById(unsigned id) const {
+        return id < exits.size() ? exits[id] : nullptr;
+    }
+
+    /** Returns the number of exits this room has. */
+    unsigned exitCount() const {
+        return exits.size();
     }
 
     /**
@@ -132,28 +181,30 @@ public:
      * args: none
      * outputs: none
      * */
-    void printDescription(){
+    virtual void printDescription(){
         std::cout << description << "\n";
     }
 
     /**
      * printExits: this method prints out all available exits and their names.
+     * Exits added with addExitLabel() have no room to name, so only their label is printed.
      * args: none
      * outputs: none
      * */
     void printExits(){
         std::cout << "Available exits: \n";
         for (int i = 0; i < exits.size(); ++i){
-            std::cout << exitLabels[i] << ":\t" << exits[i]->getName() << "\n";
+            if (exits[i] == nullptr) std::cout << exitLabels[i] << "\n";
+            else std::cout << exitLabels[i] << ":\t" << exits[i]->getName() << "\n";
         }
     }
 
     /**
      * getExitLabels: this method returns a vector containing all the exit labels. 
      * args: none
-     * outputs: a std::vector<string> with all exit labels
+     * outputs: a reference to the std::vector<string> with all exit labels, in exit id order
      * */
-    std::vector<std::string> getExitLabels(){
+    const std::vector<std::string>& getExitLabels() const {
         return exitLabels;
     }
 
@@ -174,4 +225,6 @@ public:
     }
 };
 
+const unsigned Room::NO_EXIT;
+
 #endif
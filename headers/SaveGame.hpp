@@ -0,0 +1,399 @@
+#ifndef __SAVE_GAME_H__
+#define __SAVE_GAME_H__
+
+#include "./Adventurer.hpp"
+#include "./Town.hpp"
+#include "./Factory.hpp"
+#include "./../source/Warrior.cpp"
+#include "./../source/Wizard.cpp"
+#include "./../source/Samurai.cpp"
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Save file layout. Everything is a fixed size record of 32 bit fields in the machine's own byte order, so a save can be
+ * used straight out of memory once it is mapped in:
+ *      SaveHeader                  the character, the town and the quest they picked
+ *      SavedSlot[slotCount]        the inventory, one record per slot
+ *      char[nameLength]            the character's name, not null terminated
+ * Fields only ever get added to the end of a record along with a new SAVE_VERSION, and older versions are turned away.
+ * */
+const char SAVE_MAGIC[4] = {'L', 'B', 'D', 'X'};
+const uint32_t SAVE_VERSION = 1;
+const uint32_t SAVE_BYTE_ORDER = 0x01020304; // reads back differently on a machine with the other byte order
+const char* const SAVE_PATH = "lembirdox.sav";
+
+// the classes a character can be, as stored in a save. Same order as the menu in CharacterGeneration()
+enum SavedClass {SAVED_WARRIOR = 1, SAVED_WIZARD = 2, SAVED_SAMURAI = 3};
+
+struct SavedHero {
+    uint32_t heroClass; // a SavedClass
+    int32_t level, experience, gold;
+    int32_t health, maxHealth, physAtk, physDef, magAtk, magDef, speed;
+    int32_t maxHealthBonus, physAtkBonus, physDefBonus, magAtkBonus, magDefBonus, speedBonus;
+    int32_t abilityCD[MAX_ABILITIES];
+    int32_t classState[CLASS_STATE_SIZE];
+};
+
+struct SavedTown {
+    uint32_t seed, boardSize;
+    int32_t picked, pickedLevel; // see Town::restoreQuest()
+    uint32_t pickedReward;
+    uint32_t unused;
+};
+
+/** Returns whether a town record could have been written by the game. Boards are never bigger than Town::BOARD_SIZE. */
+inline bool validTownRecord(const SavedTown& s) {
+    return s.boardSize >= 1 && s.boardSize <= Town::BOARD_SIZE;
+}
+
+struct SavedSlot {
+    uint32_t id, count;
+    int32_t cooldown;
+    uint32_t state; // see Item::saveState()
+};
+
+struct SaveHeader {
+    char magic[4];
+    uint32_t version, byteOrder;
+    uint32_t headerSize, fileSize;
+    uint32_t slotCount, nameLength;
+    uint32_t generation; // which journal belongs to this save, see Autosave
+    uint64_t score;
+    SavedHero hero;
+    SavedTown town;
+};
+
+/**
+ * SaveFile: a save mapped into memory. Nothing is read or copied up front, the getters point straight into the file,
+ * so opening a save takes the same time however big the inventory in it is.
+ * Check valid() before using anything else.
+ * */
+class SaveFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool found = false;
+    std::string problem;
+
+    bool reject(const char* why) {
+        problem = why;
+        return false;
+    }
+
+    bool check() {
+        if (size < sizeof(SaveHeader)) return reject("The save file is too short.");
+        const SaveHeader& h = header();
+        if (memcmp(h.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0) return reject("That isn't a save file.");
+        if (h.byteOrder != SAVE_BYTE_ORDER) return reject("The save file was made on a different kind of machine.");
+        if (h.version != SAVE_VERSION) return reject("The save file is from a different version of the game.");
+        if (h.headerSize != sizeof(SaveHeader) || h.fileSize != size) return reject("The save file is damaged.");
+        if ((size - sizeof(SaveHeader)) / sizeof(SavedSlot) < h.slotCount
+            || size - sizeof(SaveHeader) - h.slotCount * (uint64_t)sizeof(SavedSlot) != h.nameLength) return reject("The save file is damaged.");
+        if (h.hero.heroClass < SAVED_WARRIOR || h.hero.heroClass > SAVED_SAMURAI) return reject("The save file is damaged.");
+        if (!validTownRecord(h.town)) return reject("The save file is damaged.");
+        return true;
+    }
+
+public:
+    /**
+     * SaveFile(): maps a save in and checks that it can be used.
+     * args: path (where the save is)
+     * */
+    explicit SaveFile(const char* path) {
+        int fd = open(path, O_RDONLY);
+        if (fd == -1) {
+            problem = "There is no save file.";
+            return;
+        }
+        found = true;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data = static_cast<const char*>(mapped);
+                size = info.st_size;
+            }
+        }
+        close(fd); // the mapping stays valid on its own
+        if (data == nullptr) problem = "The save file couldn't be read.";
+        else if (!check()) {
+            munmap(const_cast<char*>(data), size);
+            data = nullptr;
+            size = 0;
+        }
+    }
+
+    SaveFile(const SaveFile&) = delete;
+    SaveFile& operator=(const SaveFile&) = delete;
+
+    ~SaveFile() {
+        if (data != nullptr) munmap(const_cast<char*>(data), size);
+    }
+
+    bool valid() const {
+        return data != nullptr;
+    }
+
+    /** Returns whether there was a file there at all, usable or not. */
+    bool exists() const {
+        return found;
+    }
+
+    /** Returns why the save can't be used, if it can't. */
+    const std::string& error() const {
+        return problem;
+    }
+
+    const SaveHeader& header() const {
+        return *reinterpret_cast<const SaveHeader*>(data);
+    }
+
+    const SavedSlot* slots() const {
+        return reinterpret_cast<const SavedSlot*>(data + sizeof(SaveHeader));
+    }
+
+    unsigned slotCount() const {
+        return header().slotCount;
+    }
+
+    /** Returns the character's name. It isn't null terminated, see nameLength(). */
+    const char* name() const {
+        return data + sizeof(SaveHeader) + header().slotCount * sizeof(SavedSlot);
+    }
+
+    unsigned nameLength() const {
+        return header().nameLength;
+    }
+};
+
+/**
+ * SaveGame: writes saves and turns a SaveFile back into a game.
+ * */
+class SaveGame {
+private:
+    static uint32_t classOf(const Adventurer* hero) {
+        if (dynamic_cast<const Warrior*>(hero) != nullptr) return SAVED_WARRIOR;
+        if (dynamic_cast<const Wizard*>(hero) != nullptr) return SAVED_WIZARD;
+        return SAVED_SAMURAI;
+    }
+
+    static bool isItem(unsigned id) {
+        return contentIndex().contains(id) && (contentIndex().get(id).tags & tagSet({TAG_ITEM})) != 0;
+    }
+
+public:
+    /**
+     * write(): saves a game. The save is written next to the old one and then moved over it, so a save that fails halfway
+     * never costs the player their last one.
+     * args: path (where to save), hero (the player), town (the town they are in), score (the score so far),
+     *       generation (the journal that goes with this save, 0 for none)
+     * outputs: true if the save was written
+     * */
+    static bool write(const char* path, const Adventurer* hero, const Town* town, uint64_t score, uint32_t generation = 0) {
+        SaveHeader h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC));
+        h.version = SAVE_VERSION;
+        h.byteOrder = SAVE_BYTE_ORDER;
+        h.headerSize = sizeof(SaveHeader);
+        h.slotCount = hero->inventory.slotCount();
+        h.nameLength = hero->name.size();
+        h.fileSize = sizeof(SaveHeader) + h.slotCount * sizeof(SavedSlot) + h.nameLength;
+        h.score = score;
+
+        h.generation = generation;
+        h.hero = heroRecord(hero);
+        h.town = townRecord(town);
+
+        std::vector<SavedSlot> slots(h.slotCount);
+        for (unsigned i = 0; i < h.slotCount; ++i) {
+            Item* item = hero->inventory.at(i);
+            slots[i] = SavedSlot{item->getID(), hero->inventory.countAt(i), item->getCooldown(), item->saveState()};
+        }
+
+        std::string temp = std::string(path) + ".tmp";
+        FILE* out = fopen(temp.c_str(), "wb");
+        if (out == nullptr) return false;
+        bool written = fwrite(&h, sizeof(h), 1, out) == 1
+                    && fwrite(slots.data(), sizeof(SavedSlot), slots.size(), out) == slots.size()
+                    && fwrite(hero->name.data(), 1, h.nameLength, out) == h.nameLength;
+        written = fclose(out) == 0 && written;
+        if (!written || rename(temp.c_str(), path) != 0) {
+            remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * hero(): builds the saved character, with their whole inventory.
+     * args: save (a valid save)
+     * outputs: the character. The caller owns it
+     * */
+    static Adventurer* hero(const SaveFile& save) {
+        const SavedHero& s = save.header().hero;
+        std::string name(save.name(), save.nameLength());
+        Adventurer* hero;
+        switch (s.heroClass) {
+            case SAVED_WARRIOR: hero = new Warrior(name, "It's you!"); break;
+            case SAVED_WIZARD: hero = new Wizard(name, "It's you!"); break;
+            default: hero = new Samurai(name, "It's you!"); break;
+        }
+        applyHero(hero, s);
+
+        // stats already include what the items give, so the items go straight into the bag rather than through addItem()
+        ItemFactory items;
+        const SavedSlot* slots = save.slots();
+        for (unsigned i = 0; i < save.slotCount(); ++i) {
+            if (!isItem(slots[i].id) || slots[i].count == 0) continue; //not something we can make, skip it rather than crash
+            Item* item = items.generate(slots[i].id);
+            item->loadState(slots[i].state);
+            item->setCooldown(slots[i].cooldown);
+            hero->inventory.restore(item, slots[i].count);
+            hero->itemCooldowns.track(item);
+        }
+        return hero;
+    }
+
+    /** Returns the part of a save that describes a character, leaving out their inventory and name. */
+    static SavedHero heroRecord(const Adventurer* hero) {
+        SavedHero s;
+        memset(&s, 0, sizeof(s));
+        s.heroClass = classOf(hero);
+        s.level = hero->level;
+        s.experience = hero->experience;
+        s.gold = hero->gold;
+        s.health = hero->health;
+        s.maxHealth = hero->maxHealth;
+        s.physAtk = hero->physAtk;
+        s.physDef = hero->physDef;
+        s.magAtk = hero->magAtk;
+        s.magDef = hero->magDef;
+        s.speed = hero->speed;
+        s.maxHealthBonus = hero->maxHealthBonus;
+        s.physAtkBonus = hero->physAtkBonus;
+        s.physDefBonus = hero->physDefBonus;
+        s.magAtkBonus = hero->magAtkBonus;
+        s.magDefBonus = hero->magDefBonus;
+        s.speedBonus = hero->speedBonus;
+        for (int i = 0; i < MAX_ABILITIES; ++i) s.abilityCD[i] = hero->abilityCD[i];
+        int state[CLASS_STATE_SIZE];
+        hero->classState(state);
+        for (int i = 0; i < CLASS_STATE_SIZE; ++i) s.classState[i] = state[i];
+        return s;
+    }
+
+    /**
+     * applyHero(): puts a character's saved stats back. Their class and inventory are left alone.
+     * args: hero (the character), s (what was saved)
+     * outputs: none
+     * */
+    static void applyHero(Adventurer* hero, const SavedHero& s) {
+        hero->level = s.level;
+        hero->experience = s.experience;
+        hero->gold = s.gold;
+        hero->health = s.health;
+        hero->maxHealth = s.maxHealth;
+        hero->physAtk = s.physAtk;
+        hero->physDef = s.physDef;
+        hero->magAtk = s.magAtk;
+        hero->magDef = s.magDef;
+        hero->speed = s.speed;
+        hero->maxHealthBonus = s.maxHealthBonus;
+        hero->physAtkBonus = s.physAtkBonus;
+        hero->physDefBonus = s.physDefBonus;
+        hero->magAtkBonus = s.magAtkBonus;
+        hero->magDefBonus = s.magDefBonus;
+        hero->speedBonus = s.speedBonus;
+        for (int i = 0; i < MAX_ABILITIES; ++i) hero->abilityCD[i] = s.abilityCD[i];
+        hero->setClassState(s.classState);
+    }
+
+    /** Returns the part of a save that describes a town. */
+    static SavedTown townRecord(const Town* town) {
+        SavedTown s;
+        memset(&s, 0, sizeof(s));
+        s.seed = town->getSeed();
+        s.boardSize = town->getBoardSize();
+        s.picked = town->getPicked();
+        s.pickedLevel = town->getPickedLevel();
+        s.pickedReward = town->getPickedReward();
+        return s;
+    }
+
+    /**
+     * countItems(): tallies a character's bag by item and item state. Slots holding the same item in the same state are added up.
+     * args: hero (the character), counts (filled with (ID, state) -> how many)
+     * outputs: none
+     * */
+    static void countItems(const Adventurer* hero, std::map<std::pair<uint32_t, uint32_t>, uint32_t>& counts) {
+        counts.clear();
+        for (unsigned i = 0; i < hero->inventory.slotCount(); ++i) {
+            Item* item = hero->inventory.at(i);
+            counts[std::make_pair(item->getID(), item->saveState())] += hero->inventory.countAt(i);
+        }
+    }
+
+    /**
+     * gainItems(): puts items into a character's bag without touching their stats, the way hero() does.
+     * args: hero (the character), id (the item), state (see Item::saveState()), count (how many)
+     * outputs: false if the ID isn't an item
+     * */
+    static bool gainItems(Adventurer* hero, uint32_t id, uint32_t state, uint32_t count) {
+        if (!isItem(id) || count == 0) return false;
+        ItemFactory items;
+        for (uint32_t n = 0; n < count; ++n) {
+            Item* item = items.generate(id);
+            item->loadState(state);
+            if (item->isConsumable()) hero->inventory.add(item);
+            else hero->inventory.restore(item, 1);
+        }
+        return true;
+    }
+
+    /**
+     * loseItems(): takes items out of a character's bag without touching their stats.
+     * args: hero (the character), id (the item), state (see Item::saveState()), count (how many)
+     * outputs: how many were actually there to take
+     * */
+    static uint32_t loseItems(Adventurer* hero, uint32_t id, uint32_t state, uint32_t count) {
+        uint32_t taken = 0;
+        while (taken < count) {
+            int slot = hero->inventory.find(id, state);
+            if (slot == -1) break;
+            if (hero->inventory.countAt(slot) == 1) hero->itemCooldowns.release(hero->inventory.at(slot));
+            hero->inventory.consume(slot);
+            ++taken;
+        }
+        return taken;
+    }
+
+    /**
+     * town(): builds the saved town, along with the quest the player had picked.
+     * args: save (a valid save)
+     * outputs: the town. The caller owns it
+     * */
+    static Town* town(const SaveFile& save) {
+        return buildTown(save.header().town);
+    }
+
+    /** Builds a town from its record, see townRecord(). The caller owns it. */
+    static Town* buildTown(const SavedTown& s) {
+        Town* town = new Town(s.seed, s.boardSize);
+        if (s.picked != Town::NO_PICK) town->restoreQuest(s.picked, s.pickedLevel, s.pickedReward);
+        return town;
+    }
+};
+
+#endif
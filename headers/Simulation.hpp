@@ -0,0 +1,265 @@
+#ifndef __SIMULATION_H__
+#define __SIMULATION_H__
+
+#include "./Adventurer.hpp"
+#include "./Factory.hpp"
+#include "./Console.hpp"
+#include "./../source/CombatRoom.cpp"
+
+#include <vector>
+#include <typeinfo>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+
+// the enemies of every fight in a quest, in the order they are fought (see Quest::encounters())
+typedef std::vector<std::vector<unsigned> > QuestPlan;
+
+// how long a batch of estimates may take, and how many threads it gets at most
+const unsigned SIM_BUDGET_MS = 20;
+const unsigned SIM_MAX_THREADS = 4;
+// once a quest has been played out this many times its estimate is good enough, the rest of the budget goes to other quests
+const unsigned SIM_RUNS_PER_QUEST = 500;
+// a fight still going after this many turns counts as lost
+const unsigned SIM_TURN_LIMIT = 400;
+// the most estimates remembered before the cache starts over
+const unsigned SIM_CACHE_LIMIT = 4096;
+
+/**
+ * simulateFight(): plays out one fight with nobody at the controls, following the same turn order as CombatRoom::interact().
+ * The hero uses autoTurn(). Nothing gets printed as long as gameOut() is muted.
+ * args: hero (the fighter, changed by the fight), enemies (they get deleted),
+ *       turnsTaken (if given, set to how many turns were taken, by the hero and the enemies together)
+ * outputs: whether the hero won. A fight that runs to SIM_TURN_LIMIT turns is lost
+ * */
+inline bool simulateFight(Adventurer* hero, std::vector<Enemy*> enemies, unsigned* turnsTaken = nullptr){
+    hero->initializeOrigStats();
+    for (auto e : enemies) e->initializeOrigStats();
+
+    unsigned turns = 0;
+    while (hero->isAlive() && !enemies.empty() && turns < SIM_TURN_LIMIT){
+        int ticks = CombatRoom::ticksToFill(hero);
+        for (auto e : enemies){
+            if (e->isAlive()) ticks = CombatRoom::fewerTicks(ticks, CombatRoom::ticksToFill(e));
+        }
+        if (ticks <= 0) ticks = 1;
+        hero->addTurnBar(hero->getSpeed() * ticks);
+        for (auto e : enemies){
+            if (e->isAlive()) e->addTurnBar(e->getSpeed() * ticks);
+        }
+
+        if (hero->getTurnBar() >= MAX_TURN_BAR){
+            hero->autoTurn(enemies);
+            hero->updateBuffs();
+            hero->setTurnBar(hero->getTurnBar() - MAX_TURN_BAR);
+            ++turns;
+            for (std::vector<Enemy*>::iterator it = enemies.begin(); it != enemies.end(); /* nothing */ ){
+                if (!(*it)->isAlive()){
+                    delete *it;
+                    it = enemies.erase(it);
+                }
+                else ++it;
+            }
+        }
+
+        for (auto e : enemies){
+            if (!hero->isAlive()) break;
+            if (e->getTurnBar() >= MAX_TURN_BAR){
+                e->turn(hero);
+                e->updateBuffs();
+                e->setTurnBar(e->getTurnBar() - MAX_TURN_BAR);
+                ++turns;
+            }
+        }
+    }
+
+    bool won = hero->isAlive() && enemies.empty();
+    for (auto e : enemies) delete e;
+    hero->clearBuffs();
+    if (turnsTaken != nullptr) *turnsTaken = turns;
+    return won;
+}
+
+/**
+ * QuestEstimate: what playing a quest out a number of times looked like.
+ * */
+struct QuestEstimate {
+    unsigned runs = 0, wins = 0;
+    double hpLost = 0; // summed over every run. A lost run counts all of the health the hero started with
+
+    double winChance() const {
+        return runs == 0 ? 0 : (double)wins / runs;
+    }
+
+    double averageHpLost() const {
+        return runs == 0 ? 0 : hpLost / runs;
+    }
+
+    void add(const QuestEstimate& other){
+        runs += other.runs;
+        wins += other.wins;
+        hpLost += other.hpLost;
+    }
+};
+
+/**
+ * simulateQuest(): plays out every fight of a quest in a row with a copy of the hero. Health carries over between fights
+ * like it does on a real quest.
+ * args: hero (who is taking the quest, left untouched), plan (the quest's fights), enemies (a factory to make the enemies with)
+ * outputs: a single run's worth of estimate
+ * */
+inline QuestEstimate simulateQuest(const Adventurer& hero, const QuestPlan& plan, EnemyFactory& enemies){
+    Adventurer* copy = hero.clone();
+    int startHealth = copy->getCurrentHealth();
+    bool won = true;
+    for (unsigned f = 0; f < plan.size() && won; ++f){
+        std::vector<Enemy*> fight;
+        for (unsigned id : plan[f]) fight.push_back(enemies.generate(id));
+        won = simulateFight(copy, fight);
+    }
+
+    QuestEstimate run;
+    run.runs = 1;
+    run.wins = won;
+    run.hpLost = won ? startHealth - std::max(0, copy->getCurrentHealth()) : startHealth;
+    delete copy;
+    return run;
+}
+
+/**
+ * QuestEstimator: scores quests for a hero by playing them out many times on a few worker threads, within a time budget.
+ * Estimates are remembered by (build, plan), so looking at the same board again with the same hero costs nothing.
+ * */
+class QuestEstimator {
+private:
+    struct Key {
+        size_t build, plan;
+
+        bool operator==(const Key& other) const {
+            return build == other.build && plan == other.plan;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return key.build * 31 + key.plan;
+        }
+    };
+
+    std::unordered_map<Key, QuestEstimate, KeyHash> cache;
+    std::mutex lock;
+
+    static void mix(size_t& seed, size_t value){
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+public:
+    /**
+     * Returns a hash of everything about a hero's build that matters in a fight: their class, level and stats. Current health
+     * is left out, quests are always played out at full health (see estimate()).
+     * */
+    static size_t buildHash(Adventurer& hero){
+        size_t seed = std::hash<std::string>()(typeid(hero).name());
+        int stats[] = {hero.getLevel(), hero.getMaxHealth(), hero.getPAtk(), hero.getPDef(),
+                       hero.getMAtk(), hero.getMDef(), hero.getSpeed()};
+        for (int stat : stats) mix(seed, std::hash<int>()(stat));
+        for (int i = 0; i < MAX_ABILITIES; ++i) mix(seed, std::hash<int>()(hero.getAbilityCooldown(i)));
+        return seed;
+    }
+
+    /** Returns a hash of a quest's fights. */
+    static size_t planHash(const QuestPlan& plan){
+        size_t seed = plan.size();
+        for (const std::vector<unsigned>& fight : plan){
+            mix(seed, fight.size());
+            for (unsigned id : fight) mix(seed, std::hash<unsigned>()(id));
+        }
+        return seed;
+    }
+
+    /**
+     * estimate(): scores a batch of quests for a hero. Quests already in the cache are handed back straight away, the rest share
+     * the time budget, taking turns so they all get about the same number of runs.
+     * A quest whose runs all didn't fit into the budget comes back with fewer runs, possibly none. What it did get is remembered,
+     * and the next call for it picks up where this one left off until it has all SIM_RUNS_PER_QUEST of them.
+     * The quests are played out by the hero at full health, so how hurt they happen to be when they look doesn't change the
+     * estimate, and healing afterwards can't make a quest priced for a hurt hero any easier.
+     * args: hero (who is taking the quests, left untouched), plans (the quests), budget (how long to spend at most),
+     *       threads (how many workers to use, 0 to pick based on the machine)
+     * outputs: an estimate for each plan
+     * */
+    std::vector<QuestEstimate> estimate(Adventurer& hero, const std::vector<QuestPlan>& plans,
+                                        std::chrono::milliseconds budget = std::chrono::milliseconds(SIM_BUDGET_MS), unsigned threads = 0){
+        std::vector<QuestEstimate> result(plans.size());
+        std::vector<Key> keys(plans.size());
+        std::vector<unsigned> pending;
+        size_t build = buildHash(hero);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for (unsigned i = 0; i < plans.size(); ++i){
+                keys[i] = Key{build, planHash(plans[i])};
+                std::unordered_map<Key, QuestEstimate, KeyHash>::iterator it = cache.find(keys[i]);
+                if (it != cache.end()) result[i] = it->second;
+                if (result[i].runs < SIM_RUNS_PER_QUEST) pending.push_back(i);
+            }
+        }
+        if (pending.empty()) return result;
+
+        Adventurer* rested = hero.clone();
+        rested->setHealth(rested->getMaxHealth());
+        if (threads == 0) threads = std::min(SIM_MAX_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + budget;
+        // the runs each quest is still owed, dealt out a round at a time so the ones with the fewest runs catch up first
+        std::vector<unsigned> order;
+        for (unsigned round = 0; round < SIM_RUNS_PER_QUEST; ++round){
+            for (unsigned slot = 0; slot < pending.size(); ++slot){
+                if (result[pending[slot]].runs <= round) order.push_back(slot);
+            }
+        }
+        unsigned long totalRuns = order.size();
+        std::atomic<unsigned long> next(0);
+        std::vector<std::vector<QuestEstimate> > tallies(threads, std::vector<QuestEstimate>(pending.size()));
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t){
+            workers.push_back(std::thread([&, t](){
+                MutedOutput muted;
+                EnemyFactory enemies;
+                while (std::chrono::steady_clock::now() < deadline){
+                    unsigned long run = next++;
+                    if (run >= totalRuns) break;
+                    unsigned slot = order[run];
+                    tallies[t][slot].add(simulateQuest(*rested, plans[pending[slot]], enemies));
+                }
+            }));
+        }
+        for (auto& worker : workers) worker.join();
+        delete rested;
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (cache.size() + pending.size() > SIM_CACHE_LIMIT) cache.clear();
+        for (unsigned slot = 0; slot < pending.size(); ++slot){
+            unsigned i = pending[slot];
+            for (unsigned t = 0; t < threads; ++t) result[i].add(tallies[t][slot]);
+            if (result[i].runs > 0) cache[keys[i]] = result[i];
+        }
+        return result;
+    }
+
+    /** Returns how many estimates are remembered. */
+    unsigned cached(){
+        std::lock_guard<std::mutex> guard(lock);
+        return cache.size();
+    }
+};
+
+/** Returns the estimator shared by every town. */
+inline QuestEstimator& questEstimator(){
+    static QuestEstimator estimator;
+    return estimator;
+}
+
+#endif
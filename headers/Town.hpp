@@ -2,55 +2,74 @@
 #define __TOWN_H__
 
 #include "./../source/Quest.cpp"
+#include "./../source/EndlessQuest.cpp"
 #include "./Entity.hpp"
 #include "./../source/InputReader.cpp"
 #include "./../source/CombatRoom.cpp"
 #include "./Factory.hpp"
+#include "./QuestBoard.hpp"
 
 #include <string>
 #include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
 
-//FIXME: Whitespace should be cleaned up throughout the entire program whenever we can :)
+class Town;
 
-struct QuestStub {
-   QuestStub() { reward = 0; boss = nullptr; task = ""; }
-   QuestStub(unsigned int r, Enemy* b, std::string t) {
-      reward = r;
-      boss = b;
-      task = t;
-   }
-   ~QuestStub() { delete boss; }
-   unsigned int reward;
-   Enemy* boss;
-   std::string task;
+//Something that wants to hear about every change the player makes in town, e.g. the autosave
+class TownListener {
+public:
+   virtual ~TownListener() = default;
+   virtual void changed(const Adventurer* player, const Town* town) = 0;
 };
 
-
-
+//FIXME: Whitespace should be cleaned up throughout the entire program whenever we can :)
 
 class Town {
 private:
    //unsigned int condition; //Future project for expansion
-   QuestStub* q1;
-   QuestStub* q2;
+   unsigned seed, boardSize;
+   QuestBoard board;
+   int picked = NO_PICK; //which quest nextQuest is: a position on the board, PICK_ENDLESS, or NO_PICK
+   int pickedLevel = 0;
+   unsigned pickedReward = 0;
+   QuestSort boardSort = SORT_POSTED;
+   unsigned boardFilter = 0; //boss ID shown on the board, 0 for every boss
+   unsigned boardPage = 0;
+   unsigned int endlessReward; //gold per floor reached in the Depths
    Quest* nextQuest;
    std::string description;
    std::vector<Item*> supply{ nullptr, nullptr, nullptr };
 
 
 //Displays the Inn and manages quest selection
-   void Inn() {
+   void Inn(Adventurer* player) {
       if (nextQuest == nullptr) {
          InputReader* read = new InputReader("Invalid response, please press the number of the quest you want to accept. ");
          std::cout << "\nYou enter the Inn and rush to the Quest Board.\n"; //May make this more flavorful later.
-         displayBoard();
 
-         int choices[2] = {1, 2};
-         int qSelect = read->readInput(choices, 2);
+         int choices[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+         while (nextQuest == nullptr) {
+            //only the quests on the page get sized up. That can reorder a board sorted by value, so the page is cut again after
+            board.calibrate(player, QuestBoard::page(board.view(boardSort, boardFilter), boardPage, PAGE_SIZE));
+            std::vector<unsigned> shown = QuestBoard::page(board.view(boardSort, boardFilter), boardPage, PAGE_SIZE);
+            board.calibrate(player, shown);
+            displayBoard(shown);
+            int qSelect = read->readInput(choices, 11);
+
+            if (qSelect <= (int)PAGE_SIZE) {
+               if ((unsigned)qSelect <= shown.size()) { restoreQuest(shown[qSelect - 1], player->getLevel(), board.at(shown[qSelect - 1]).reward); }
+               else { std::cout << "\nThere's no quest pinned there.\n"; }
+            }
+            else if (qSelect == 6) { turnPage(1); }
+            else if (qSelect == 7) { turnPage(-1); }
+            else if (qSelect == 8) { resort(SORT_RISK); }
+            else if (qSelect == 9) { resort(SORT_REWARD_PER_RISK); }
+            else if (qSelect == 10) { boardFilter = nextFilter(); boardPage = 0; }
+            else { restoreQuest(PICK_ENDLESS, player->getLevel(), endlessReward); }
+         }
          delete read;
-
-         if (qSelect == 1) { generate(q1); }
-         else { generate(q2); }
       }
 
       else { //a quest has already been selected
@@ -157,23 +176,67 @@ private:
 
 
 
-//Displays the quest board
-   void displayBoard() {
+//Sets up a practice fight against a few enemies the player could meet at their level. Turns can be taken back and nothing is kept
+   void TrainingYard(Adventurer* player) {
+      std::cout << "\nYou head over to the training yard. The trainer lets a few captured monsters out of their pens."
+                << "\n\"Go on, have a go. If it goes badly, I'll step in. Think twice about anything you like.\"\n";
+      CombatRoom yard("Training Yard", "The trainer shouts for the bout to begin!", "The pens are empty for today.");
+      yard.setPractice(true);
+      std::mt19937 rng(rand());
+      ContentQuery foes = ContentQuery().with(TAG_ENEMY).atMost(ATTR_MIN_LEVEL, player->getLevel());
+      EnemyFactory enemies;
+      unsigned count = 1 + rng() % 3;
+      for (unsigned i = 0; i < count; ++i) { yard.addEnemy(enemies.generate(contentIndex().sample(foes, rng))); }
+      yard.linkPlayer(player);
+      yard.interact();
+   }
+
+
+
+//Displays one page of the quest board
+   void displayBoard(const std::vector<unsigned>& shown) {
+      std::vector<unsigned> view = board.view(boardSort, boardFilter);
       std::cout << "\n ----------------- QUEST BOARD -----------------"
-                << "\n1.\t" << q1->task << q1->boss->getName() << "!"
-                << "\n\tReward: " << q1->reward << " gold\n"
-                << "\n2.\t" << q2->task << q2->boss->getName() << "!"
-                << "\n\tReward: " << q2->reward << " gold"
+                << "\n Page " << boardPage + 1 << " of " << QuestBoard::pageCount(view, PAGE_SIZE) << ", " << view.size() << " quests";
+      if (boardFilter != 0) { std::cout << " against a " << bossProfile(boardFilter).name; }
+      std::cout << "\n";
+      for (unsigned i = 0; i < shown.size(); ++i) {
+         const QuestStub& q = board.at(shown[i]);
+         std::cout << "\n" << i + 1 << ".\t" << q.task << bossProfile(q.boss).name << " in " << biomeCatalog()[q.biome].name << "!"
+                   << "\n\tReward: " << q.reward << " gold\tRisk: " << (int)(q.risk + 0.5)
+                   << "\tGold per risk: " << (int)(q.rewardPerRisk() * 10 + 0.5) / 10.0;
+         if (q.estimate.runs > 0) {
+            std::cout << "\n\tChance to make it back: " << (int)(q.estimate.winChance() * 100 + 0.5) << "%"
+                      << "\tExpected health lost: " << (int)(q.estimate.averageHpLost() + 0.5);
+         }
+         std::cout << "\n";
+      }
+      std::cout << "\n6.\tNext page\t\t7.\tPrevious page"
+                << "\n8.\tSort by risk\t\t9.\tSort by gold per risk"
+                << "\n10.\tShow " << (nextFilter() == 0 ? "every boss" : "only " + bossProfile(nextFilter()).name + " quests")
+                << "\n11.\tDescend into the endless Depths and come back alive!"
+                << "\n\tReward: " << endlessReward << " gold for every floor reached"
                 << "\n -----------------------------------------------"
                 << "\nPress the corresponding number to accept that quest." << std::endl;
    }
 
+//Flips the board forwards or backwards, staying on the first or last page
+   void turnPage(int by) {
+      unsigned pages = QuestBoard::pageCount(board.view(boardSort, boardFilter), PAGE_SIZE);
+      if (by < 0 && boardPage == 0) { return; }
+      boardPage = std::min(pages - 1, boardPage + by);
+   }
 
+//The boss filter after this one. Goes through every boss, then back to showing them all
+   unsigned nextFilter() const {
+      if (boardFilter == 0) { return BOARD_FIRST_BOSS; }
+      return boardFilter + 1 < BOARD_FIRST_BOSS + BOARD_BOSS_KINDS ? boardFilter + 1 : 0;
+   }
 
-//Initializes the chosen quest and deallocates memory
-   Quest* generate(QuestStub* q) {
-      nextQuest = new Quest(q->reward, q->boss, q->task);
-      q->boss = nullptr; //q->boss passed into quest, must not be deleted!
+//Sorts the board, or goes back to posting order if it was already sorted that way
+   void resort(QuestSort sort) {
+      boardSort = boardSort == sort ? SORT_POSTED : sort;
+      boardPage = 0;
    }
 
 
@@ -186,30 +249,35 @@ private:
                 << "\n4.\tHead out on a Quest"
                 << "\n5.\tCheck player info"
                 << "\n6.\tCheck your inventory"
+                << "\n7.\tSpar at the training yard"
                 << "\n0.\tSave and Quit" << std::endl;
    }
 
 
 
 public:
-   Town() {
-      //condition = (rand() % 100) + 1;
-      EnemyFactory bossGen;
-      Enemy* q1B = bossGen.generate((rand() % 5) + 10001);
-      Enemy* q2B = bossGen.generate((rand() % 5) + 10001);
-      q1 = new QuestStub(((rand() % 101) + 50), q1B, "Defeat a dangerous ");
-      q2 = new QuestStub(((rand() % 101) + 50), q2B, "Eliminate an evil ");
+   static const unsigned BOARD_SIZE = 12; //quests posted in a town unless asked otherwise
+   static const unsigned PAGE_SIZE = 5; //quests shown on one page of the board
+   static const int NO_PICK = -1, PICK_ENDLESS = -2;
+
+   Town() : Town(rand()) {}
+
+   //Builds a town, along with the quests on its board. Everything is rolled from the seed, so this is safe to run off the main thread
+   explicit Town(unsigned seed, unsigned boardSize = BOARD_SIZE) : seed(seed), boardSize(boardSize) {
+      std::mt19937 rng(seed);
+      //condition = (rng() % 100) + 1;
+      board = QuestBoard(boardSize, rng);
+      endlessReward = (rng() % 11) + 15;
       ItemFactory itemGen;
       nextQuest = nullptr;
       description = "You are in town.";
       supply.at(0) = itemGen.generate(20004); //guarantee potions in store
-      supply.at(1) = itemGen.generate((rand() % 9) + 20001);
-      supply.at(2) = itemGen.generate((rand() % 9) + 20001);
+      ContentQuery stock = ContentQuery().with(TAG_ITEM).with(TAG_SHOP);
+      supply.at(1) = itemGen.generate(contentIndex().sample(stock, rng));
+      supply.at(2) = itemGen.generate(contentIndex().sample(stock, rng));
    }
 
    ~Town() {
-      if (q1 != nullptr) { delete q1; }
-      if (q2 != nullptr) { delete q2; }
       nextQuest = nullptr; //cannot be deleted, quest is needed. Delete quest directly instead
       for (unsigned i = 0; i < supply.size(); ++i) {
          delete supply.at(i);
@@ -217,24 +285,50 @@ public:
    }
 
 
+   const QuestBoard& getBoard() const {
+      return board;
+   }
+
+   unsigned getSeed() const { return seed; }
+   unsigned getBoardSize() const { return boardSize; }
+   int getPicked() const { return picked; }
+   int getPickedLevel() const { return pickedLevel; }
+   unsigned getPickedReward() const { return pickedReward; }
+
+   //Sets up the quest the player is heading out on: a position on the board or PICK_ENDLESS, for a player of the given level and paying the given reward
+   void restoreQuest(int pick, int level, unsigned reward) {
+      delete nextQuest;
+      nextQuest = nullptr;
+      picked = pick;
+      pickedLevel = level;
+      pickedReward = reward;
+      if (pick == PICK_ENDLESS) { nextQuest = new EndlessQuest(reward, level); }
+      else if (pick >= 0 && (unsigned)pick < board.size()) { nextQuest = board.accept(pick, level, reward); }
+      else { picked = NO_PICK; }
+   }
+
+   //The quest the player has picked, if any. The town doesn't own it
+   Quest* getQuest() const { return nextQuest; }
+
    //Master function that manages all of the town. Accepts the player and returns the Quest to be started.
-   Quest* RoamTown(Adventurer* player) {
+   //The listener, if there is one, hears about it every time the player is done at the Inn, Store or Clinic
+   Quest* RoamTown(Adventurer* player, TownListener* listener = nullptr) {
       bool questStarted = false;
       InputReader* read = new InputReader();
-      int choices[] = {0,1,2,3,4,5,6};
+      int choices[] = {0,1,2,3,4,5,6,7};
       int select = -1;
 
       while (select != 0 && !questStarted) {
          std::cout << std::endl << description << std::endl;
          displayMenu();
          
-         select = read->readInput(choices,7);
+         select = read->readInput(choices,8);
          switch(select) {
             case 0:
                if (nextQuest != nullptr) { delete nextQuest; }
                nextQuest = nullptr;
                break;
-            case 1: Inn();    break;
+            case 1: Inn(player);    break;
             case 2: Store(player);  break;
             case 3: Clinic(player); break;
             case 4:
@@ -249,11 +343,54 @@ public:
                break;
             case 5: player->inspect(); break;
             case 6: player->checkInventory(); break;
+            case 7: TrainingYard(player); break;
          }
+         if (listener != nullptr && select >= 1 && select <= 3) { listener->changed(player, this); }
       }
       delete read;
       return nextQuest;
    }
 };
 
+
+
+/*
+ * TownBuilder: builds the next Town on a worker thread while the current quest is being played.
+ * The worker publishes the finished town through an atomic pointer, and take() grabs it with a single exchange.
+ * If the town isn't done yet, take() waits for the worker instead.
+ */
+class TownBuilder {
+private:
+   std::atomic<Town*> ready;
+   std::thread worker;
+
+public:
+   TownBuilder() : ready(nullptr) {}
+   TownBuilder(const TownBuilder&) = delete;
+   TownBuilder& operator=(const TownBuilder&) = delete;
+
+   ~TownBuilder() {
+      if (worker.joinable()) { worker.join(); }
+      delete ready.exchange(nullptr);
+   }
+
+   //Starts building a town in the background. Any town from an earlier start that wasn't taken is thrown away
+   void start(unsigned seed) {
+      if (worker.joinable()) { worker.join(); }
+      delete ready.exchange(nullptr);
+      worker = std::thread([this, seed]() { ready.store(new Town(seed), std::memory_order_release); });
+   }
+
+   //Hands over the town built by the last start(). Builds one on the spot if nothing was started
+   Town* take() {
+      Town* town = ready.exchange(nullptr, std::memory_order_acquire);
+      if (town == nullptr && worker.joinable()) {
+         worker.join(); //still building, wait for it
+         town = ready.exchange(nullptr, std::memory_order_acquire);
+      }
+      if (worker.joinable()) { worker.join(); } //the worker is already done by now, this only tidies it up
+      return town != nullptr ? town : new Town();
+   }
+};
+
 #endif
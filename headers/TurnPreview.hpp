@@ -0,0 +1,158 @@
+#ifndef __TURN_PREVIEW_H__
+#define __TURN_PREVIEW_H__
+
+#include "./Adventurer.hpp"
+#include "./Console.hpp"
+#include "./Dice.hpp"
+#include "./CombatSnapshot.hpp"
+#include "./CombatSearch.hpp"
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <cmath>
+
+// a move's numbers only show up once it has been tried this many times, and it stops being tried after the most
+const unsigned PREVIEW_MIN_TRIES = 40;
+const unsigned PREVIEW_MAX_TRIES = 4000;
+
+/**
+ * TurnPreview: tries every move the hero has over and over on a worker thread while the turn menu waits for the player, and
+ * keeps a running tally for each: how much damage it does, how often it takes an enemy down and how often the hero is still
+ * standing when their next turn comes around. The menu reads the tally whenever it prints, so the numbers get better the
+ * longer the player thinks.
+ * Everything the worker needs is copied before it starts, so the prompt never waits on it and it never touches the real fight.
+ * It stops as soon as the player settles on a move, or once every move has been tried PREVIEW_MAX_TRIES times.
+ * */
+class TurnPreview : public MovePreview {
+private:
+    struct Tally {
+        CombatAction action;
+        unsigned tries = 0, kills = 0, survived = 0;
+        double damage = 0;
+    };
+
+    CombatSnapshot root;
+    Adventurer* fighter; // the worker's copy of the hero
+    std::vector<Tally> tallies;
+    int foeHealth = 0;
+    unsigned seed;
+    std::atomic<bool> running;
+    std::mutex lock; // guards tallies
+    std::thread worker;
+
+    /** Tries one move once, starting from the fight as it was when the preview began. */
+    void tryMove(unsigned move, std::vector<Enemy*>& foes, std::minstd_rand& dice){
+        CombatTally tally;
+        root.restore(std::vector<Adventurer*>(1, fighter), foes, tally);
+        combatDice().seed(dice());
+        const CombatAction& action = tallies[move].action;
+
+        performAction(action, fighter, foes);
+        int left = 0;
+        bool killed = false;
+        for (unsigned t = 0; t < foes.size(); ++t){
+            left += std::max(0, foes[t]->getCurrentHealth());
+            if (!foes[t]->isAlive() && (action.target < 0 || action.target == (int)t)) killed = true;
+        }
+        finishTurn(fighter, foes);
+
+        std::lock_guard<std::mutex> guard(lock);
+        Tally& result = tallies[move];
+        result.tries++;
+        result.damage += foeHealth - left;
+        result.kills += killed;
+        result.survived += fighter->isAlive();
+    }
+
+    void work(){
+        MutedOutput muted;
+        std::minstd_rand dice(seed);
+        std::vector<Enemy*> foes;
+        for (unsigned round = 0; round < PREVIEW_MAX_TRIES && running; ++round){
+            for (unsigned move = 0; move < tallies.size() && running; ++move) tryMove(move, foes, dice);
+        }
+        for (auto e : foes) delete e;
+    }
+
+public:
+    /**
+     * Constructor
+     * Copies the fight and starts working on it straight away.
+     * args: hero (the one whose turn it is), foes (the enemies in the fight). Neither is touched
+     * */
+    TurnPreview(Adventurer* hero, const std::vector<Enemy*>& foes) : fighter(hero->clone()), running(true) {
+        root = CombatSnapshot::take(std::vector<Adventurer*>(1, hero), foes, CombatTally());
+        for (const CombatAction& action : legalActions(hero, foes)){
+            Tally tally;
+            tally.action = action;
+            tallies.push_back(tally);
+        }
+        for (auto e : foes) foeHealth += std::max(0, e->getCurrentHealth());
+        CombatDice peek = combatDice(); // a copy, so looking ahead doesn't change how the fight rolls
+        seed = peek();
+        worker = std::thread(&TurnPreview::work, this);
+    }
+
+    ~TurnPreview(){
+        stop();
+        worker.join();
+        delete fighter;
+    }
+
+    TurnPreview(const TurnPreview&) = delete;
+    TurnPreview& operator=(const TurnPreview&) = delete;
+
+    /** Tells the worker to stop. It finishes the try it is on, which is over in moments, without being waited for. */
+    void stop(){
+        running = false;
+    }
+
+    /** Returns whether the worker has been told to stop. */
+    bool stopped() const {
+        return !running;
+    }
+
+    /** Returns how many times a move has been tried so far, 0 if it isn't one of the hero's moves. */
+    unsigned tries(const CombatAction& action){
+        std::lock_guard<std::mutex> guard(lock);
+        for (const Tally& tally : tallies){
+            if (tally.action == action) return tally.tries;
+        }
+        return 0;
+    }
+
+    /**
+     * note(): sums up a move's tally for the turn menu, like "~34 dmg, 60% kill, 92% safe".
+     * args: action (the move)
+     * outputs: the summary, or an empty string until it has been tried PREVIEW_MIN_TRIES times
+     * */
+    std::string note(const CombatAction& action){
+        std::lock_guard<std::mutex> guard(lock);
+        for (const Tally& tally : tallies){
+            if (!(tally.action == action)) continue;
+            if (tally.tries < PREVIEW_MIN_TRIES) return "";
+            // small numbers get a decimal place, so a move that only sometimes lands doesn't read as doing nothing
+            int tenths = (int)round(10 * tally.damage / tally.tries);
+            std::string damage = tenths < 100 ? std::to_string(tenths / 10) + "." + std::to_string(tenths % 10) : std::to_string((tenths + 5) / 10);
+            return "~" + damage + " dmg, "
+                   + std::to_string((int)round(100.0 * tally.kills / tally.tries)) + "% kill, "
+                   + std::to_string((int)round(100.0 * tally.survived / tally.tries)) + "% safe";
+        }
+        return "";
+    }
+};
+
+/**
+ * previewTurn(): starts looking ahead at the hero's moves for the turn menu. See Adventurer::setPreview().
+ * args: hero (the one whose turn it is), foes (the enemies in the fight)
+ * outputs: the preview, owned by the caller
+ * */
+inline MovePreview* previewTurn(Adventurer* hero, const std::vector<Enemy*>& foes){
+    return new TurnPreview(hero, foes);
+}
+
+#endif
@@ -11,44 +11,143 @@ Adventurer::Adventurer(std::string name, std::string description) {
     }
 
 Adventurer::~Adventurer(){
-    for (auto i : inventory) delete i;
+    itemCooldowns.clear();
     inventory.clear();
 }
 
 /**
- * levelUp(): levels up the player and applies all relevant bonuses.
+ * Adventurer(): copies a character's build, meaning their stats, level, gold and cooldowns. Items are not copied, the copy starts
+ * with an empty bag. Only clone() uses this.
+ * */
+Adventurer::Adventurer(const Adventurer& other) : Entity(other) {
+    level = other.level;
+    experience = other.experience;
+    gold = other.gold;
+    maxHealthBonus = other.maxHealthBonus;
+    physAtkBonus = other.physAtkBonus;
+    physDefBonus = other.physDefBonus;
+    magAtkBonus = other.magAtkBonus;
+    magDefBonus = other.magDefBonus;
+    speedBonus = other.speedBonus;
+    growth = other.growth;
+    for (int i = 0; i < MAX_ABILITIES; ++i) abilityCD[i] = other.abilityCD[i];
+}
+
+/**
+ * clone(): makes a copy of this character to play out fights with, without touching the real one. Every class overrides this.
+ * args: none
+ * outputs: the copy, without any items. The caller owns it
+ * */
+Adventurer* Adventurer::clone() const {
+    return new Adventurer(*this);
+}
+
+/**
+ * levelUp(): levels up the player once and applies all relevant bonuses.
  * args: none
  * outputs: none
  * */
 void Adventurer::levelUp(){
+    applyLevels(1);
+}
+
+/**
+ * setGrowth(): changes how much each stat goes up by per level from here on. Levels already gained keep what they gave.
+ * Balance tools use this to try out other numbers, classes set their own in their constructor.
+ * args: perLevel (the new growth)
+ * outputs: none
+ * */
+void Adventurer::setGrowth(const StatGrowth& perLevel){
+    growth = perLevel;
+}
+
+const StatGrowth& Adventurer::getGrowth() const {
+    return growth;
+}
+
+/**
+ * applyLevels(): levels up the player several times at once. 
+ * Stat growth for every level is added in one step and only a single summary is printed, 
+ * followed by any abilities unlocked along the way. Levels past LEVEL_CAP are ignored.
+ * The summary goes to gameOut(), so leveling a copy up on a worker thread prints nothing.
+ * args: levels (how many levels to gain)
+ * outputs: none
+ * */
+void Adventurer::applyLevels(int levels){
+    levels = std::min(levels, LEVEL_CAP - level);
+    if (levels <= 0) return;
+
     // update stats
-    std::cout << "You leveled up!\n";
-    if (hpLvl > 0){
-        maxHealth += hpLvl;
-        health += hpLvl;
-        std::cout << "Health: +" << hpLvl <<"\n";
+    if (levels == 1) gameOut() << "You leveled up!" << levelUpFlavor() << "\n";
+    else gameOut() << "You gained " << levels << " levels!" << levelUpFlavor() << "\n";
+    if (growth.hp > 0){
+        maxHealth += growth.hp * levels;
+        health += growth.hp * levels;
+        gameOut() << "Health: +" << growth.hp * levels << "\n";
     }
-    if (pAtkLvl > 0){
-        physAtk += pAtkLvl; 
-        std::cout << "Physical ATK: +" << pAtkLvl << "\n";
+    if (growth.pAtk > 0){
+        physAtk += growth.pAtk * levels; 
+        gameOut() << "Physical ATK: +" << growth.pAtk * levels << "\n";
     }
-    if (pDefLvl > 0){
-        physDef += pDefLvl; 
-        std::cout << "Physical DEF: +" << pDefLvl << "\n";
+    if (growth.pDef > 0){
+        physDef += growth.pDef * levels; 
+        gameOut() << "Physical DEF: +" << growth.pDef * levels << "\n";
     }
-    if (mAtkLvl > 0){
-        magAtk += mAtkLvl; 
-        std::cout << "Magical ATK: +" << mAtkLvl << "\n";
+    if (growth.mAtk > 0){
+        magAtk += growth.mAtk * levels; 
+        gameOut() << "Magical ATK: +" << growth.mAtk * levels << "\n";
     }
-    if (mDefLvl > 0){
-        magAtk += mAtkLvl; 
-        std::cout << "Magical DEF: +" << mDefLvl << "\n";
+    if (growth.mDef > 0){
+        magDef += growth.mDef * levels; 
+        gameOut() << "Magical DEF: +" << growth.mDef * levels << "\n";
     }
-    if (spdLvl > 0){
-        speed += spdLvl;
-        std::cout << "Speed: +" << spdLvl << "\n";
+    if (growth.spd > 0){
+        speed += growth.spd * levels;
+        gameOut() << "Speed: +" << growth.spd * levels << "\n";
     }
-	++level;	
+
+    // update abilities
+    int previous = level;
+    level += levels;
+    const std::vector<AbilityDef>& abilities = abilityTable();
+    for (unsigned i = 0; i < abilities.size(); ++i){
+        if (abilities[i].unlockLevel > previous && abilities[i].unlockLevel <= level){
+            gameOut() << "You unlocked " << abilities[i].name << ".\n";
+            onUnlock(i);
+        }
+    }
+}
+
+/**
+ * levelUpFlavor(): the class-specific bit of text printed after "You leveled up!". Should start with a space.
+ * args: none
+ * outputs: the flavor text
+ * */
+std::string Adventurer::levelUpFlavor() const {
+    return "";
+}
+
+/**
+ * className(): the name of this class, as shown when inspecting the player.
+ * args: none
+ * outputs: the class name
+ * */
+std::string Adventurer::className() const {
+    return "Adventurer";
+}
+
+/**
+ * onUnlock(): called after an ability is unlocked, for classes that do something extra when that happens.
+ * args: index (the ability's position in the ability table)
+ * outputs: none
+ * */
+void Adventurer::onUnlock(int /* index */){
+
+}
+
+/**xpToNextLevel(): the experience needed to reach the next level.*/
+double Adventurer::xpToNextLevel() const {
+    return XpTable::threshold[std::min(level, LEVEL_CAP)];
 }
 	
 int Adventurer::getLevel() const {
@@ -64,8 +163,8 @@ int Adventurer::getInvSize() const {
 }
 
 void Adventurer::inspect(){
-    std::cout << name << " - Level " << level << " classgoeshere";
-    std::cout << "\nExperience: \t\t" << experience << ", " << 75 * pow(1.1, level) << " to level\n"
+    std::cout << name << " - Level " << level << " " << className();
+    std::cout << "\nExperience: \t\t" << experience << ", " << xpToNextLevel() << " to level\n"
     "Gold: \t\t\t" << gold << "\n"
     "Health: \t\t" << health << "/" << maxHealth << " (+" << maxHealthBonus << ")\n"
     "Physical ATK: \t\t" << physAtk << " (+" << physAtkBonus << ")\n"
@@ -73,9 +172,20 @@ void Adventurer::inspect(){
     "Magical ATK: \t\t" << magAtk << " (+" << magAtkBonus << ")\n"
     "Magical DEF: \t\t" << magDef << " (+" << magDefBonus << ")\n"
     "Speed: \t\t\t" << speed << " (+" << speedBonus << ")\n";
+    printSpecialFeature();
 
     std::cout << "\nAbilities:\n";
-    std::cout << "You don't have any abilities unlocked.\n";
+    const std::vector<AbilityDef>& abilities = abilityTable();
+    bool any = false;
+    for (unsigned i = 0; i < abilities.size(); ++i){
+        if (!abilityUnlocked(i)) continue;
+        any = true;
+        std::cout << abilities[i].name << " (";
+        if (abilities[i].cooldown > 0) std::cout << abilities[i].cooldown << " turn CD";
+        else std::cout << "no CD";
+        std::cout << "): " << abilities[i].description << "\n";
+    }
+    if (!any) std::cout << "You don't have any abilities unlocked.\n";
 }
 
 /**
@@ -84,7 +194,7 @@ void Adventurer::inspect(){
  * outputs: none
  * */
 void Adventurer::checkInventory(){
-    if (inventory.size() <= 0) std::cout << "Your bag is empty!\n";
+    if (inventory.empty()) std::cout << "Your bag is empty!\n";
     else {
         InputReader reader;
 
@@ -96,50 +206,72 @@ void Adventurer::checkInventory(){
         switch(invSelect){
             case 0: break; // do nothing
             case 1: { // inspect
-                std::cout << "Choose an option.\n"
-                          << "0:\tCancel\n";
-                
-                // print list of items
-                int index = 1;
-                int itemIndices[inventory.size()];
-                for (auto item : inventory){
-                    std::cout << index << ":\t" << item->getName() <<"\n";
-                    itemIndices[index - 1] = index;
-                    ++index;
-                }
-
-                // prompt user for their choice and inspect it
-                invSelect = reader.readInputCancel(itemIndices, inventory.size());
-                if (invSelect == 0) break;
-                inventory[invSelect - 1]->inspect();
+                std::cout << "Choose an option.\n";
+                int slot = chooseItem(nullptr, false);
+                if (slot != -1) inventory.at(slot)->inspect();
             } break;
             case 2: {
-                std::cout << "Choose an option.\n"
-                          << "0:\tCancel\n";
-
-                // print list of items
-                int index = 1;
-                int itemIndices[inventory.size()];
-                for (auto item : inventory){
-                    std::cout << index << ":\t" << item->getName() <<"\n";
-                    itemIndices[index - 1] = index;
-                    ++index;
-                }
-                
-                // prompt user for their choice and use it if it's a consumable
-                int useChoice = reader.readInputCancel(itemIndices, inventory.size());
-                if (useChoice == 0) break;
-                if (inventory[useChoice - 1]->isConsumable()){
-                    inventory[useChoice - 1]->ability(this, NULL);
-                    inventory.erase(inventory.begin() + useChoice - 1);
-                } else {
-                    std::cout << "You can't do that here.\n";
-                }
+                // only consumables can be used outside of combat
+                std::cout << "Choose an option.\n";
+                int slot = chooseItem(consumablesOnly, false);
+                if (slot == -1) break;
+                inventory.at(slot)->ability(this, NULL);
+                inventory.consume(slot);
             }
         }
     }
 }
 
+/**
+ * chooseItem(): prints a page of the user's items and lets them pick one. 
+ * Bags with more than INVENTORY_PAGE_SIZE slots are split into pages the user can flip through. 
+ * args: filter (which items to list, nullptr for all of them), showAbility (whether to print each item's ability name),
+ *       showPreview (whether to print how using each self use item looks to go, see setPreview())
+ * outputs: the inventory slot that was picked, or -1 if the user cancelled or nothing matched
+ * */
+int Adventurer::chooseItem(bool (*filter)(Item*), bool showAbility, bool showPreview){
+    InputReader reader;
+    const int PREV_PAGE = 98, NEXT_PAGE = 99;
+    unsigned page = 0;
+
+    while (true){
+        bool hasMore = false;
+        std::vector<unsigned> shown = inventory.view(filter, page, INVENTORY_PAGE_SIZE, hasMore);
+        if (shown.empty() && page == 0){
+            std::cout << "You don't have anything you can use here.\n";
+            return -1;
+        }
+
+        // build the whole page first and print it in one go
+        std::string menu = "0:\tCancel\n";
+        std::vector<int> choices;
+        for (unsigned i = 0; i < shown.size(); ++i){
+            Item* item = inventory.at(shown[i]);
+            menu += std::to_string(i + 1) + ":\t" + item->getName();
+            if (showAbility) menu += ": " + item->getAbilityName();
+            if (inventory.countAt(shown[i]) > 1) menu += " (x" + std::to_string(inventory.countAt(shown[i])) + ")";
+            if (showPreview && item->isSelfUse()) menu += previewNote(CombatAction::ITEM, shown[i], -1);
+            menu += "\n";
+            choices.push_back(i + 1);
+        }
+        if (page > 0){
+            menu += std::to_string(PREV_PAGE) + ":\tPrevious page\n";
+            choices.push_back(PREV_PAGE);
+        }
+        if (hasMore){
+            menu += std::to_string(NEXT_PAGE) + ":\tNext page\n";
+            choices.push_back(NEXT_PAGE);
+        }
+        std::cout << menu;
+
+        int select = reader.readInputCancel(choices.data(), choices.size());
+        if (select == 0) return -1;
+        if (select == PREV_PAGE) --page;
+        else if (select == NEXT_PAGE) ++page;
+        else return shown[select - 1];
+    }
+}
+
 /**printSpecialFeature(): This is for displaying special features like the Samurai's Ki bar.
  * args: none
  * outputs: none
@@ -154,15 +286,18 @@ void Adventurer::addGold(int gold){
 
 
 /**addExp: adds experience from combat victories
- * Level up the player if they reach a certain amount.
+ * Level up the player if they reach a certain amount. 
+ * Every level the experience covers is worked out from the XP table and applied at once.
  * args: gain (exp to gain)
  * outputs: none
  * */
 void Adventurer::addExp(int gain){
     experience += gain;
-    while (experience > 75 * pow(1.1, level)){
-        experience -= 75 * pow(1.1, level);
-        levelUp();
+    long long spent = 0;
+    int levels = levelsAffordable(level, experience, spent);
+    if (levels > 0){
+        experience -= spent;
+        applyLevels(levels);
     }
 }
 
@@ -172,7 +307,6 @@ void Adventurer::addExp(int gain){
  * outputs: none
  * */
 void Adventurer::addItem(Item* item){
-    inventory.push_back(item);
     maxHealth += item->getMaxHealth();
     maxHealthBonus += item->getMaxHealth();
     health += item->getMaxHealth();
@@ -186,6 +320,7 @@ void Adventurer::addItem(Item* item){
     magDefBonus += item->getMDef();
     speed += item->getSpeed();
     speedBonus += item->getSpeed();
+    inventory.add(item); // this may delete item if it stacks onto an existing slot
 }
 
 /**
@@ -206,10 +341,10 @@ void Adventurer::deathPenalty(){
 void Adventurer::turn(std::vector<Enemy*> enemies){
     InputReader reader;
 
-    int inputChoices[]{1, 2, 3, 4, 5};
+    int inputChoices[]{1, 2, 3, 4, 5, 6};
     int selection = 0;
 
-    //turn is not used up when the selection is equal to 4 (player chooses to inspect).
+    //turn is not used up when the selection is equal to 4 (player chooses to inspect) or 6 (player asks for advice).
     while (selection != 1 && selection != 2 && selection != 3 && selection != 5){ 
         // prompt the user for their input and read it
         std::cout << "It's your turn. Available options:\n"
@@ -218,13 +353,15 @@ void Adventurer::turn(std::vector<Enemy*> enemies){
                 << "3:\tUse Item\n"
                 << "4:\tInspect\n"
                 << "5:\tFlee\n";
-        selection = reader.readInput(inputChoices, 5);
+        if (hint) std::cout << "6:\tAsk for advice\n";
+        selection = reader.readInput(inputChoices, hint ? 6 : 5);
         
         switch(selection){
             /*************************** ATTACK ***************************/
             case 1:{ 
                 // read the user's target
-                int enemySelection = selectTarget(enemies);
+                CombatAction move;
+                int enemySelection = selectTarget(enemies, &move);
                 // execute the action
                 if (enemySelection != 0) attack(enemies[enemySelection - 1]);
                 else selection = 0;
@@ -235,44 +372,39 @@ void Adventurer::turn(std::vector<Enemy*> enemies){
             } break;
             /*************************** ITEM ***************************/
             case 3:{ //use item
-		if (inventory.size() <= 0){
-			std::cout << "You don't have any items.\n";
-			selection = 0;
-			break;
-		}
-                std::cout << "Choose an item to use.\n"
-                          << "0:\tCancel\n";
-
-                // build item selection array
-                int itemChoices[inventory.size()];
-                int itemIndex = 1;
-                int itemSelection = 0;
-                if (inventory.size() > 0){
-                    for (auto item : inventory){
-                        std::cout << itemIndex << ":\t" << item->getName() << ": " << item->getAbilityName() << "\n";
-                        itemChoices[itemIndex - 1] = itemIndex;
-                        ++itemIndex;
-                    }
+                if (inventory.empty()){
+                    std::cout << "You don't have any items.\n";
+                    selection = 0;
+                    break;
                 }
+                std::cout << "Choose an item to use.\n";
 
                 // read what item the user wants to use
-                itemSelection = reader.readInputCancel(itemChoices, inventory.size());
-
-                if (itemSelection != 0){
+                int itemSlot = chooseItem(nullptr, true, true);
+
+                if (itemSlot != -1){
+                    Item* item = inventory.at(itemSlot);
+                    if (!item->abilityAvailable()){
+                        std::cout << "That item isn't ready yet. (Ready in " << item->getCooldown() << " turn(s))\n";
+                        selection = 0;
+                        break;
+                    }
                     // if the item is a self usage item, prompt for their target
-                    if (!inventory[itemSelection - 1]->isSelfUse()){
+                    if (!item->isSelfUse()){
                         // read the user's target
-                        int enemySelection = selectTarget(enemies);
+                        CombatAction move;
+                        move.kind = CombatAction::ITEM;
+                        move.index = itemSlot;
+                        int enemySelection = selectTarget(enemies, &move);
 
                         // execute the action
-                        if (enemySelection != 0) inventory[itemSelection - 1]->ability(this, enemies[enemySelection - 1]);
-                        else selection = 0; // if a cancel was selected, set selection to 0 so we don't consume the turn. 
+                        if (enemySelection != 0) useItem(itemSlot, enemies[enemySelection - 1]);
+                        else {
+                            selection = 0; // if a cancel was selected, set selection to 0 so we don't consume the turn. 
+                            break;
+                        }
                     } else { // else just use it on yourself 
-                        inventory[itemSelection - 1]->ability(this, NULL);
-                    }
-                    // if the item is consumable, destroy it
-                    if (inventory[itemSelection - 1]->isConsumable()){
-                        inventory.erase(inventory.begin() + itemSelection - 1);
+                        useItem(itemSlot, nullptr);
                     }
                 } else selection = 0;
             } break;
@@ -285,6 +417,11 @@ void Adventurer::turn(std::vector<Enemy*> enemies){
                 if (enemySelection != 0) enemies[enemySelection - 1]->inspect();
                 else selection = 0;
             } break;
+            /*************************** ADVICE ***************************/
+            case 6:{ // doesn't use up the turn either
+                hint();
+                selection = 0;
+            } break;
             /*************************** FLEE ***************************/
             case 5:{ //flee
                 std::cout << "Waste your turn and do nothing because this function isn't implemented.\n";
@@ -296,8 +433,38 @@ void Adventurer::turn(std::vector<Enemy*> enemies){
         }
     }
 
+    // the move is settled, so there is nothing left to look ahead for
+    if (preview != nullptr) preview->stop();
+
     // cycle cooldowns
     updateCooldowns();
+    updateItemCooldowns();
+}
+
+/**
+ * autoTurn: takes a turn without asking anyone, for fights that are only being simulated.
+ * Always goes after the enemy with the least health left. Uses the last ready ability in the ability table that has a cooldown
+ * (those are the big ones), and a basic attack otherwise. Items are never used.
+ * args: enemies (vector of valid enemy targets)
+ * outputs: none
+ * */
+void Adventurer::autoTurn(std::vector<Enemy*>& enemies){
+    Enemy* weakest = nullptr;
+    for (auto e : enemies){
+        if (e->isAlive() && (weakest == nullptr || e->getCurrentHealth() < weakest->getCurrentHealth())) weakest = e;
+    }
+    if (weakest == nullptr) return;
+
+    const std::vector<AbilityDef>& abilities = abilityTable();
+    int pick = -1;
+    for (int index : readyAbilities()){
+        if (abilities[index].cooldown > 0) pick = index;
+    }
+    if (pick != -1) useAbility(pick, enemies, abilities[pick].target == SINGLE_TARGET ? weakest : nullptr);
+    else attack(weakest);
+
+    updateCooldowns();
+    updateItemCooldowns();
 }
 
 /**attack: Generic attack method. Only the player can use this.
@@ -306,16 +473,17 @@ void Adventurer::turn(std::vector<Enemy*> enemies){
  * outputs: none
  * */
 void Adventurer::attack(Enemy* target){
-    std::cout << "You strike the " << target->getName() << " with your bare fists, dealing " << target->dealPDamage(physAtk) << " physical damage.\n";
+    gameOut() << "You strike the " << target->getName() << " with your bare fists, dealing " << target->dealPDamage(physAtk) << " physical damage.\n";
 }
 
 /**
  * selectTarget(): Prompts the user to select a target from a list.
  * Returns 0 if the user cancels. 
- * args: a std::vector<Enemy*> of valid enemy targets
+ * args: a std::vector<Enemy*> of valid enemy targets, the move being aimed (to print how it looks to go against each
+ *       target, see setPreview(). nullptr when there is nothing to preview)
  * outputs: an integer with the index of the user's selection in the vector
  * */
-int Adventurer::selectTarget(std::vector<Enemy*> targets){
+int Adventurer::selectTarget(std::vector<Enemy*> targets, const CombatAction* move){
     InputReader reader;
     // choose a target
     std::cout << "Choose a target.\n"
@@ -326,7 +494,9 @@ int Adventurer::selectTarget(std::vector<Enemy*> targets){
     int targetIndex = 1;
     int enemySelection = 0;
     for (auto e : targets){
-        std::cout << targetIndex << ":\t" << e->getName() <<"\n";
+        std::cout << targetIndex << ":\t" << e->getName();
+        if (move != nullptr) std::cout << previewNote(move->kind, move->index, targetIndex - 1);
+        std::cout << "\n";
         enemyChoices[targetIndex - 1] = targetIndex;
         ++targetIndex;
     }
@@ -411,26 +581,262 @@ int Adventurer::selectTarget(std::vector<Enemy*> targets){
  * 15: Elemental Hurricane. 15 turn CD. Channel the full power of the elements. Fully restore all energy and deal 150% MAtk magical damage 
  *      4 times and 150% MAtk physical damage one time (for earth) to random enemies. 
  * 
+ * The abilities themselves live in each class's ability table (see abilityTable()). This method just builds the menu 
+ * from that table, checks cooldowns, asks for a target if needed and runs the picked ability. 
  * args: targets (list of available targets)
- * outputs: a 0 if an ability was cast. 2 if not
+ * outputs: a 2 if an ability was cast. 0 if not
  * */
 int Adventurer::ability(std::vector<Enemy*> targets){
-    std::cout << "You don't have any abilities.\n";
-    return 0;
+    const std::vector<AbilityDef>& abilities = abilityTable();
+    std::vector<int> unlocked;
+    for (unsigned i = 0; i < abilities.size(); ++i){
+        if (abilityUnlocked(i)) unlocked.push_back(i);
+    }
+    if (unlocked.empty()){
+        std::cout << "You don't have any abilities.\n";
+        return 0;
+    }
+
+    // prompt for ability choice
+    InputReader reader;
+    std::cout << "Choose an ability to use.\n"
+              << "0:\tCancel\n";
+    std::vector<int> choices;
+    for (unsigned i = 0; i < unlocked.size(); ++i){
+        std::cout << i + 1 << ":\t" << abilities[unlocked[i]].name << " ";
+        if (abilityCD[unlocked[i]] == 0){
+            std::cout << "(Ready)";
+            if (abilities[unlocked[i]].target != SINGLE_TARGET) std::cout << previewNote(CombatAction::ABILITY, unlocked[i], -1);
+            std::cout << "\n";
+        }
+        else std::cout << "(Ready in " << abilityCD[unlocked[i]] << " turn(s))\n";
+        choices.push_back(i + 1);
+    }
+
+    // get user prompt and execute the action
+    int abiChoice = reader.readInputCancel(choices.data(), choices.size());
+    if (abiChoice == 0) return 0; // cancel selected
+    int index = unlocked[abiChoice - 1];
+    if (!abilityReady(index)){
+        std::cout << "That ability isn't ready yet.\n";
+        return 0;
+    }
+
+    Enemy* target = nullptr;
+    if (abilities[index].target == SINGLE_TARGET){
+        CombatAction move;
+        move.kind = CombatAction::ABILITY;
+        move.index = index;
+        int enemySelection = selectTarget(targets, &move);
+        if (enemySelection == 0) return 0;
+        target = targets[enemySelection - 1];
+    }
+    useAbility(index, targets, target);
+    return 2;
 }
 
 /**
- * updateCooldowns: reduces all cooldowns by 1 (if greater than 1)
+ * useItem: uses the item in a bag slot, puts it on cooldown and uses it up if it is consumable. No prompting is done, so this
+ * can drive items without going through the menu.
+ * args: slot (the item's position in the bag), target (who to use it on, ignored for self use items)
+ * outputs: whether the item got used. It won't be if there is no such slot or the item isn't ready
+ * */
+bool Adventurer::useItem(unsigned slot, Enemy* target){
+    if (slot >= inventory.size()) return false;
+    Item* item = inventory.at(slot);
+    if (!item->abilityAvailable() || (!item->isSelfUse() && target == nullptr)) return false;
+
+    item->ability(this, item->isSelfUse() ? nullptr : target);
+    // start ticking its cooldown if using it put it on one
+    itemCooldowns.track(item);
+    // if the item is consumable, use one up
+    if (item->isConsumable()){
+        itemCooldowns.release(item);
+        inventory.consume(slot);
+    }
+    return true;
+}
+
+/** Returns the item in a bag slot, or nullptr if there is no such slot. */
+Item* Adventurer::itemAt(unsigned slot) const {
+    return slot < inventory.size() ? inventory.at(slot) : nullptr;
+}
+
+/**
+ * setHint: gives the turn menu a way to advise the player, which shows up as an extra option. Pass nullptr to take it away again.
+ * args: advise (prints the advice)
+ * outputs: none
+ * */
+void Adventurer::setHint(std::function<void()> advise){
+    hint = advise;
+}
+
+/**
+ * setPreview: lets the turn menu show how each move looks to go next to it, while the preview works it out in the background.
+ * Pass nullptr to take it away again. The preview is stopped once the player settles on a move.
+ * args: look (the preview, owned by the caller)
+ * outputs: none
+ * */
+void Adventurer::setPreview(MovePreview* look){
+    preview = look;
+}
+
+/**
+ * previewNote: what the preview has to say about a move, ready to go at the end of a menu line.
+ * args: kind, index, target (the move, see CombatAction)
+ * outputs: the note, or an empty string if there is no preview or nothing is known yet
+ * */
+std::string Adventurer::previewNote(CombatAction::Kind kind, int index, int target) const {
+    if (preview == nullptr) return "";
+    CombatAction move;
+    move.kind = kind;
+    move.index = index;
+    move.target = target;
+    std::string note = preview->note(move);
+    return note.empty() ? "" : "\t(" + note + ")";
+}
+
+/**
+ * useAbility: runs an ability from the ability table and puts it on cooldown. No prompting or cooldown checks are done, 
+ * so check abilityReady() first. Use this to drive abilities without going through the menu.
+ * args: index (position in the ability table), targets (list of available targets), target (the picked target for single target abilities)
+ * outputs: none
+ * */
+void Adventurer::useAbility(int index, std::vector<Enemy*>& targets, Enemy* target){
+    const AbilityDef& def = abilityTable()[index];
+    (this->*def.effect)(targets, target);
+    abilityCD[index] = def.cooldown;
+}
+
+/**
+ * classState: writes out whatever a class keeps track of on top of the usual stats, for save files.
+ * The default has nothing to save. setClassState() reads it back in.
+ * args: state (CLASS_STATE_SIZE numbers to fill in)
+ * outputs: none
+ * */
+void Adventurer::classState(int* state) const {
+    for (int i = 0; i < CLASS_STATE_SIZE; ++i) state[i] = 0;
+}
+
+void Adventurer::setClassState(const int* /* state */){}
+
+/**
+ * abilityTable: the table of abilities this class has, in the order they show up in the menu. 
+ * args: none
+ * outputs: the ability table
+ * */
+const std::vector<AbilityDef>& Adventurer::abilityTable() const {
+    static const std::vector<AbilityDef> none;
+    return none;
+}
+
+/** Ability state checks. index is the ability's position in the ability table. */
+bool Adventurer::abilityUnlocked(int index) const {
+    return index >= 0 && index < (int)abilityTable().size() && level >= abilityTable()[index].unlockLevel;
+}
+
+bool Adventurer::abilityReady(int index) const {
+    return abilityUnlocked(index) && abilityCD[index] <= 0;
+}
+
+int Adventurer::getAbilityCooldown(int index) const {
+    return abilityCD[index];
+}
+
+/**
+ * readyAbilities: lists every ability that can be used right now. 
+ * args: none
+ * outputs: the positions of the ready abilities in the ability table
+ * */
+std::vector<int> Adventurer::readyAbilities() const {
+    std::vector<int> ready;
+    for (int i = 0; i < (int)abilityTable().size(); ++i){
+        if (abilityReady(i)) ready.push_back(i);
+    }
+    return ready;
+}
+
+/**
+ * updateCooldowns: reduces all cooldowns by 1 (if greater than 0)
  * Call this at the end of a turn.
  * args: none
  * outputs: none
  * */
 void Adventurer::updateCooldowns(){
-    if (abi1CD > 0) abi1CD--;
-    if (abi2CD > 0) abi2CD--;
-    if (abi3CD > 0) abi3CD--;
-    if (abi4CD > 0) abi4CD--;
-    if (abi5CD > 0) abi5CD--;
+    for (int i = 0; i < MAX_ABILITIES; ++i) abilityCD[i] -= (abilityCD[i] > 0);
+}
+
+/**
+ * updateItemCooldowns: reduces the cooldown of every item that is on one by 1.
+ * Only items that are actually recovering get looked at, so this is cheap no matter how big the bag is.
+ * Call this at the end of a turn, or when moving between rooms outside of combat.
+ * args: none
+ * outputs: none
+ * */
+void Adventurer::updateItemCooldowns(){
+    itemCooldowns.tick();
+}
+
+/** Returns how many items are currently on cooldown. */
+unsigned Adventurer::itemsOnCooldown() const {
+    return itemCooldowns.size();
+}
+
+/**
+ * captureCombatState(): copies out the character's stats, buffs, cooldowns, class resources and bag, see HeroState.
+ * args: none
+ * outputs: the state
+ * */
+HeroState Adventurer::captureCombatState() const {
+    HeroState state;
+    state.entity = captureState();
+    for (int i = 0; i < MAX_ABILITIES; ++i) state.abilityCD[i] = abilityCD[i];
+    classState(state.classState);
+    state.bag.reserve(inventory.slotCount());
+    for (unsigned i = 0; i < inventory.slotCount(); ++i){
+        Item* item = inventory.at(i);
+        state.bag.push_back(BagSlot{item->getID(), inventory.countAt(i), item->getCooldown(), item->saveState()});
+    }
+    return state;
+}
+
+/**
+ * restoreCombatState(): puts the character back the way they were when a state was captured.
+ * The bag is only rebuilt if its slots changed, e.g. because the last potion in one got used. Otherwise only cooldowns are reset.
+ * args: state (from captureCombatState()), make (makes an item from its ID, e.g. makeItem())
+ * outputs: none
+ * */
+void Adventurer::restoreCombatState(const HeroState& state, Item* (*make)(unsigned)){
+    restoreState(state.entity);
+    for (int i = 0; i < MAX_ABILITIES; ++i) abilityCD[i] = state.abilityCD[i];
+    setClassState(state.classState);
+
+    bool sameSlots = inventory.slotCount() == state.bag.size();
+    for (unsigned i = 0; sameSlots && i < state.bag.size(); ++i){
+        Item* item = inventory.at(i);
+        sameSlots = item->getID() == state.bag[i].id && inventory.countAt(i) == state.bag[i].count && item->saveState() == state.bag[i].state;
+    }
+    std::vector<int> cooldowns;
+    if (sameSlots){
+        for (const BagSlot& slot : state.bag) cooldowns.push_back(slot.cooldown);
+    }
+    else {
+        itemCooldowns.clear();
+        inventory.clear();
+        for (const BagSlot& slot : state.bag){
+            Item* item = make(slot.id);
+            if (item == nullptr) continue;
+            item->loadState(slot.state);
+            inventory.restore(item, slot.count);
+            cooldowns.push_back(slot.cooldown);
+        }
+    }
+    for (unsigned i = 0; i < inventory.slotCount(); ++i){
+        Item* item = inventory.at(i);
+        itemCooldowns.release(item);
+        item->setCooldown(cooldowns[i]);
+        itemCooldowns.track(item);
+    }
 }
 
 /**setHealth: used to set the user's health to a certain percentage.
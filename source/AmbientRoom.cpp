@@ -0,0 +1,67 @@
+#ifndef __AMBIENT_ROOM__
+#define __AMBIENT_ROOM__
+
+#include <iostream>
+#include <string>
+#include "./../headers/Room.hpp"
+
+/**
+ * AmbientText: the name and description of an ambient room. The text lives in AMBIENT_ROOM_TEXT and is shared by
+ * every room built from it.
+ * */
+struct AmbientText {
+    const char* name;
+    const char* description;
+};
+
+// IDs 35001 onwards, in order
+const AmbientText AMBIENT_ROOM_TEXT[] = {
+    {"A room with a tree","This room has a small tree growing from the cracked earth.\nYou're not quite sure how it is surviving, but you quietly cheer it on."},
+    {"A stone hallway","Your footsteps echo as you walk down this stone corridor.\nIt's a bit too quiet... you check behind yourself just to make sure, but you're safe."},
+    {"A meadow","You wander into a calm meadow. It feels out of place, but the spot of tranquility nevertheless is appreciated."},
+    {"A small lake","To call this a lake is an overstatement... more like a small pool of murky water.\nYou aren't even close to thirsty enough to drink from it."},
+    {"A room of grey sand","The ground beneath your feet crumbles, and you realize it is sand. A small, broken rake lies in the rubble.\nWas this a zen garden of some kind?"},
+    {"A cave","You hear water droplets echo through this small cave, dripping from a stalactite nearby.\nYou cautiously hold your hand out and taste it."},
+    {"An abandoned forge","The remains of a forge lay scattered around this room. It seems like it hasn't seen activitiy in years."},
+    {"A stone hallway","Your footsteps echo as you walk down--- ECKPTH!! You walked into a spiderweb!!"},
+    {"A well-lit hall","This hallway has several torches bolted into their brackets.\nSome are extinguished, but the rest pleasantly light the way."},
+    {"A stone hallway","Your footsteps echo as you walk down the stone corridor. You hear the click of a pressure plate...\nbut nothing happens. You breathe a sigh of relief for outdated tech."},
+    {"A wooden bridge","You make your way to a narrow chasm with planks of wood percariously bridging the gap.\nYou take extreme caution, but you make it across without issue."}
+};
+
+const unsigned AMBIENT_ROOM_COUNT = sizeof(AMBIENT_ROOM_TEXT) / sizeof(AMBIENT_ROOM_TEXT[0]);
+
+//ID 35001 - 35011
+class AmbientRoom : public Room{
+private:
+    unsigned short text; // index into AMBIENT_ROOM_TEXT
+
+public:
+    /**
+     * Constructor
+     * args: id (the factory ID of the room, 35001 onwards)
+     * */
+    AmbientRoom(unsigned id){
+        text = id - 35001;
+    }
+
+    /** Returns true if a factory ID belongs to an ambient room. */
+    static bool isAmbient(unsigned id){
+        return id > 35000 && id <= 35000 + AMBIENT_ROOM_COUNT;
+    }
+
+    /** Gets the name of an ambient room from its factory ID, without building one. */
+    static std::string nameOf(unsigned id){
+        return AMBIENT_ROOM_TEXT[id - 35001].name;
+    }
+
+    std::string getName(){
+        return AMBIENT_ROOM_TEXT[text].name;
+    }
+
+    void printDescription(){
+        std::cout << AMBIENT_ROOM_TEXT[text].description << "\n";
+    }
+};
+
+#endif
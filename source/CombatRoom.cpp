@@ -5,18 +5,132 @@
 #include <string>
 #include <vector>
 #include <math.h>
+#include <sstream>
+#include <algorithm>
+#include <memory>
 #include "./../headers/Room.hpp"
 #include "./../headers/Entity.hpp"
 #include "./Enemy.cpp"
+#include "./../headers/Factory.hpp"
+#include "./../headers/CombatSnapshot.hpp"
 
 const int TURN_BAR_LENGTH = 34;
 const int MAX_TURN_BAR = 1000;
 
+inline void adviseTurn(Adventurer* hero, const std::vector<Enemy*>& foes); // see CombatSearch.hpp
+inline MovePreview* previewTurn(Adventurer* hero, const std::vector<Enemy*>& foes); // see TurnPreview.hpp
+
 class CombatRoom : public Room{
 private:
     std::vector<Enemy*> entities;
+    std::vector<Adventurer*> fighters; // party members still standing in the current fight
     bool combatDone = false;
+    bool practice = false; // see setPractice()
     std::string combatDoneDescription;
+    CombatSnapshot opening; // in practice, the fight before anyone moved
+    std::vector<CombatSnapshot> history; // in practice, the fight at the start of every round the party got to act in
+
+    /**
+     * collectFallen: removes any dead enemies from the fight and adds their gold/xp and drops to the running totals.
+     * args: tally (the running totals)
+     * outputs: none
+     * */
+    void collectFallen(CombatTally& tally){
+        std::vector<Enemy*>::iterator iter;
+        for (iter = entities.begin(); iter != entities.end(); /* nothing */ ) {
+            if (!(*iter)->isAlive()){
+                std::cout << (*iter)->getDeathMessage() << "\n";
+                tally.goldReward += (*iter)->getGoldReward();
+                tally.expReward += (*iter)->getExpReward();
+                unsigned drop = (*iter)->rollDrop();
+                if (drop != 0) tally.drops.push_back(drop);
+                delete (*iter);
+                iter = entities.erase(iter);
+            }
+            else ++iter;
+        }
+    }
+
+    /**
+     * handOutDrops: gives the items dropped during the fight to the standing party members, taking turns.
+     * args: drops (IDs of the dropped items)
+     * outputs: none
+     * */
+    void handOutDrops(const std::vector<unsigned>& drops){
+        ItemFactory items;
+        for (unsigned i = 0; i < drops.size(); ++i){
+            Adventurer* receiver = fighters[i % fighters.size()];
+            Item* item = items.generate(drops[i]);
+            if (party.size() == 1) std::cout << "You found " << item->getName() << ".\n";
+            else std::cout << receiver->getName() << " found " << item->getName() << ".\n";
+            receiver->addItem(item);
+        }
+    }
+
+    /**
+     * removeFallenMembers: drops any party members that died from the list of fighters.
+     * args: none
+     * outputs: none
+     * */
+    void removeFallenMembers(){
+        std::vector<Adventurer*>::iterator iter;
+        for (iter = fighters.begin(); iter != fighters.end(); /* nothing */ ) {
+            if (!(*iter)->isAlive()){
+                if (party.size() > 1) std::cout << (*iter)->getName() << " has fallen!\n";
+                iter = fighters.erase(iter);
+            }
+            else ++iter;
+        }
+    }
+
+    /**
+     * pickTarget: picks which party member an enemy goes after. Currently a random member that is still standing.
+     * args: none
+     * outputs: a pointer to the targeted adventurer
+     * */
+    Adventurer* pickTarget(){
+        if (fighters.size() == 1) return fighters.front();
+        return fighters[roll(fighters.size())];
+    }
+
+    /**
+     * offerUndo: in practice, asks the party whether to go on or take back their last round.
+     * args: tally (the running totals, put back along with everything else)
+     * outputs: true if the fight was taken back, in which case the round has to start over
+     * */
+    bool offerUndo(CombatTally& tally){
+        if (history.size() < 2) return false;
+        std::cout << "1:\tGo on\n"
+                  << "2:\tTake back your last turn (" << history.size() - 1 << " left)\n";
+        int choices[]{1, 2};
+        InputReader reader;
+        if (reader.readInput(choices, 2) == 1) return false;
+        history.pop_back();
+        history.back().restore(party, entities, tally);
+        history.pop_back(); // it is taken again when the round replays
+        fighters.clear();
+        for (auto member : party){
+            if (member->isAlive()) fighters.push_back(member);
+        }
+        std::cout << "You take a breath and think it over again.\n";
+        return true;
+    }
+
+    /**
+     * turnBarLine: builds a single line of the turn bar display for an entity.
+     * args: e (the entity to display)
+     * outputs: the formatted line, including the trailing newline
+     * */
+    std::string turnBarLine(Entity* e){
+        std::ostringstream line;
+        int filled = floor((double)std::min(e->getTurnBar(), MAX_TURN_BAR) / MAX_TURN_BAR * TURN_BAR_LENGTH);
+        line << resize(e->getName(), 16) << " (" << e->getTurnBar() / 10 << "%)\t["
+             << std::string(filled, '-') << "o" << std::string(TURN_BAR_LENGTH - filled, '-')
+             << "] (" << e->getCurrentHealth() << "/" << e->getMaxHealth() << ")\t";
+        e->displayBuffs(line);
+        line << "\n";
+        return line.str();
+    }
 
 public:
     CombatRoom(std::string name, std::string description, std::string combatDoneDescription) : Room(name, description){
@@ -30,7 +144,9 @@ public:
 
     /**
      * interact: Combat method. 
-     * This is where combat is handled. more details to come when entity is finished
+     * This is where combat is handled. Every linked party member that is still alive joins the fight and 
+     * takes their own turns off the shared turn bar. Enemies pick a random standing member to attack. 
+     * Rewards are split evenly between the members that are still standing at the end. 
      * args: none
      * outputs: none
      * */
@@ -39,101 +155,146 @@ public:
         if (!combatDone){
             printDescription();
 
-            player->initializeOrigStats();
+            startCombat();
+            std::vector<Adventurer*> joined = fighters; // whoever was standing when it started, anyone who fell before isn't penalized again
             for (auto e : entities) e->initializeOrigStats();
 
-            int goldReward = 0, expReward = 0, turn = 1;
+            CombatTally tally;
+            history.clear();
+            CombatSnapshot before;
+            if (practice) opening = CombatSnapshot::take(party, entities, tally);
             while (!combatOver()){
+                if (practice) before = CombatSnapshot::take(party, entities, tally, history.empty() ? &opening : &history.back());
                 updateTurn();
                 printTurnBar();
                 
-                // execute player turn, if it is their turn
-                if (player->getTurnBar() >= MAX_TURN_BAR){
-                    std::cout << "================================[TURN " << turn << "]===============================\n";
-                    player->printSpecialFeature();
-                    player->turn(entities);
-                    player->updateBuffs();
-                    player->setTurnBar(player->getTurnBar() - MAX_TURN_BAR);
-                    std::cout << "================================[TURN " << turn << "]===============================\n";
-                    turn++;
-                }
+                // execute the turn of every party member whose bar is full
+                bool undone = false;
+                for (unsigned i = 0; i < fighters.size() && !entities.empty() && !undone; ++i){
+                    Adventurer* member = fighters[i];
+                    if (member->getTurnBar() >= MAX_TURN_BAR){
+                        if (practice && !before.empty()){
+                            history.push_back(before);
+                            before = CombatSnapshot();
+                            if ((undone = offerUndo(tally))) break;
+                        }
+                        std::cout << "================================[TURN " << tally.turn << "]===============================\n";
+                        if (party.size() > 1) std::cout << member->getName() << "'s turn.\n";
+                        member->printSpecialFeature();
+                        std::unique_ptr<MovePreview> preview(previewTurn(member, entities));
+                        member->setHint([this, member](){ adviseTurn(member, entities); });
+                        member->setPreview(preview.get());
+                        member->turn(entities);
+                        member->setHint(nullptr);
+                        member->setPreview(nullptr);
+                        preview.reset();
+                        member->updateBuffs();
+                        member->setTurnBar(member->getTurnBar() - MAX_TURN_BAR);
+                        std::cout << "================================[TURN " << tally.turn << "]===============================\n";
+                        tally.turn++;
 
-                // check if anything died, remove them from the vector if so and accumulate gold/xp reward
-                std::vector<Enemy*>::iterator iter;
-                for (iter = entities.begin(); iter != entities.end(); /* nothing */ ) {
-                    if (!(*iter)->isAlive()){
-                        std::cout << (*iter)->getDeathMessage() << "\n";
-                        goldReward += (*iter)->getGoldReward();
-                        expReward += (*iter)->getExpReward();
-                        delete (*iter);
-                        iter = entities.erase(iter);
+                        // check if anything died, remove them from the vector if so and accumulate gold/xp reward
+                        collectFallen(tally);
                     }
-                    else ++iter;
                 }
+                if (undone) continue;
+                removeFallenMembers(); // in case someone managed to take themselves out
 
                 // execute any enemy turns
                 for (auto e : entities){
+                    if (fighters.empty()) break;
                     if (e->getTurnBar() >= MAX_TURN_BAR){
-                        e->turn(player);
+                        e->turn(pickTarget());
                         e->updateBuffs();
                         e->setTurnBar(e->getTurnBar() - MAX_TURN_BAR);
+                        removeFallenMembers();
                     }
                 }
             }
 
-            // if the player won the combat
-            if (player->isAlive()){
-                std::cout << "You receive " << goldReward << " gold and " << expReward << " experience.\n";
-                player->addGold(goldReward);
-                player->addExp(expReward);
-                combatDone = true; //we don't set this to true if the player died. they can return?
-                player->clearBuffs();
+            if (practice){
+                std::cout << (fighters.empty() ? "You're knocked flat. " : "The last dummy goes down. ")
+                          << "The trainer calls the bout, and patches you up as good as new.\n";
+                CombatDice rolled = combatDice();
+                opening.restore(party, entities, tally); // practice never costs or earns anything
+                combatDice() = rolled; // but the dice carry on, or the next real fight would roll what the bout just did
+                for (auto member : party) member->clearBuffs();
+                history.clear();
+                combatDone = true;
+            }
+            // if anyone in the party won the combat
+            else if (!fighters.empty()){
+                if (party.size() == 1){
+                    std::cout << "You receive " << tally.goldReward << " gold and " << tally.expReward << " experience.\n";
+                } else {
+                    std::cout << "The party receives " << tally.goldReward << " gold and " << tally.expReward << " experience, split between "
+                              << fighters.size() << " standing member(s).\n";
+                }
+                for (unsigned i = 0; i < fighters.size(); ++i){
+                    // the leftovers of an uneven split go to whoever is first in line
+                    fighters[i]->addGold(tally.goldReward / fighters.size() + (i == 0 ? tally.goldReward % fighters.size() : 0));
+                    fighters[i]->addExp(tally.expReward / fighters.size() + (i == 0 ? tally.expReward % fighters.size() : 0));
+                }
+                handOutDrops(tally.drops);
+                combatDone = true; //we don't set this to true if the party died. they can return?
+                for (auto member : party) member->clearBuffs();
+                for (auto member : joined){
+                    if (!member->isAlive()) member->deathPenalty();
+                }
             } else {
-                std::cout << "You died.\n";
+                std::cout << (party.size() == 1 ? "You died.\n" : "Your party has been wiped out.\n");
                 end = true;
-                player->deathPenalty();
+                for (auto member : joined) member->deathPenalty();
             }
         } else {
             std::cout << combatDoneDescription << "\n";
         }
     }
 
+    /**
+     * setPractice: makes this a practice fight. The party can take back their turns, and once the fight is over, won or
+     * lost, everyone is put back the way they came in. Nothing is earned and nobody is penalized.
+     * args: on (whether this is practice)
+     * outputs: none
+     * */
+    void setPractice(bool on){
+        practice = on;
+    }
+
+    bool isPractice() const {
+        return practice;
+    }
+
+    /**
+     * startCombat: gathers every linked party member that is still alive into the fight.
+     * interact() calls this, only call it yourself if you are driving the combat manually. 
+     * args: none
+     * outputs: none
+     * */
+    void startCombat(){
+        fighters.clear();
+        for (auto member : party){
+            if (member->isAlive()){
+                member->initializeOrigStats();
+                fighters.push_back(member);
+            }
+        }
+    }
+
     /**
      * printTurnBar: Prints out the current state of the turn bar and all entities' position on the turn bar. 
+     * The whole display is built up first and written out in one go. 
      * args: none
      * outputs: none
      * */
     void printTurnBar(){
-        // print header
-        std::cout << "NAME\t\t\t00%-----25%------50%------75%-----100%\n"
-                         "\t\t\t[        |        |        |        ]\n";
+        std::string display = "NAME\t\t\t00%-----25%------50%------75%-----100%\n"
+                              "\t\t\t[        |        |        |        ]\n";
         
-        // print adventurer info
-        std::string tempName = player->getName();
-        std::cout << resize(tempName, 16) << " (" << player->getTurnBar() / 10 << "%)\t[";
-        for (int k = 0; k < floor((double)std::min(player->getTurnBar(), MAX_TURN_BAR) / MAX_TURN_BAR * TURN_BAR_LENGTH); ++k) std::cout << "-";
-        std::cout << "o";
-        for (int k = 0; k < TURN_BAR_LENGTH - floor((double)std::min(player->getTurnBar(), MAX_TURN_BAR) / MAX_TURN_BAR * TURN_BAR_LENGTH); ++k) std::cout << "-";
-        std::cout << "] (" << player->getCurrentHealth() << "/" << player->getMaxHealth() << ")\t";
-        player->displayBuffs();
-        std::cout << "\n";
-
-        // print enemy info
-        for (auto e : entities){
-            // print name
-            tempName = e->getName();
-            // print turn percentage
-            std::cout << resize(tempName, 16) << " (" << e->getTurnBar() / 10 << "%)\t[";
-            // print turn bar
-            for (int k = 0; k < floor((double)std::min(e->getTurnBar(), MAX_TURN_BAR) / MAX_TURN_BAR * TURN_BAR_LENGTH); ++k) std::cout << "-";
-            std::cout << "o";
-            for (int k = 0; k < TURN_BAR_LENGTH - floor((double)std::min(e->getTurnBar(), MAX_TURN_BAR) / MAX_TURN_BAR * TURN_BAR_LENGTH); ++k) std::cout << "-";
-            // print health
-            std::cout << "] (" << e->getCurrentHealth() << "/" << e->getMaxHealth() << ")\t";
-            // print buffs
-            e->displayBuffs();
-            std::cout << "\n";
-        }
+        // adventurer info, then enemy info
+        for (auto member : fighters) display += turnBarLine(member);
+        for (auto e : entities) display += turnBarLine(e);
+        std::cout << display;
     }
 
     /**
@@ -145,44 +306,60 @@ public:
         entities.push_back(e);
     }
 
+    /** Returns the enemies still in the room. The room owns them. */
+    const std::vector<Enemy*>& getEnemies() const {
+        return entities;
+    }
+
     /**
      * updateTurn: This method updates the action bars of all entities currently engaged in combat until one of them reaches 100% turn bar. 
      * 100% turn bar is denoted by an integer value.
+     * Rather than ticking everyone one step at a time, this works out how many ticks it takes for the first entity 
+     * to fill its bar and advances everyone by that many ticks at once. At least one tick always passes. 
      * args: none
      * outputs: none
      * */
     void updateTurn(){
-        // go through and find if someone is above max turn bar. reset them to zero if so
-        // for (auto e : entities){
-        //     if (e->getTurnBar() >= MAX_TURN_BAR) e->setTurnBar(0);
-        // }
-
-        // if (player->getTurnBar() >= MAX_TURN_BAR) player->setTurnBar(0);
-
-        // loop through all entities and update their turn bars until somebody reaches maximum. 
-        bool reachedEnd = false;
-        while (!reachedEnd){
-            player->addTurnBar(player->getSpeed());
-            if (player->getTurnBar() >= MAX_TURN_BAR) reachedEnd = true;
-
-            for (auto e : entities){
-                if (e->isAlive()){
-                    e->addTurnBar(e->getSpeed());
-                    if (e->getTurnBar() >= MAX_TURN_BAR) reachedEnd = true;
-                }
-            }
+        int ticks = 0;
+        for (auto member : fighters) ticks = fewerTicks(ticks, ticksToFill(member));
+        for (auto e : entities){
+            if (e->isAlive()) ticks = fewerTicks(ticks, ticksToFill(e));
+        }
+        if (ticks <= 0) ticks = 1;
+
+        for (auto member : fighters) member->addTurnBar(member->getSpeed() * ticks);
+        for (auto e : entities){
+            if (e->isAlive()) e->addTurnBar(e->getSpeed() * ticks);
         }
     }
 
+    /**
+     * ticksToFill: how many ticks it takes for an entity to reach 100% turn bar. At least 1. 
+     * args: e (the entity to check)
+     * outputs: the number of ticks, or 0 if the entity can't move at all
+     * */
+    static int ticksToFill(Entity* e){
+        if (e->getSpeed() <= 0) return 0;
+        int needed = MAX_TURN_BAR - e->getTurnBar();
+        if (needed <= 0) return 1;
+        return (needed + e->getSpeed() - 1) / e->getSpeed();
+    }
+
+    /** Picks the smaller of two tick counts, where 0 means "never". */
+    static int fewerTicks(int a, int b){
+        if (a <= 0) return b;
+        if (b <= 0) return a;
+        return std::min(a, b);
+    }
+
     /**
      * combatOver: checks if combat is done
-     * Goes through all entities and checks if their health is higher than zero. 
-     * Entities vector should never be empty when calling this method. 
+     * Combat is over once every party member has fallen or every enemy is dead. 
      * args: none
      * outputs: whether or not combat is over
      * */
     bool combatOver(){
-        if (player->getCurrentHealth() < 0) return true;
+        if (fighters.empty()) return true;
 
         bool over = true;
         for (auto e: entities){ // check if each enemy is alive
@@ -193,4 +370,8 @@ public:
     }
 };
 
+// these play fights out through CombatRoom, so they can only come in once the room is defined
+#include "./../headers/CombatSearch.hpp"
+#include "./../headers/TurnPreview.hpp"
+
 #endif
@@ -0,0 +1,292 @@
+#ifndef __ENDLESS_QUEST_CPP__
+#define __ENDLESS_QUEST_CPP__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include "./Quest.cpp"
+#include "./../headers/Dice.hpp"
+
+// how many passages a floor can have at most, and how many floors get built ahead of the player
+const unsigned ENDLESS_LANES = 3;
+const unsigned ENDLESS_AHEAD = 3;
+// the most enemies a single fight can grow to
+const unsigned ENDLESS_MAX_FIGHT = 8;
+
+/**
+ * SurfaceRoom: where an endless run ends if the player walks out on their own. It sums up the run as the player arrives.
+ * */
+class SurfaceRoom : public Room {
+private:
+    const unsigned* deepest;
+
+public:
+    SurfaceRoom(const unsigned* deepest) : Room("Climb back up to town", "You climb the long stairs back up to daylight.") {
+        this->deepest = deepest;
+        setEnd();
+    }
+
+    void interact(){
+        printDescription();
+        std::cout << "You made it back from floor " << *deepest << " of the Depths.\n";
+    }
+};
+
+/**
+ * EndlessQuest: a descent that keeps going until the player dies or climbs back out.
+ * Every floor has one to ENDLESS_LANES passages and each of them leads down to every passage of the next floor.
+ * Room indices are floor * ENDLESS_LANES + passage. There is no way back up besides leaving, so once the player picks a
+ * passage the rest of the floor and the floor above can never be reached again and get freed right away.
+ * A worker thread keeps the next ENDLESS_AHEAD floors built, so walking down never waits on generation and
+ * memory stays the same however deep a run goes.
+ * Each floor only depends on the run's seed and its depth: its rooms, its enemies' stats and the rolls its oddities make.
+ * Deeper floors use a higher encounter level and bigger fights, every fifth floor is all fights, and the biome changes every
+ * ten floors.
+ * */
+class EndlessQuest : public Quest {
+private:
+    struct Floor {
+        unsigned depth;
+        std::vector<Room*> lanes;
+    };
+
+    unsigned seed;
+    int startLevel;
+    unsigned startBiome;
+
+    Floor current; // the floor the player is on, only touched by the player's thread
+    unsigned deepest = 0;
+    SurfaceRoom* surface;
+
+    std::deque<Floor> ready; // floors built ahead, in order. shared with the worker
+    unsigned nextDepth = 1; // the next floor the worker builds
+    bool stopping = false;
+    std::mutex lock;
+    std::condition_variable built, wanted;
+    std::thread worker;
+
+    /** Runs on the worker thread. Keeps building floors until ENDLESS_AHEAD are waiting, then sleeps until one is taken. */
+    void fill() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (!stopping) {
+            if (ready.size() >= ENDLESS_AHEAD) {
+                wanted.wait(guard);
+                continue;
+            }
+            unsigned depth = nextDepth++;
+            guard.unlock();
+            Floor floor = buildFloor(depth);
+            guard.lock();
+            ready.push_back(floor);
+            built.notify_all();
+        }
+    }
+
+    /** Waits for the floor below the player to be ready. Usually it has been for a while. */
+    const Floor& upcoming() {
+        std::unique_lock<std::mutex> guard(lock);
+        built.wait(guard, [this]{ return !ready.empty(); });
+        return ready.front();
+    }
+
+    const Biome& biomeAt(unsigned depth) const {
+        return biomeCatalog()[(startBiome + depth / 10) % biomeCatalog().size()];
+    }
+
+    /**
+     * buildFloor(): builds every room on a floor along with its enemies. Safe to call from the worker, it only reads
+     * the run's settings and the catalogues.
+     * args: depth (the floor)
+     * outputs: the floor. Whoever takes it owns the rooms
+     * */
+    Floor buildFloor(unsigned depth) const {
+        std::seed_seq seq{seed, depth};
+        std::mt19937 rng(seq);
+        spawnDice().seed(rng()); // enemies roll their stats on the building thread's spawnDice()
+        const Biome& biome = biomeAt(depth);
+        int level = levelAt(depth);
+        RoomFactory rooms;
+        EnemyFactory enemies;
+
+        Floor floor;
+        floor.depth = depth;
+        unsigned lanes = 1 + rng() % ENDLESS_LANES;
+        for (unsigned i = 0; i < lanes; ++i) {
+            unsigned roll = rng() % 20;
+            if (depth % 5 == 0 || roll < 10) {
+                CombatRoom* fight = depth % 5 == 0
+                    ? new CombatRoom("Guarded stairs","Something big is waiting at the bottom of the stairs, and it isn't letting you past!","The way further down is clear.")
+                    : new CombatRoom("Arena","You enter a small room and are ambushed by enemies!","With the enemies slain, you can carry on.");
+                unsigned fewest = biome.layout.arenaMin + depth / 5;
+                unsigned count = std::min(ENDLESS_MAX_FIGHT, fewest + (unsigned)(rng() % (biome.layout.arenaMax - biome.layout.arenaMin + 1)));
+                for (unsigned e = 0; e < count; ++e) fight->addEnemy(enemies.generate(biome.enemies.sample(level, rng)));
+                floor.lanes.push_back(fight);
+            }
+            else if (roll < 17) floor.lanes.push_back(rooms.generate(biome.ambientRooms.sample(level, rng)));
+            else {
+                unsigned id = biome.oddityRooms.sample(level, rng);
+                floor.lanes.push_back(rooms.generate(id, rng()));
+            }
+        }
+        return floor;
+    }
+
+    static void release(Floor& floor) {
+        for (unsigned i = 0; i < floor.lanes.size(); ++i) delete floor.lanes[i];
+        floor.lanes.clear();
+    }
+
+public:
+    /**
+     * EndlessQuest(): starts a run. The first floors start building straight away.
+     * args: r (the reward for every floor reached), level (the level of the player taking the run)
+     * */
+    EndlessQuest(unsigned int r, int level) : EndlessQuest(r, level, rand()) {}
+
+    /** This is a version of the above constructor that takes the run's seed. The same seed always gives the same floors. */
+    EndlessQuest(unsigned int r, int level, unsigned seed) : Quest(r, "Descend as far as you dare into the Depths") {
+        this->seed = seed;
+        startLevel = level;
+        startBiome = seed % biomeCatalog().size();
+        surface = new SurfaceRoom(&deepest);
+        current.depth = 0;
+        current.lanes.push_back(new Room("The top of the stairs","A stairway winds down into the dark. Nobody has ever found the bottom."));
+        worker = std::thread(&EndlessQuest::fill, this);
+    }
+
+    ~EndlessQuest() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wanted.notify_all();
+        worker.join();
+        release(current);
+        for (unsigned i = 0; i < ready.size(); ++i) release(ready[i]);
+        delete surface;
+    }
+
+    /** Returns the encounter level used on a floor. */
+    int levelAt(unsigned depth) const {
+        return std::min(LEVEL_CAP, startLevel + (int)(depth / 3));
+    }
+
+    /** Returns how many rooms are currently held, the player's floor plus everything built ahead. */
+    unsigned roomsHeld() {
+        std::lock_guard<std::mutex> guard(lock);
+        unsigned held = 0;
+        for (unsigned i = 0; i < current.lanes.size(); ++i) held += current.lanes[i] != nullptr;
+        for (unsigned i = 0; i < ready.size(); ++i) held += ready[i].lanes.size();
+        return held;
+    }
+
+    /** Returns the deepest floor reached so far. */
+    unsigned getDepth() const {
+        return deepest;
+    }
+
+    using Quest::linkPlayers;
+
+    void linkPlayers(const std::vector<Adventurer*>& party) {
+        this->party = party;
+        surface->linkParty(party);
+        for (unsigned i = 0; i < current.lanes.size(); ++i) {
+            if (current.lanes[i] != nullptr) current.lanes[i]->linkParty(party);
+        }
+    }
+
+    unsigned start() const {
+        return 0;
+    }
+
+    /** Every room can only be walked into once, the way is always down. */
+    bool firstVisit(unsigned /* index */) {
+        return true;
+    }
+
+    /**
+     * enter(): walks into a room on the player's floor or the one below. Going down a floor swaps in the next built floor,
+     * frees the one above, and frees every passage on the new floor besides the one taken.
+     * args: index (the room)
+     * outputs: the room
+     * */
+    Room* enter(unsigned index) {
+        if (index == NO_ROOM - 1) return surface;
+        unsigned depth = index / ENDLESS_LANES, lane = index % ENDLESS_LANES;
+        if (depth == current.depth + 1) {
+            upcoming();
+            Floor below;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                below = ready.front();
+                ready.pop_front();
+            }
+            wanted.notify_all();
+            release(current);
+            current = below;
+            deepest = current.depth;
+        }
+        for (unsigned i = 0; i < current.lanes.size(); ++i) {
+            if (i == lane) continue;
+            delete current.lanes[i];
+            current.lanes[i] = nullptr;
+        }
+        current.lanes[lane]->linkParty(party);
+        return current.lanes[lane];
+    }
+
+    /** Climbing out already sums the run up, so the surface isn't played again. */
+    bool replaysEnd(unsigned index) const {
+        return index != NO_ROOM - 1;
+    }
+
+    /** A run can't start partway down, floors are only ever built on the way there. */
+    bool resumable() const {
+        return false;
+    }
+
+    /** Nothing to do here, rooms get freed as soon as they can't be reached. */
+    void leave(unsigned /* index */) {}
+
+    void printExits(unsigned /* index */) {
+        const Floor& below = upcoming();
+        std::cout << "Stairs lead down to floor " << below.depth << ". Available exits: \n";
+        for (unsigned i = 0; i < below.lanes.size(); ++i) {
+            std::cout << i + 1 << ":\t" << below.lanes[i]->getName() << "\n";
+        }
+        std::cout << "0:\t" << surface->getName() << "\n";
+    }
+
+    /**
+     * exitTo(): works out where an exit label leads. Labels 1 and up pick a passage on the floor below, 0 climbs back out.
+     * The labels go into the room's exit index (see Room::exitId()) the first time the player looks for a way out of it.
+     * args: index (the room the player is in, always on their floor), label (the label they typed)
+     * outputs: the room the exit leads to, or NO_ROOM if there's no such exit
+     * */
+    unsigned exitTo(unsigned index, const std::string& label) {
+        Room* room = current.lanes[index % ENDLESS_LANES];
+        if (index / ENDLESS_LANES != current.depth || room == nullptr) return NO_ROOM;
+        const Floor& below = upcoming();
+        if (room->exitCount() == 0) {
+            for (unsigned i = 0; i < below.lanes.size(); ++i) room->addExitLabel(std::to_string(i + 1));
+            room->addExitLabel("0");
+        }
+        unsigned k = room->exitId(label);
+        if (k == Room::NO_EXIT) return NO_ROOM;
+        if (k == below.lanes.size()) return NO_ROOM - 1;
+        return below.depth * ENDLESS_LANES + k;
+    }
+
+    /** The reward is paid for every floor reached. */
+    int getReward() {
+        return Quest::getReward() * deepest;
+    }
+};
+
+#endif
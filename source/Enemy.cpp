@@ -2,11 +2,29 @@
 #include <string>
 #include <vector>
 #include "./../headers/Entity.hpp"
+#include "./../headers/Loot.hpp"
+#include "./../headers/Dice.hpp"
 #pragma once
 
+/**
+ * EnemyState: an enemy as it stood at some point in a fight, enough to make it again (see EnemyFactory).
+ * */
+struct EnemyState {
+    unsigned id;
+    EntityState entity;
+    int goldReward, expReward;
+    bool boss;
+
+    bool operator==(const EnemyState& other) const {
+        return id == other.id && entity == other.entity && goldReward == other.goldReward
+            && expReward == other.expReward && boss == other.boss;
+    }
+};
+
 class Enemy : public Entity{
 protected:
     int goldReward, expReward;
+    bool boss = false;
 
 public:
     Enemy(){
@@ -22,6 +40,62 @@ public:
         return expReward;
     }
 
+    /** Bosses roll on their boss loot table instead of the normal one. */
+    void setBoss(bool boss){
+        this->boss = boss;
+    }
+
+    bool isBoss(){
+        return boss;
+    }
+
+    /** Copies out everything about this enemy that can change, see EnemyState. */
+    EnemyState captureEnemyState() const {
+        return EnemyState{ID, captureState(), goldReward, expReward, boss};
+    }
+
+    /** Puts an enemy back the way it was. It has to be the same kind of enemy. */
+    void restoreEnemyState(const EnemyState& state){
+        restoreState(state.entity);
+        goldReward = state.goldReward;
+        expReward = state.expReward;
+        boss = state.boss;
+    }
+
+    /**
+     * lootTable(): what this enemy can drop when it dies. Enemies with nothing worth taking use the default, which never drops anything.
+     * Override this with a static table so it only gets built once.
+     * args: none
+     * outputs: the enemy's loot table
+     * */
+    virtual const LootTable& lootTable() const {
+        static const LootTable nothing({}, 1);
+        return nothing;
+    }
+
+    /**
+     * bossLootTable(): what this enemy drops when it is the target of a quest. Bosses always drop something.
+     * The default is shared by every enemy that doesn't have its own.
+     * args: none
+     * outputs: the enemy's boss loot table
+     * */
+    virtual const LootTable& bossLootTable() const {
+        static const LootTable table({
+            {20005, Uncommon, 20}, {20006, Rare, 20}, {20007, Epic, 20}, {20002, Rare, 20},
+            {20008, Uncommon, 20}, {20009, Rare, 20}, {20016, Legendary, 20}
+        }, 0);
+        return table;
+    }
+
+    /**
+     * rollDrop(): rolls this enemy's loot table. Call this once when it dies.
+     * args: none
+     * outputs: the ID of the dropped item, or 0 if it didn't drop anything
+     * */
+    unsigned rollDrop() const {
+        return boss ? bossLootTable().roll() : lootTable().roll();
+    }
+
     /**turn(): The master method for determining behavior of this monster during each of its turns.
      * This method takes in a vector of entities (adventurers) and uses that to select a valid target.
      * args: std::vector<Entity> targetList: the list of available targets
@@ -56,12 +130,22 @@ public:
         physDef = 10;
         magAtk = 2;
         magDef = 30;
-        speed = 75 + rand() % 10 - 5;
+        speed = 75 + (int)(spawnDice()() % 10) - 5;
         ID = 10001;
     }
 
+    const LootTable& lootTable() const {
+        static const LootTable table({{20001, Common, 10}, {20004, Common, 10}}, 80);
+        return table;
+    }
+
+    const LootTable& bossLootTable() const {
+        static const LootTable table({{20001, Common, 30}, {20002, Rare, 40}, {20006, Rare, 30}}, 0);
+        return table;
+    }
+
     void turn(Entity* target){
-        std::cout << "The skeleton flails its arms at " << target->getName() << ". It deals " << target->dealPDamage(physAtk) << " damage.\n";
+        gameOut() << "The skeleton flails its arms at " << target->getName() << ". It deals " << target->dealPDamage(physAtk) << " damage.\n";
     }
 };
 
@@ -79,12 +163,22 @@ public:
         physDef = 20;
         magAtk = 2;
         magDef = 10;
-        speed = 125 + rand() % 10 - 5;
+        speed = 125 + (int)(spawnDice()() % 10) - 5;
         ID = 10002;
     }
 
+    const LootTable& lootTable() const {
+        static const LootTable table({{20004, Common, 10}, {20015, Common, 5}}, 85);
+        return table;
+    }
+
+    const LootTable& bossLootTable() const {
+        static const LootTable table({{20005, Uncommon, 40}, {20008, Uncommon, 30}, {20015, Common, 10}}, 0);
+        return table;
+    }
+
     void turn(Entity* target){
-        std::cout << "The rat bites " << target->getName() << ". It deals " << target->dealPDamage(physAtk) << " damage.\n";
+        gameOut() << "The rat bites " << target->getName() << ". It deals " << target->dealPDamage(physAtk) << " damage.\n";
     }
 };
 
@@ -102,7 +196,7 @@ public:
         physDef = 25;
         magAtk = 0;
         magDef = 25;
-        speed = 75 + rand() % 10 - 5;
+        speed = 75 + (int)(spawnDice()() % 10) - 5;
         ID = 10003;
     }
 
@@ -117,31 +211,41 @@ public:
                 pDefBuff += duration; 
             } break;
             case MAG_ATK:{
-                std::cout << "The grow slime shakes off the debuff.\n";
+                gameOut() << "The grow slime shakes off the debuff.\n";
             } break;
             case MAG_DEF:{
                 if (mDefBuff == 0) mDefOrig = magDef;
                 mDefBuff += duration; 
             } break;
             case SPEED:{
-                std::cout << "The grow slime shakes off the debuff.\n";
+                gameOut() << "The grow slime shakes off the debuff.\n";
             } break;
         }
     }
 
+    const LootTable& lootTable() const {
+        static const LootTable table({{20005, Uncommon, 20}, {20009, Rare, 10}}, 70);
+        return table;
+    }
+
+    const LootTable& bossLootTable() const {
+        static const LootTable table({{20009, Rare, 50}, {20006, Rare, 30}, {20007, Epic, 20}}, 0);
+        return table;
+    }
+
     void turn(Entity* target){
-        std::cout << "The slime gathers its power a little. It lurches back opening a mouth of sorts, exposing its core. ";
+        gameOut() << "The slime gathers its power a little. It lurches back opening a mouth of sorts, exposing its core. ";
         magAtk += 15;
         mAtkOrig += 15;
         speed += 10;
         spdOrig += 10;
-        if (magAtk < 30) std::cout << "It shoots a little beam of flame at you, dealing " 
+        if (magAtk < 30) gameOut() << "It shoots a little beam of flame at you, dealing " 
                                    << target->dealMDamage(magAtk) << " magic damage. It stings.\n";
-        else if (magAtk < 60) std::cout << "It shoots a moderate beam of flame at you, dealing " 
+        else if (magAtk < 60) gameOut() << "It shoots a moderate beam of flame at you, dealing " 
                                         << target->dealMDamage(magAtk) << " magic damage. It burns.\n";
-        else if (magAtk < 90) std::cout << "It launches a sizeable blast of flame at you, dealing " 
+        else if (magAtk < 90) gameOut() << "It launches a sizeable blast of flame at you, dealing " 
                                         << target->dealMDamage(magAtk) << " magic damage. It's seriously hot.\n";
-        else std::cout << "It launches a massive blast of flame at you, dealing " 
+        else gameOut() << "It launches a massive blast of flame at you, dealing " 
                        << target->dealMDamage(magAtk) << " magic damage. You can barely breathe amidst the roaring flames.\n";
     }
 };
@@ -163,11 +267,19 @@ public:
         physDef = 0;
         magAtk = 5;
         magDef = 0;
-        speed = 60 + rand() % 10 - 5;
+        speed = 60 + (int)(spawnDice()() % 10) - 5;
         shieldUp = false;
         ID = 10004;
     }
 
+    int extraState() const {
+        return shieldUp;
+    }
+
+    void setExtraState(int state){
+        shieldUp = state != 0;
+    }
+
     int dealPDamage(int damage){
         if (shieldUp){
             shieldUp = false;
@@ -190,12 +302,22 @@ public:
         }
     }
 
+    const LootTable& lootTable() const {
+        static const LootTable table({{20001, Common, 10}, {20005, Uncommon, 10}, {20002, Rare, 10}}, 70);
+        return table;
+    }
+
+    const LootTable& bossLootTable() const {
+        static const LootTable table({{20002, Rare, 50}, {20006, Rare, 30}, {20016, Legendary, 20}}, 0);
+        return table;
+    }
+
     void turn(Entity* target){
         if (!shieldUp){
-            std::cout << "The skeleton puts its shield up.\n";
+            gameOut() << "The skeleton puts its shield up.\n";
             shieldUp = true;
         } else {
-            std::cout << "The skeleton charges forward and bashes you with its shield, dealing " 
+            gameOut() << "The skeleton charges forward and bashes you with its shield, dealing " 
                       << target->dealPDamage(physAtk) << " physical damage.\n";
         }
     }
@@ -215,19 +337,29 @@ public:
         physDef = 0;
         magAtk = 1;
         magDef = 100;
-        speed = 50 + rand() % 10 - 5;
+        speed = 50 + (int)(spawnDice()() % 10) - 5;
         ID = 10005;
     }
 
+    const LootTable& lootTable() const {
+        static const LootTable table({{20003, Common, 15}, {20005, Uncommon, 15}, {20016, Legendary, 10}}, 70);
+        return table;
+    }
+
+    const LootTable& bossLootTable() const {
+        static const LootTable table({{20003, Common, 20}, {20007, Epic, 40}, {20016, Legendary, 40}}, 0);
+        return table;
+    }
+
     void turn(Entity* target) {
-        int decision = (rand() % 2);
-        std::cout << "The fairy zips close to you, almost nervously. ";
+        int decision = roll(2);
+        gameOut() << "The fairy zips close to you, almost nervously. ";
         if (decision == 1) {
-            std::cout << "It quickly swirls around you and you feel your wounds close.\n";
-            target->heal(15 + ((rand() % 11) - 5));
+            gameOut() << "It quickly swirls around you and you feel your wounds close.\n";
+            target->heal(15 + (roll(11) - 5));
         }
         else {
-            std::cout << "It seems to panic, and smacks you in the face for " << target->dealPDamage(physAtk) << " physical damage.\n";
+            gameOut() << "It seems to panic, and smacks you in the face for " << target->dealPDamage(physAtk) << " physical damage.\n";
         }
         target->setTurnBar(0);
         turnBar = 1000;
@@ -249,13 +381,18 @@ public:
         physDef = 10;
         magAtk = 10;
         magDef = 10;
-        speed = 50 + rand() % 10 - 5;
+        speed = 50 + (int)(spawnDice()() % 10) - 5;
         ID = 10006;
     }
 
+    const LootTable& lootTable() const {
+        static const LootTable table({{20004, Common, 15}}, 85);
+        return table;
+    }
+
     void turn(Entity* target){
-        std::cout << "The slime attempts to dissolve your clothes a little. It does a little damage.\n";
-        std::cout << "You take " << target->dealMDamage(magAtk) << " magic damage.\n";
+        gameOut() << "The slime attempts to dissolve your clothes a little. It does a little damage.\n";
+        gameOut() << "You take " << target->dealMDamage(magAtk) << " magic damage.\n";
     }
 };
 
@@ -273,24 +410,29 @@ public:
         physDef = 10;
         magAtk = 2;
         magDef = 30;
-        speed = 90 + rand() % 10 - 5;
+        speed = 90 + (int)(spawnDice()() % 10) - 5;
         ID = 10007;
     }
 
+    const LootTable& lootTable() const {
+        static const LootTable table({{20008, Uncommon, 15}, {20006, Rare, 10}}, 75);
+        return table;
+    }
+
     void turn(Entity* target){
-        int dodged = rand() % 4; //0, 1, 2, 3
-        std::cout << "The skeleton looses a volley of three arrows at you.\n";
+        int dodged = roll(4); //0, 1, 2, 3
+        gameOut() << "The skeleton looses a volley of three arrows at you.\n";
         switch(dodged){
-            case 0: std::cout << "You try to dodge out of the way, but you're hit by all 3 arrows. The first hits you for " 
-                              << target->dealPDamage(physAtk - rand() % 5) << " physical damage.\n"
-                              << "The second arrow hits you for " << target->dealPDamage(physAtk + rand() % 5) << " physical damage.\n"
+            case 0: gameOut() << "You try to dodge out of the way, but you're hit by all 3 arrows. The first hits you for " 
+                              << target->dealPDamage(physAtk - roll(5)) << " physical damage.\n"
+                              << "The second arrow hits you for " << target->dealPDamage(physAtk + roll(5)) << " physical damage.\n"
                               << "The last hits you for " << target->dealPDamage(physAtk) << " physical damage.\n"; break;
-            case 1: std::cout << "You duck out of the way of one, but still get hit by the other two. The first hits you for " 
-                              << target->dealPDamage(physAtk - rand() % 5) << " physical damage.\n"
-                              << "The second arrow hits you for " << target->dealPDamage(physAtk + rand() % 5) << " physical damage.\n"; break;
-            case 2: std::cout << "You duck out of the way of two arrows, but the last one still nicks you in the side. It hits you for "
-                              << target->dealPDamage(physAtk - rand() % 5) << " physical damage.\n"; break;
-            case 3: std::cout << "You're fast on your feet and manage to roll out of the way, dodging all 3 arrows.\n";
+            case 1: gameOut() << "You duck out of the way of one, but still get hit by the other two. The first hits you for " 
+                              << target->dealPDamage(physAtk - roll(5)) << " physical damage.\n"
+                              << "The second arrow hits you for " << target->dealPDamage(physAtk + roll(5)) << " physical damage.\n"; break;
+            case 2: gameOut() << "You duck out of the way of two arrows, but the last one still nicks you in the side. It hits you for "
+                              << target->dealPDamage(physAtk - roll(5)) << " physical damage.\n"; break;
+            case 3: gameOut() << "You're fast on your feet and manage to roll out of the way, dodging all 3 arrows.\n";
         }
     }
 };
@@ -309,21 +451,25 @@ public:
         physDef = 10;
         magAtk = 0;
         magDef = 20;
-        speed = 60 + rand() % 10 - 5;
+        speed = 60 + (int)(spawnDice()() % 10) - 5;
         ID = 10008;
     }
 
+    const LootTable& lootTable() const {
+        static const LootTable table({{20006, Rare, 15}, {20009, Rare, 10}, {20007, Epic, 10}}, 65);
+        return table;
+    }
+
     void turn(Entity* target) {
-        int dodge = rand() % 100; //90 - 99 is a dodge
-        std::cout << "The vampire whelp draws close and lunges at your arm, fangs at the ready, ";
-        if (dodge < 90) {
+        gameOut() << "The vampire whelp draws close and lunges at your arm, fangs at the ready, ";
+        if (chance(90)) { // dodged the other 10% of the time
             int dmg = target->dealPDamage(physAtk);
-            std::cout << "and you feel your life force being drawn as they sink into your skin.\n";
-            std::cout << "You take " << dmg << " damage.\n";
+            gameOut() << "and you feel your life force being drawn as they sink into your skin.\n";
+            gameOut() << "You take " << dmg << " damage.\n";
             this->heal(dmg);
         }
         else {
-            std::cout << "but you are faster, and deflect the approach.\n"
+            gameOut() << "but you are faster, and deflect the approach.\n"
                       << "The whelp hisses angrily at you and keeps its distance.\n";
         }
     }
@@ -343,25 +489,29 @@ public:
         physDef = 0;
         magAtk = 0;
         magDef = 0;
-        speed = 80 + rand() % 10 - 5;
+        speed = 80 + (int)(spawnDice()() % 10) - 5;
         ID = 10009;
     }
 
     int dealPDamage(int damage) {
-        int acc = rand() % 100; //80 - 99 is a hit
-        if (acc < 80) {
-            std::cout << "The spider is too quick! It dodges your attack!\n";
+        if (chance(80)) { // hit the other 20% of the time
+            gameOut() << "The spider is too quick! It dodges your attack!\n";
             return 0;
         }
-        else { return damage; }
+        else { return Entity::dealPDamage(damage); }
     }
 
     int dealPDamage(int damage, double ignoreDef) {
         return dealPDamage(damage);
     }
 
+    const LootTable& lootTable() const {
+        static const LootTable table({{20004, Common, 5}}, 95);
+        return table;
+    }
+
     void turn(Entity* target) {
-        std::cout << "The tiny spider crawls onto your leg and bites you, dealing "
+        gameOut() << "The tiny spider crawls onto your leg and bites you, dealing "
                   << target->dealPDamage(physAtk) << " damage. You flinch and fling it off.\n";
     }
 };
@@ -5,125 +5,323 @@
 #include <string>
 #include <vector>
 #include <cstdlib>
+#include <random>
 #include "./../headers/Room.hpp"
 #include "./../headers/Factory.hpp"
+#include "./../headers/Biome.hpp"
 #include "./CombatRoom.cpp"
 
 class Quest{
 private:
     std::string description;
-    std::vector<Room*> map;
     Enemy* boss;
+    bool bossPlaced = false; // the boss belongs to its room once the boss room has been built
     unsigned int reward;
+    const Biome* biome;
+    int level;
+    unsigned seed;
+    DungeonGraph dungeon;
+    std::vector<Room*> rooms; // nullptr for rooms that haven't been built yet
+    std::vector<bool> visited;
+    unsigned built = 0;
+
+    /**
+     * roomRng(): the random generator for one room. It only depends on the quest seed and the room,
+     * so a room always comes out the same no matter when or how many times it gets built.
+     * args: index (the room)
+     * outputs: the generator
+     * */
+    std::mt19937 roomRng(unsigned index) const {
+        std::seed_seq seq{seed, index};
+        return std::mt19937(seq);
+    }
+
+    /**
+     * rollEnemies(): picks the enemies for a fight from the quest's biome.
+     * args: rng (the room's generator), fewest, most (how many to pick)
+     * outputs: the enemies' factory IDs
+     * */
+    std::vector<unsigned> rollEnemies(std::mt19937& rng, unsigned fewest, unsigned most) const {
+        unsigned count = fewest + rng() % (most - fewest + 1);
+        std::vector<unsigned> picked;
+        for (unsigned i = 0; i < count; ++i) picked.push_back(biome->enemies.sample(level, rng));
+        return picked;
+    }
+
+    /**
+     * populate(): fills a combat room with enemies picked from the quest's biome.
+     * args: room (the room to fill), rng (the room's generator), fewest, most (how many to add)
+     * outputs: none
+     * */
+    void populate(CombatRoom* room, std::mt19937& rng, unsigned fewest, unsigned most) {
+        EnemyFactory enemies;
+        for (unsigned id : rollEnemies(rng, fewest, most)) room->addEnemy(enemies.generate(id));
+    }
+
+    /**
+     * build(): makes the room object for one room of the dungeon, with its enemies if it has any.
+     * args: index (the room)
+     * outputs: the new room. The caller owns it
+     * */
+    Room* build(unsigned index) {
+        RoomFactory factory;
+        std::mt19937 rng = roomRng(index);
+        const QuestLayout& layout = biome->layout;
+        switch (dungeon.kind(index)) {
+            case ROOM_AMBIENT: return factory.generate(biome->ambientRooms.sample(level, rng));
+            case ROOM_ODDITY: {
+                unsigned id = biome->oddityRooms.sample(level, rng);
+                return factory.generate(id, rng());
+            }
+            case ROOM_ARENA: {
+                CombatRoom* arena = new CombatRoom("Arena","You enter a small room and are ambushed by enemies!","With the enemies slain, you can carry on.");
+                populate(arena, rng, layout.arenaMin, layout.arenaMax);
+                return arena;
+            }
+            case ROOM_GATE: {
+                CombatRoom* gate = new CombatRoom("Guarded gate","A heavy gate bars the way into a side passage, and its guards have spotted you!","The gate stands open, its guards defeated.");
+                populate(gate, rng, layout.arenaMin, layout.arenaMax);
+                return gate;
+            }
+            default: {
+                CombatRoom* bossRoom = new CombatRoom("Boss Arena","You enter an arena and stare down the enemy you were tasked to defeat.","With your adversary defeated, it's only you in the arena now. You can go home.");
+                populate(bossRoom, rng, layout.bossAlliesMin, layout.bossAlliesMax);
+                boss->setBoss(true);
+                bossRoom->addEnemy(boss);
+                bossPlaced = true;
+                bossRoom->setEnd();
+                return bossRoom;
+            }
+        }
+    }
+
+protected:
+    std::vector<Adventurer*> party;
+
+    /** For quests that lay out their rooms themselves. There is no boss or dungeon, the subclass takes care of its own rooms. */
+    Quest(unsigned int r, std::string d) : description(d), boss(nullptr), reward(r), biome(nullptr), level(1), seed(0) {}
+
 public:
+    // returned by exitTo() when the label doesn't match an exit
+    static const unsigned NO_ROOM = ~0u;
+
     Quest();
-    Quest(unsigned int r, Enemy* b, std::string d) { //reward, boss, and task passed in from Town
-        RoomFactory factory;
-        EnemyFactory enemies;
+    Quest(unsigned int r, Enemy* b, std::string d) : Quest(r, b, d, biomeCatalog()[rand() % biomeCatalog().size()], 1) {}
 
+    /**
+     * Quest(): sets up a quest in a given biome. Only the dungeon layout (see Dungeon.hpp) and a seed are made here.
+     * Each room, along with its enemies, is built the first time the player enters it, with the enemies and rooms
+     * picked from the biome's encounter tables for the player's level. Plain rooms are freed again once the player leaves,
+     * so memory grows with the rooms visited rather than the size of the dungeon.
+     * args: r (the reward), b (the boss, the quest takes ownership of it), d (the task), biome (where the quest takes place,
+     *       it has to outlive the quest, like the ones in biomeCatalog()), level (the level of the player taking the quest)
+     * */
+    Quest(unsigned int r, Enemy* b, std::string d, const Biome& biome, int level) : Quest(r, b, d, biome, level, rand()) {}
+
+    /** This is a version of the above constructor that takes the seed for the quest's rooms. The same seed always gives the same quest. */
+    Quest(unsigned int r, Enemy* b, std::string d, const Biome& biome, int level, unsigned seed) { //reward, boss, and task passed in from Town
         reward = r;
         boss = b;
         description = d;
+        this->biome = &biome;
+        this->level = level;
+        this->seed = seed;
+        dungeon = generateDungeon(biome.layout.dungeon, seed);
+        rooms.assign(dungeon.roomCount(), nullptr);
+        visited.assign(dungeon.roomCount(), false);
+    }
 
-        unsigned mapSize = 5;
-        map.clear();
-        for (unsigned i = 0; i < mapSize; ++i) {
-            map.push_back(factory.generate((rand() % NUM_AMBIENT_ROOMS) + 35001));
-        }
+    Quest(const Quest&) = delete;
+    Quest& operator=(const Quest&) = delete;
 
-        unsigned fightLocation = ((rand() % (mapSize - 1)) + 1);
-        unsigned enemyLimit = ((rand() % 5) + 1); // 1 - 5 enemies
-        delete map.at(fightLocation);
-        CombatRoom* arena = new CombatRoom("Arena","You enter a small room and are ambushed by enemies!","With the enemies slain, you can carry on.");
-        for (unsigned i = 0; i < enemyLimit; ++i) {
-            arena->addEnemy(enemies.generate((rand() % NUM_ENEMIES) + 10001));
+    virtual ~Quest() {
+        for (unsigned int i = 0; i < rooms.size(); ++i) {
+            delete rooms[i];
         }
-        map.at(fightLocation) = arena;
-
-        unsigned oddLocation = ((rand() % (mapSize - 1)) + 1);
-        delete map.at(oddLocation);
-        map.at(oddLocation) = factory.generate((rand() % 4) + 30001);
+        if (!bossPlaced) delete boss;
+    }
 
-        unsigned bossAllies = ((rand() % 4) + 2); // 2 - 6 enemies (+ boss)
-        CombatRoom* bossRoom = new CombatRoom("Boss Arena","You enter an arena and stare down the enemy you were tasked to defeat.","With your adversary defeated, it's only you in the arena now. You can go home.");
-        for (unsigned i = 0; i < bossAllies; ++i) {
-            bossRoom->addEnemy(enemies.generate((rand() % NUM_ENEMIES) + 10001));
-        }
-        bossRoom->addEnemy(boss);
-        bossRoom->setEnd();
-        delete map.at(mapSize - 1);
-        map.at(mapSize - 1) = bossRoom;
+    /**
+     * linkPlayers(): this function links the player to all rooms in the quest, including the ones that haven't been built yet.
+     * args: p (the player to be linked)
+     * outputs: none
+     * */ 
+    void linkPlayers(Adventurer* p) {
+        linkPlayers(std::vector<Adventurer*>(1, p));
+    }
 
-        for (unsigned i = 0; (i + 1) < mapSize; ++i) {
-            map.at(i)->addExit(map.at(i+1));
+    /**An alternate version of the above method that links a whole party instead.*/
+    virtual void linkPlayers(const std::vector<Adventurer*>& party) {
+        this->party = party;
+        for (unsigned i = 0; i < rooms.size(); ++i) {
+            if (rooms[i] != nullptr) rooms[i]->linkParty(party);
         }
-        map.shrink_to_fit();
     }
 
-    ~Quest() {
-        for (unsigned int i = 0; i < map.size(); ++i) {
-            delete map.at(i);
+    /**
+     * enter(): gets a room for the player to walk into, building it first if it isn't there already.
+     * args: index (the room, between 0 and roomCount() - 1)
+     * outputs: the room
+     * */
+    virtual Room* enter(unsigned index) {
+        if (rooms[index] == nullptr) {
+            rooms[index] = build(index);
+            for (unsigned k = 0; k < dungeon.exitCount(index); ++k) rooms[index]->addExitLabel(dungeon.exitLabel(index, k));
+            if (!party.empty()) rooms[index]->linkParty(party);
+            ++built;
         }
+        return rooms[index];
     }
 
     /**
-     * linkPlayers(): this function links the player to all rooms in the quest.
-     * args: p (the player to be linked)
+     * leave(): tells the quest the player walked out of a room. Plain rooms have nothing to remember, so they get freed
+     * and will be built again the same way if the player comes back. Oddities and fights are kept.
+     * args: index (the room)
      * outputs: none
-     * */ 
-    void linkPlayers(Adventurer* p) {
-        for (unsigned i = 0; i < map.size(); ++i) {
-            map.at(i)->linkPlayer(p);
-        }
+     * */
+    virtual void leave(unsigned index) {
+        if (rooms[index] == nullptr || dungeon.kind(index) != ROOM_AMBIENT || rooms[index]->isEnd()) return;
+        delete rooms[index];
+        rooms[index] = nullptr;
+        --built;
     }
 
     /**
-     * getBeginning(): this function returns the start of the quest room.
-     * This always gets the first value in the map vector, so you should always push the beginning first.
+     * getBeginning(): this function returns the start of the quest room, building it if needed.
      * Use this to start a new quest from the town interface.
      * args: none
-     * outputs: a pointer to the start of the quest
+     * outputs: a reference to the start of the quest
      * */
     Room& getBeginning(){
-        return *map[0];
+        return *enter(start());
     }
 
     /**
-     * addRoom(Room*): this function adds a new room to the quest.
-     * args: r (the room to be added)
+     * setLevel(): changes the level enemies and rooms are picked for. Only rooms that haven't been built yet are affected,
+     * so this is meant for quests made ahead of time, before the player sets out.
+     * args: level (the level of the player taking the quest)
      * outputs: none
      * */
-    void addRoom(Room* r){
-        map.push_back(r);
+    void setLevel(int level) {
+        this->level = level;
+    }
+
+    /** Returns the boss of the quest. The quest still owns it. */
+    Enemy* getBoss() {
+        return boss;
     }
 
     /**
-     * oneWayLink(int, int): this method links 2 rooms in the map with each other.
-     * It creates a one-way exit between the first room and the second. 
-     * Indices start at 0. So the first pushed room has index 0, second has index 1, etc. 
-     * args: index1 (the origin room), index2 (the destination room)
-     * outputs: none
+     * encounters(): lists the fights a player can't get around on the way to the boss (see DungeonGraph::routeToBoss()),
+     * without building any rooms. The enemies come out the same as they would be built for the current level.
+     * args: none
+     * outputs: the factory IDs of each fight's enemies, in the order they are met. The boss is the last enemy of the last fight
+     * */
+    std::vector<std::vector<unsigned> > encounters() const {
+        const QuestLayout& layout = biome->layout;
+        std::vector<std::vector<unsigned> > fights;
+        for (unsigned room : dungeon.routeToBoss()) {
+            std::mt19937 rng = roomRng(room);
+            switch (dungeon.kind(room)) {
+                case ROOM_ARENA:
+                case ROOM_GATE: fights.push_back(rollEnemies(rng, layout.arenaMin, layout.arenaMax)); break;
+                case ROOM_BOSS: fights.push_back(rollEnemies(rng, layout.bossAlliesMin, layout.bossAlliesMax)); break;
+                default: break;
+            }
+        }
+        fights.back().push_back(boss->getID());
+        return fights;
+    }
+
+    /** Returns the index of the room the quest starts in. */
+    virtual unsigned start() const {
+        return dungeon.start;
+    }
+
+    /**
+     * firstVisit(): marks a room as visited. Rooms only play out the first time, so oddities can't be farmed by walking in circles.
+     * args: index (the room)
+     * outputs: true if the player hadn't been there before
+     * */
+    virtual bool firstVisit(unsigned index) {
+        if (visited[index]) return false;
+        visited[index] = true;
+        return true;
+    }
+
+    /** Returns whether a quest can be picked up again partway through by marking the rooms already cleared, see Autosave. */
+    virtual bool resumable() const {
+        return true;
+    }
+
+    /** Returns whether the room a quest ended in gets interacted with once more afterwards, like the boss arena telling the player they can go home. */
+    virtual bool replaysEnd(unsigned /* index */) const {
+        return true;
+    }
+
+    /** Returns the number of rooms in the dungeon, built or not. */
+    unsigned roomCount() const {
+        return dungeon.roomCount();
+    }
+
+    /** Returns the number of rooms that currently exist. */
+    unsigned roomsBuilt() const {
+        return built;
+    }
+
+    /** Returns the layout of the dungeon. */
+    const DungeonGraph& layout() const {
+        return dungeon;
+    }
+
+    /**
+     * roomName(): gets the name of a room without keeping it around. Fights have fixed names and ambient rooms can be
+     * looked up in their text table. An oddity that isn't built is made just long enough to read its name.
+     * args: index (the room)
+     * outputs: the name
      * */
-    void oneWayLink(int index1, int index2){
-        if ((index1) > map.size() || (index2) > map.size()){
-            std::cout << "Something went wrong. This room linkage is invalid.\n";
-        } else {
-            map[index1]->addExit(map[index2]);
+    std::string roomName(unsigned index) const {
+        if (rooms[index] != nullptr) return rooms[index]->getName();
+        RoomFactory factory;
+        std::mt19937 rng = roomRng(index);
+        Room* room = nullptr;
+        switch (dungeon.kind(index)) {
+            case ROOM_ARENA: return "Arena";
+            case ROOM_GATE: return "Guarded gate";
+            case ROOM_BOSS: return "Boss Arena";
+            case ROOM_AMBIENT: return AmbientRoom::nameOf(biome->ambientRooms.sample(level, rng));
+            case ROOM_ODDITY: room = factory.generate(biome->oddityRooms.sample(level, rng)); break;
         }
+        std::string name = room->getName();
+        delete room;
+        return name;
     }
 
-    /**An alternate version of the above method that creates a two-way exit instead.*/
-    void twoWayLink(int index1, int index2){
-        if ((index1 + 1) > map.size() || (index2 + 1) > map.size()){
-            std::cout << "Something went wrong. This room linkage is invalid.\n";
-        } else {
-            map[index1]->addExit(map[index2]);
-            map[index2]->addExit(map[index1]);
+    /**
+     * printExits(): prints out the exits of a room, with their labels and where they lead.
+     * args: index (the room)
+     * outputs: none
+     * */
+    virtual void printExits(unsigned index) {
+        std::cout << "Available exits: \n";
+        for (unsigned k = 0; k < dungeon.exitCount(index); ++k) {
+            std::cout << dungeon.exitLabel(index, k) << ":\t" << roomName(dungeon.exit(index, k)) << "\n";
         }
     }
 
+    /**
+     * exitTo(): works out where an exit label leads. The label is looked up in the room's exit index (see Room::exitId()),
+     * which enter() fills with the dungeon's labels, and the exit's id picks the room it leads to.
+     * args: index (the room the player is in, built if it isn't yet), label (the label they typed)
+     * outputs: the room the exit leads to, or NO_ROOM if the room has no such exit
+     * */
+    virtual unsigned exitTo(unsigned index, const std::string& label) {
+        unsigned k = Quest::enter(index)->exitId(label);
+        return k == Room::NO_EXIT ? NO_ROOM : dungeon.exit(index, k);
+    }
+
     /**Returns the spoils of war.*/
-    int getReward(){
+    virtual int getReward(){
         return reward;
     }
 
@@ -136,4 +334,6 @@ public:
     }
 };
 
+const unsigned Quest::NO_ROOM;
+
 #endif
@@ -4,6 +4,9 @@
 #include "./../headers/Adventurer.hpp"
 #pragma once
 
+// stat growth per level: health, physical atk/def, magical atk/def, speed
+const StatGrowth WARRIOR_GROWTH = {40, 5, 5, 0, 5, 0};
+
 class Warrior : public Adventurer{
 private:
     int revenge, revengeMax;
@@ -14,22 +17,16 @@ public:
 
         maxHealth = 250;
         health = maxHealth;
-        hpLvl = 40;
+        growth = WARRIOR_GROWTH;
 
         physAtk = 50;
-        pAtkLvl = 5;
         physDef = 30;
-        pDefLvl = 5;
 
         magAtk = 10;
-        mAtkLvl = 0;
         magDef = 25;
-        mDefLvl = 5;
 
         speed = 90;
-        spdLvl = 0;
 
-        abi1MaxCD = 0;
         revenge = 0;
         revengeMax = 3;
         revengeReduction = 0.05;
@@ -45,75 +42,59 @@ public:
         // levelUp();
     }
 
-    void levelUp(){
-        // update stats
-        std::cout << "You leveled up! Your strength grows.\n";
-        if (hpLvl > 0){
-            maxHealth += hpLvl;
-            health += hpLvl;
-            std::cout << "Health: +" << hpLvl <<"\n";
-        }
-        if (pAtkLvl > 0){
-            physAtk += pAtkLvl; 
-            std::cout << "Physical ATK: +" << pAtkLvl << "\n";
-        }
-        if (pDefLvl > 0){
-            physDef += pDefLvl; 
-            std::cout << "Physical DEF: +" << pDefLvl << "\n";
-        }
-        if (mAtkLvl > 0){
-            magAtk += mAtkLvl; 
-            std::cout << "Magical ATK: +" << mAtkLvl << "\n";
-        }
-        if (mDefLvl > 0){
-            magAtk += mAtkLvl; 
-            std::cout << "Magical DEF: +" << mDefLvl << "\n";
-        }
-        if (spdLvl > 0){
-            speed += spdLvl;
-            std::cout << "Speed: +" << spdLvl << "\n";
-        }
+    std::string levelUpFlavor() const {
+        return " Your strength grows.";
+    }
 
-        ++level;	
+    Adventurer* clone() const {
+        return new Warrior(*this);
+    }
 
-        // update abilities
-        if (level == 4){
-            abi2MaxCD = 4;
-            ++revengeMax;
-            std::cout << "You unlocked Drain. Your maximum amount of revenge stacks increased to " << revengeMax << ".\n";
-        }
+    std::string className() const {
+        return "Warrior";
     }
 
-    void inspect(){
-        std::cout << name << " - Level " << level << " Warrior";
-        std::cout << "\nExperience: \t\t" << experience << ", " << 75 * pow(1.1, level) << " to level\n"
-        "Gold: \t\t\t" << gold << "\n"
-        "Health: \t\t" << health << "/" << maxHealth << " (+" << maxHealthBonus << ")\n"
-        "Physical ATK: \t\t" << physAtk << " (+" << physAtkBonus << ")\n"
-        "Physical DEF: \t\t" << physDef << " (+" << physDefBonus << ")\n"
-        "Magical ATK: \t\t" << magAtk << " (+" << magAtkBonus << ")\n"
-        "Magical DEF: \t\t" << magDef << " (+" << magDefBonus << ")\n"
-        "Speed: \t\t\t" << speed << " (+" << speedBonus << ")\n";
-        printSpecialFeature();
+    const std::vector<AbilityDef>& abilityTable() const {
+        static const std::vector<AbilityDef> abilities = {
+            {"Expose", 0, 1, SINGLE_TARGET, static_cast<AbilityEffect>(&Warrior::expose),
+             "Strike at an enemy and expose their weak points. Deals 60% PAtk physical damage and applies a 3 turn PDef debuff."},
+            {"Drain", 4, 4, SINGLE_TARGET, static_cast<AbilityEffect>(&Warrior::drain),
+             "Attack an enemy. Deals 200% PAtk physical damage and heals yourself for 30% of the damage dealt."}
+        };
+        return abilities;
+    }
 
-        std::cout << "\nAbilities:\n";
-        if (abi1MaxCD != -1) std::cout << "Expose (no CD): Strike at an enemy and expose their weak points. Deals 60% PAtk physical damage and "
-                                       << "applies a 3 turn PDef debuff.\n";
-        if (abi2MaxCD != -1) std::cout << "Drain (" << abi2MaxCD << " turn CD): Attack an enemy. Deals 200% PAtk physical damage and "
-                                       << "heals yourself for 30% of the damage dealt.\n";
+    /**Saves the revenge stacks and the cap.*/
+    void classState(int* state) const {
+        state[0] = revenge;
+        state[1] = revengeMax;
+        state[2] = state[3] = 0;
+    }
+
+    void setClassState(const int* state){
+        revenge = state[0];
+        revengeMax = state[1];
+    }
+
+    /**Drain also raises the revenge cap.*/
+    void onUnlock(int index){
+        if (index == 1){
+            ++revengeMax;
+            gameOut() << "Your maximum amount of revenge stacks increased to " << revengeMax << ".\n";
+        }
     }
 
     /**Print the revenge stacks.*/
     void printSpecialFeature(){
         if (revenge > 0){
-            std::cout << "Revenge stacks:\n";
-            for (int i = 0; i < revenge; ++i) std::cout << "(>+<) ";
-            std::cout << "\n";
-            for (int i = 0; i < revenge; ++i) std::cout << "  |   ";
-            std::cout << "\n";
-            for (int i = 0; i < revenge; ++i) std::cout << "  |   ";
-            std::cout << "\n";
-            std::cout << "Reducing damage by " << revenge * revengeReduction * 100 << "% and increasing damage of the next hit by "
+            gameOut() << "Revenge stacks:\n";
+            for (int i = 0; i < revenge; ++i) gameOut() << "(>+<) ";
+            gameOut() << "\n";
+            for (int i = 0; i < revenge; ++i) gameOut() << "  |   ";
+            gameOut() << "\n";
+            for (int i = 0; i < revenge; ++i) gameOut() << "  |   ";
+            gameOut() << "\n";
+            gameOut() << "Reducing damage by " << revenge * revengeReduction * 100 << "% and increasing damage of the next hit by "
                     << revenge * revengeDamage * 100 << "%\n";   
         }
     }
@@ -162,72 +143,24 @@ public:
     }
 
     void attack(Enemy* target){
-        std::cout << "You bash " << target->getName() << " with your weapon, dealing (+" << getBonusRevengeDamage() << ") "
+        gameOut() << "You bash " << target->getName() << " with your weapon, dealing (+" << getBonusRevengeDamage() << ") "
                   << target->dealPDamage(getModifiedPAtk()) << " physical damage.\n";
     }
 
-    int ability(std::vector<Enemy*> targets){
-        InputReader reader;
-        int choice[]{0, 1, 2, 3, 4, 5};
-        int abilityOptions = 1;
-        if (abi1MaxCD != -1) abilityOptions++;
-        if (abi2MaxCD != -1) abilityOptions++;
-        if (abi3MaxCD != -1) abilityOptions++;
-        if (abi4MaxCD != -1) abilityOptions++;
-        if (abi5MaxCD != -1) abilityOptions++;
-
-        // prompt for ability choice
-        std::cout << "Choose an ability to use.\n"
-                  << "0:\tCancel\n";
-        
-        // print ability 1
-        if (abi1MaxCD != -1){
-            std::cout << "1:\tExpose ";
-            if (abi1CD == 0) std::cout << "(Ready)\n";
-            else std::cout << "(Ready in " << abi1CD << " turn(s))\n";
-        }
-
-        // print ability 2
-        if (abi2MaxCD != -1){
-            std::cout << "2:\tDrain ";
-            if (abi2CD == 0) std::cout << "(Ready)\n";
-            else std::cout << "(Ready in " << abi2CD << " turn(s))\n";
-        }
+    /**Expose: 60% PAtk physical damage and a physical defense debuff.*/
+    void expose(std::vector<Enemy*>& /* targets */, Enemy* target){
+        gameOut() << "You dash towards " << target->getName() << " and strike them, throwing them off balance. "
+                  << "You deal " << target->dealPDamage(getModifiedPAtk() * 0.6) << " physical damage and lower their "
+                  << "physical defense for 3 turns.\n";
+        target->buff(PHYS_DEF, -3);
+    }
 
-        // get user prompt and execute the action
-        int abiChoice = reader.readInput(choice, abilityOptions);
-        switch(abiChoice){
-            case 0: return 0; // cancel selected
-            case 1:{ // expose
-                int enemySelection = selectTarget(targets);
-                if (enemySelection == 0) return 0;
-                else {
-                    std::cout << "You dash towards " << targets[enemySelection - 1]->getName() << " and strike them, throwing them off balance. "
-                                << "You deal " << targets[enemySelection - 1]->dealPDamage(getModifiedPAtk() * 0.6) << " physical damage and lower their "
-                                << "physical defense for 3 turns.\n";
-                    targets[enemySelection - 1]->buff(PHYS_DEF, -3);
-                }
-                // expose has no CD
-                return 2;
-            } break;
-            case 2:{ // drain strike
-                if (abi2CD > 0){
-                    std::cout << "That ability isn't ready yet.\n";
-                    return 0; 
-                } else {
-                    int enemySelection = selectTarget(targets);
-                    if (enemySelection == 0) return 0;
-                    else {
-                        int damageDealt = targets[enemySelection - 1]->dealPDamage(getModifiedPAtk() * 2);
-                        std::cout << "You deal a heavy strike at " << targets[enemySelection - 1]->getName() << ", dealing "
-                                << damageDealt << " physical damage and healing yourself for " << damageDealt * 0.3 << " health.\n";
-                                heal(damageDealt * 0.3);
-                    }
-                    abi2CD = abi2MaxCD;
-                    return 2;
-                }
-            } break;
-        }
+    /**Drain: 200% PAtk physical damage, healing for 30% of the damage dealt.*/
+    void drain(std::vector<Enemy*>& /* targets */, Enemy* target){
+        int damageDealt = target->dealPDamage(getModifiedPAtk() * 2);
+        gameOut() << "You deal a heavy strike at " << target->getName() << ", dealing "
+                  << damageDealt << " physical damage and healing yourself for " << damageDealt * 0.3 << " health.\n";
+        heal(damageDealt * 0.3);
     }
 };
 
@@ -8,12 +8,15 @@
 #include <string>
 #include <cstdlib>
 #include <ctime>
+#include <vector>
 
 #include "./../headers/Room.hpp"
 #include "./CombatRoom.cpp"
 #include "./OddityRoom.cpp"
 #include "./../headers/Item.hpp"
 #include "./../headers/Town.hpp"
+#include "./../headers/SaveGame.hpp"
+#include "./../headers/Journal.hpp"
 #include "./../headers/Factory.hpp"
 #include "./InputReader.cpp"
 #include "./Warrior.cpp"
@@ -60,13 +63,27 @@ Adventurer* CharacterGeneration() {
     return player;
 }
 
-void TraverseQuest(Quest* quest, Adventurer* player) {
+//Plays a quest through. If the game was closed partway through it, resume lists the rooms already cleared and the player picks up in the last of them
+void TraverseQuest(Quest* quest, Adventurer* player, Autosave* autosave = nullptr, const JournalProgress* resume = nullptr) {
     InputReader read;
-    Room* currentRoom = &quest->getBeginning();
+    unsigned at = quest->start();
+    if (resume != nullptr && quest->resumable()) {
+        for (unsigned room : resume->cleared) {
+            quest->firstVisit(room);
+            at = room;
+        }
+    }
+    Room* currentRoom = quest->enter(at);
     while (true) {
-        currentRoom->interact();
+        if (quest->firstVisit(at)) {
+            currentRoom->interact();
+            if (autosave != nullptr && quest->resumable()) autosave->roomCleared(player, at);
+        }
+        else std::cout << "You've been here before: " << currentRoom->getName() << "\n";
         if (currentRoom->isEnd()) break;
         int movementSelection = 0;
+        std::string label;
+        unsigned next;
         while (movementSelection != 1) {
             std::cout << "\nWhat would you like to do?\n"
                       << "1.\tContinue forward\n"
@@ -77,8 +94,18 @@ void TraverseQuest(Quest* quest, Adventurer* player) {
             switch (movementSelection) {
                 case 1:
                     std::cout << "\nWhere would you like to go?\n";
-                    currentRoom->printExits();
-                    currentRoom = &(currentRoom->getExit(read.readInput(currentRoom->getExitLabels())));
+                    quest->printExits(at);
+                    // look the label up directly, a miss comes back as NO_ROOM and we just ask again
+                    next = Quest::NO_ROOM;
+                    while (next == Quest::NO_ROOM){
+                        std::cin >> label;
+                        next = quest->exitTo(at, label);
+                        if (next == Quest::NO_ROOM) std::cout << INVALID_MSG;
+                    }
+                    quest->leave(at); // the next room gets built as we walk in, plain rooms are let go behind us
+                    at = next;
+                    currentRoom = quest->enter(at);
+                    player->updateItemCooldowns(); // walking between rooms counts as a turn for item cooldowns
                     break;
                 case 2:
                     player->inspect();
@@ -89,31 +116,74 @@ void TraverseQuest(Quest* quest, Adventurer* player) {
              }
         }
     }
-    if (player->isAlive()) { currentRoom->interact(); } //player made it to boss fight
+    if (player->isAlive() && quest->replaysEnd(at)) { currentRoom->interact(); } //player made it to boss fight
 }
 
 int main() {
     srand(time(0));
-    unsigned long long score = 0;
+    uint64_t score = 0;
 
     std::cout << "\nWelcome!\n";
-    Adventurer* player = CharacterGeneration();
+    Adventurer* player = nullptr;
+    Town* currentTown = nullptr;
+    Autosave autosave(SAVE_PATH);
+    JournalProgress progress;
+    {
+        SaveFile save(SAVE_PATH);
+        if (save.valid()) {
+            InputReader reader;
+            int twoChoice[]{1, 2};
+            std::cout << "\nThere is a saved game for " << std::string(save.name(), save.nameLength())
+                      << " (level " << save.header().hero.level << ").\n"
+                      << "1.\tContinue\n"
+                      << "2.\tStart over\n";
+            if (reader.readInput(twoChoice, 2) == 1) {
+                if (autosave.resume(player, currentTown, score, progress)) {
+                    std::cout << "\nWelcome back, " << player->getName() << "!\n";
+                    if (progress.torn) std::cout << "The last moments before the game was closed couldn't be recovered.\n";
+                }
+                else std::cout << "The save file couldn't be loaded. Starting a new game.\n";
+            }
+        }
+        else if (save.exists()) std::cout << save.error() << " Starting a new game.\n";
+    }
+    if (player == nullptr) {
+        player = CharacterGeneration();
+        currentTown = new Town();
+        autosave.compact(player, currentTown, score);
+    }
 
-    Town* currentTown = new Town();
-    Quest* currentQuest = currentTown->RoamTown(player);
+    TownBuilder nextTown;
+    Quest* currentQuest;
+    if (progress.inQuest && currentTown->getQuest() != nullptr) {
+        std::cout << "You pick up your quest where you left off.\n";
+        currentQuest = currentTown->getQuest();
+    }
+    else {
+        progress.inQuest = false;
+        currentQuest = currentTown->RoamTown(player, &autosave);
+    }
 
     while (currentQuest != nullptr) {
+        nextTown.start(rand()); //the next town gets built while this quest is played
         currentQuest->linkPlayers(player);
-        TraverseQuest(currentQuest, player);
+        if (!progress.inQuest) autosave.questStarted(player, currentTown);
+        TraverseQuest(currentQuest, player, &autosave, progress.inQuest ? &progress : nullptr);
+        progress = JournalProgress();
         if (player->isAlive()) { score += currentQuest->getReward(); } //if quest successful, add to score
+        autosave.questEnded(player, score);
 
         delete currentQuest;
         delete currentTown;
 
-        currentTown = new Town();
-        currentQuest = currentTown->RoamTown(player);
+        currentTown = nextTown.take();
+        autosave.arrived(player, currentTown, score);
+        currentQuest = currentTown->RoamTown(player, &autosave);
     }
 
+    if (autosave.compact(player, currentTown, score)) { std::cout << "\nYour game has been saved.\n"; }
+    else { std::cout << "\nYour game couldn't be saved!\n"; }
+
     score *= player->getLevel(); //final score = level * gold earned
     delete currentTown;
     delete player;
@@ -29,6 +29,7 @@ TEST(EnemySuite, ConstructDestructAllEnemies) {
 
 //Check if enemies can take their turn properly
 TEST(EnemySuite, AllEnemiesTakeTurn) {
+    combatDice().seed(1); //the Strange Fairy may heal instead of attacking, which does nothing to a dummy at full health
     Enemy* test = nullptr;
     Entity* dummy = new TEST_DUMMY();
     int priorHP;
@@ -113,6 +114,89 @@ TEST(AdventurerSuite, AdventurerBehaviors) {
         delete test;
     }
 }
+//Check if large experience gains level the player the same way leveling one at a time does
+TEST(AdventurerSuite, BulkLevelUpMatchesXPCurve) {
+    int gains[] = {0, 82, 83, 500, 5000, 123456};
+    for (int gain : gains) {
+        //the original one-level-at-a-time loop
+        int expectedLevel = 1, leftover = gain;
+        while (leftover > 75 * pow(1.1, expectedLevel)) {
+            leftover -= 75 * pow(1.1, expectedLevel);
+            ++expectedLevel;
+        }
+
+        Adventurer* test = new Samurai("TestSammy","Just a test sammy");
+        int basePAtk = test->getPAtk(), baseSpeed = test->getSpeed();
+        test->addExp(gain);
+        EXPECT_EQ(test->getLevel(), expectedLevel);
+        EXPECT_EQ(test->getPAtk(), basePAtk + SAMURAI_GROWTH.pAtk * (expectedLevel - 1));
+        EXPECT_EQ(test->getSpeed(), baseSpeed + SAMURAI_GROWTH.spd * (expectedLevel - 1));
+        delete test;
+    }
+
+    //nobody goes past the level cap
+    Adventurer* test = new Warrior("TestWarrior","Just a test warrior");
+    test->applyLevels(LEVEL_CAP * 2);
+    EXPECT_EQ(test->getLevel(), LEVEL_CAP);
+    delete test;
+}
+//Check if abilities unlock from the ability table and go on cooldown when used
+TEST(AdventurerSuite, AbilityTableCooldowns) {
+    Adventurer* test = new Samurai("TestSammy","Just a test sammy");
+    std::vector<Enemy*> noTargets;
+    EXPECT_EQ(test->readyAbilities().size(), 1); //only Blink Strike at level 1
+    EXPECT_FALSE(test->abilityUnlocked(1));
+    test->applyLevels(3);
+    EXPECT_EQ(test->readyAbilities().size(), 2); //Perfect Domain unlocks at level 4
+
+    test->useAbility(1, noTargets, nullptr);
+    EXPECT_FALSE(test->abilityReady(1));
+    EXPECT_EQ(test->getAbilityCooldown(1), test->abilityTable()[1].cooldown);
+    for (int i = 0; i < test->abilityTable()[1].cooldown; ++i) test->updateCooldowns();
+    EXPECT_TRUE(test->abilityReady(1));
+    delete test;
+}
+//Check that a clone copies the build but not the items, and that fighting with it leaves the original alone
+TEST(AdventurerSuite, CloneCopiesBuild) {
+    ItemFactory items;
+    Adventurer* test = new Warrior("TestWarrior","Just a test warrior");
+    test->applyLevels(4);
+    test->addItem(items.generate(20004));
+    Adventurer* copy = test->clone();
+    EXPECT_EQ(copy->getLevel(), test->getLevel());
+    EXPECT_EQ(copy->getMaxHealth(), test->getMaxHealth());
+    EXPECT_EQ(copy->getPAtk(), test->getPAtk());
+    EXPECT_EQ(copy->abilityTable().size(), test->abilityTable().size());
+    EXPECT_EQ(copy->getInvSize(), 0);
+    EXPECT_EQ(test->getInvSize(), 1);
+
+    std::vector<Enemy*> enemies{new Skeleton()};
+    {
+        MutedOutput muted;
+        copy->autoTurn(enemies);
+        enemies[0]->turn(copy);
+    }
+    EXPECT_LT(enemies[0]->getCurrentHealth(), enemies[0]->getMaxHealth());
+    EXPECT_LT(copy->getCurrentHealth(), copy->getMaxHealth());
+    EXPECT_EQ(test->getCurrentHealth(), test->getMaxHealth());
+    delete enemies[0];
+    delete copy;
+    delete test;
+}
+//Check that changing a class's growth only changes the levels gained after it
+TEST(AdventurerSuite, SetGrowthAppliesToLaterLevels) {
+    Adventurer* test = new Samurai("TestSamurai","Just a test samurai");
+    test->applyLevels(2);
+    int health = test->getMaxHealth(), attack = test->getPAtk(), speed = test->getSpeed();
+    test->setGrowth(StatGrowth{10, 0, 0, 0, 0, 3});
+    EXPECT_EQ(test->getMaxHealth(), health);
+    test->applyLevels(2);
+    EXPECT_EQ(test->getMaxHealth(), health + 20);
+    EXPECT_EQ(test->getPAtk(), attack);
+    EXPECT_EQ(test->getSpeed(), speed + 6);
+    EXPECT_EQ(test->getGrowth().hp, 10);
+    delete test;
+}
 //----- AdventureSuite tests complete -----
 
 #endif
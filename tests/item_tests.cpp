@@ -2,6 +2,8 @@
 #define __ITEM_TESTS__
 
 #include "./../headers/Item.hpp"
+#include "./../headers/ItemCooldowns.hpp"
+#include "./../headers/Loot.hpp"
 #include "./../headers/Factory.hpp"
 #include "./../headers/Entity.hpp"
 #include "./../source/Warrior.cpp"
@@ -85,5 +87,131 @@ TEST(ItemSuite, InventoryAllItems) {
     }
     delete testPlayer;
 }
+//Check if consumables stack into one slot and can be found by ID
+TEST(ItemSuite, InventoryStacksConsumables) {
+    Inventory bag;
+    for (unsigned i = 0; i < 3; ++i) bag.add(iFactory.generate(20004)); //3 potions
+    bag.add(iFactory.generate(20001));
+    bag.add(iFactory.generate(20001)); //2 blades, these don't stack
+    EXPECT_EQ(bag.size(), 5);
+    EXPECT_EQ(bag.slotCount(), 3);
+    EXPECT_EQ(bag.count(20004), 3);
+    EXPECT_EQ(bag.count(20001), 2);
+    ASSERT_NE(bag.find(20004), -1);
+    EXPECT_EQ(bag.at(bag.find(20004))->getID(), 20004);
+    EXPECT_EQ(bag.find(20009), -1);
+
+    //use up every potion, the slot should disappear and the blades should still be indexed
+    for (unsigned i = 0; i < 3; ++i) bag.consume(bag.find(20004));
+    EXPECT_EQ(bag.find(20004), -1);
+    EXPECT_EQ(bag.slotCount(), 2);
+    ASSERT_NE(bag.find(20001), -1);
+    EXPECT_EQ(bag.at(bag.find(20001))->getID(), 20001);
+}
+
+//Check if big bags are split into pages and filters are respected
+TEST(ItemSuite, InventoryPagedViews) {
+    Inventory bag;
+    for (unsigned i = 0; i < 25; ++i) bag.add(iFactory.generate(20001));
+    bag.add(iFactory.generate(20005));
+    bool hasMore = false;
+    EXPECT_EQ(bag.view(nullptr, 0, 10, hasMore).size(), 10);
+    EXPECT_TRUE(hasMore);
+    EXPECT_EQ(bag.view(nullptr, 2, 10, hasMore).size(), 6);
+    EXPECT_FALSE(hasMore);
+    std::vector<unsigned> potions = bag.view(consumablesOnly, 0, 10, hasMore);
+    ASSERT_EQ(potions.size(), 1);
+    EXPECT_EQ(bag.at(potions[0])->getID(), 20005);
+    EXPECT_FALSE(hasMore);
+}
+//Check if items on cooldown are ticked back to ready and then dropped from the active list
+TEST(ItemSuite, ItemCooldownsTickActiveItems) {
+    Entity* user = new Warrior("Test", "Test");
+    Entity* target = new TEST_DUMMY();
+    Item* orb = iFactory.generate(20009);
+    Item* blade = iFactory.generate(20001);
+    ItemCooldowns cooldowns;
+
+    cooldowns.track(blade); //no cooldown, nothing to track
+    EXPECT_EQ(cooldowns.size(), 0);
+    orb->ability(user, target);
+    cooldowns.track(orb);
+    cooldowns.track(orb); //tracking twice does nothing
+    EXPECT_EQ(cooldowns.size(), 1);
+    for (int i = 0; i < orb->getMaxCooldown(); ++i){
+        EXPECT_FALSE(orb->abilityAvailable());
+        cooldowns.tick();
+    }
+    EXPECT_TRUE(orb->abilityAvailable());
+    EXPECT_EQ(cooldowns.size(), 0);
+
+    delete orb;
+    delete blade;
+    delete user;
+    delete target;
+}
+//Check if the alias table rolls outcomes in proportion to their weights
+TEST(ItemSuite, AliasTableMatchesWeights) {
+    srand(31);
+    AliasTable die({1, 2, 7, 0});
+    int counts[4] = {0, 0, 0, 0};
+    const int rolls = 200000;
+    for (int i = 0; i < rolls; ++i) ++counts[die.sample()];
+    EXPECT_NEAR((double)counts[0] / rolls, 0.1, 0.01);
+    EXPECT_NEAR((double)counts[1] / rolls, 0.2, 0.01);
+    EXPECT_NEAR((double)counts[2] / rolls, 0.7, 0.01);
+    EXPECT_EQ(counts[3], 0); //zero weight outcomes never come up
+}
+
+//Check if every enemy's loot tables only list real, non-unique items with the right rarity
+TEST(ItemSuite, EnemyLootTablesMatchItems) {
+    EnemyFactory eFactory;
+    for (unsigned id = 10001; id < 10001 + NUM_ENEMIES; ++id) {
+        Enemy* enemy = eFactory.generate(id);
+        const LootTable* tables[] = {&enemy->lootTable(), &enemy->bossLootTable()};
+        for (const LootTable* table : tables) {
+            for (unsigned i = 0; i < table->dropCount(); ++i) {
+                Item* item = iFactory.generate(table->dropAt(i).itemID);
+                EXPECT_EQ(item->getRarity(), table->dropAt(i).rarity) << enemy->getName() << " drops " << item->getName();
+                EXPECT_NE(item->getRarity(), Unique);
+                delete item;
+            }
+        }
+        enemy->setBoss(true);
+        EXPECT_NE(enemy->rollDrop(), 0); //bosses always drop something
+        delete enemy;
+    }
+}
+//Check if the content index covers every item and answers the queries the Store relies on
+TEST(ItemSuite, ContentIndexQueries) {
+    for (unsigned i = 1; i <= NUM_ITEMS; ++i) {
+        ASSERT_TRUE(contentIndex().contains(20000 + i));
+        Item* item = iFactory.generate(20000 + i);
+        const ContentDef& def = contentIndex().get(20000 + i);
+        EXPECT_EQ(def.attrs[ATTR_VALUE], item->getValue());
+        EXPECT_EQ(def.attrs[ATTR_RARITY], item->getRarity());
+        EXPECT_EQ((def.tags & tagSet({TAG_CONSUMABLE})) != 0, item->isConsumable());
+        delete item;
+    }
+    std::vector<unsigned> cheapPotions = contentIndex().query(ContentQuery().with(TAG_CONSUMABLE).with(TAG_SHOP).atMost(ATTR_VALUE, 99));
+    EXPECT_EQ(cheapPotions, std::vector<unsigned>({20004, 20005}));
+    std::vector<unsigned> earlyUndead = contentIndex().query(ContentQuery().with(TAG_ENEMY).with(TAG_UNDEAD).atMost(ATTR_MIN_LEVEL, 2));
+    EXPECT_EQ(earlyUndead, std::vector<unsigned>({10001, 10004}));
+    EXPECT_EQ(contentIndex().count(ContentQuery().with(TAG_ITEM).with(TAG_SHOP).without(TAG_CONSUMABLE)), 5);
+
+    //a catalogue spanning several words agrees with checking every definition by hand
+    std::vector<ContentDef> defs;
+    for (unsigned i = 0; i < 200; ++i) defs.push_back(ContentDef{i + 1, (uint64_t)(i % 7), {(int)(i % 13), 0, (int)i, 0, 0}});
+    ContentIndex big(defs);
+    ContentQuery q = ContentQuery().with((ContentTag)1).without((ContentTag)2).between(ATTR_MIN_LEVEL, 3, 8);
+    std::vector<unsigned> expected;
+    for (const ContentDef& d : defs) {
+        if ((d.tags & 2) && !(d.tags & 4) && d.attrs[ATTR_MIN_LEVEL] >= 3 && d.attrs[ATTR_MIN_LEVEL] <= 8) expected.push_back(d.id);
+    }
+    EXPECT_EQ(big.query(q), expected);
+    EXPECT_EQ(big.count(q), expected.size());
+    unsigned picked = big.sample(q);
+    EXPECT_NE(std::find(expected.begin(), expected.end(), picked), expected.end());
+}
 //----- ItemSuite tests end -----
 #endif
@@ -1,9 +1,19 @@
 #ifndef __ROOM_TESTS__
 #define __ROOM_TESTS__
 
+#include <unordered_set>
+
 #include "./../headers/Room.hpp"
 #include "./../headers/Factory.hpp"
+#include "./../source/CombatRoom.cpp"
+#include "./../source/Quest.cpp"
+#include "./../source/EndlessQuest.cpp"
 #include "./../source/Warrior.cpp"
+#include "./../source/Samurai.cpp"
+#include "./../headers/SaveGame.hpp"
+#include "./../headers/CombatSearch.hpp"
+#include "./../headers/CombatSolver.hpp"
+#include "./../headers/TurnPreview.hpp"
 
 #include "gtest/gtest.h"
 
@@ -29,6 +39,21 @@ TEST(RoomSuite, ConstructDestructAllRooms) {
     }
 }
 
+//Check that ambient rooms read their text from the shared table
+TEST(RoomSuite, AmbientRoomsShareText) {
+    for (unsigned i = 1; i <= NUM_AMBIENT_ROOMS; ++i) {
+        Room* first = rFactory.generate(i + 35000);
+        Room* second = rFactory.generate(i + 35000);
+        EXPECT_EQ(first->getName(), AmbientRoom::nameOf(i + 35000));
+        EXPECT_EQ(first->getName(), second->getName());
+        EXPECT_NE(first->getName(), "unknown");
+        delete first;
+        delete second;
+    }
+    EXPECT_EQ(AMBIENT_ROOM_COUNT, NUM_AMBIENT_ROOMS);
+    EXPECT_FALSE(AmbientRoom::isAmbient(35000 + NUM_AMBIENT_ROOMS + 1));
+}
+
 //Check if exits can be added and received properly
 TEST(RoomSuite, RoomsCanExit) {
     Room* test1 = nullptr;
@@ -38,7 +63,7 @@ TEST(RoomSuite, RoomsCanExit) {
         test2 = rFactory.generate(i + 30001);
         test1->addExit(test2);
         test1->getExitLabels();
-        EXPECT_TRUE(test1->getExit(1).getName() != "");
+        EXPECT_TRUE(test1->getExit(1)->getName() != "");
         delete test1;
         delete test2;
     }
@@ -47,9 +72,615 @@ TEST(RoomSuite, RoomsCanExit) {
         test2 = rFactory.generate(i + 35001);
         test1->addExit(test2);
         test1->getExitLabels();
-        EXPECT_TRUE(test1->getExit(1).getName() != "");
+        EXPECT_TRUE(test1->getExit(1)->getName() != "");
         delete test1;
         delete test2;
     }
 }
+
+//Check that exit lookups find the right room by label, number or id, and miss cleanly
+TEST(RoomSuite, ExitLookupByLabel) {
+    Room hub("Hub", "A room with a lot of doors.");
+    std::vector<Room*> spokes;
+    for (unsigned i = 0; i < 40; ++i) {
+        spokes.push_back(new Room("Spoke " + std::to_string(i), ""));
+        hub.addExit(spokes.back());
+    }
+    Room side("Side", "");
+    hub.addExit(&side, "north");
+    hub.addExit(spokes[0], "north"); // the first exit keeps a repeated label
+
+    EXPECT_EQ(hub.exitCount(), 42);
+    EXPECT_EQ(hub.getExitLabels().size(), 42);
+    for (unsigned i = 0; i < 40; ++i) {
+        EXPECT_EQ(hub.getExit(i + 1), spokes[i]);
+        EXPECT_EQ(hub.getExit(std::to_string(i + 1)), spokes[i]);
+        EXPECT_EQ(hub.getExitById(i), spokes[i]);
+    }
+    EXPECT_EQ(hub.getExit("north"), &side);
+    EXPECT_EQ(hub.getExit(0), nullptr);
+    EXPECT_EQ(hub.getExit(41), nullptr);
+    EXPECT_EQ(hub.getExit("south"), nullptr);
+    EXPECT_EQ(hub.getExitById(42), nullptr);
+
+    hub.addExitLabel("down"); // an exit with only a label, the way quest rooms get theirs
+    EXPECT_EQ(hub.exitId("down"), 42u);
+    EXPECT_EQ(hub.exitId("up"), Room::NO_EXIT);
+    EXPECT_EQ(hub.getExit("down"), nullptr);
+    hub.printExits();
+    for (Room* r : spokes) delete r;
+}
+
+//Check if a whole party shares the turn bar with the enemies
+TEST(RoomSuite, PartySharesTurnScheduler) {
+    std::vector<Adventurer*> party;
+    for (unsigned i = 0; i < 3; ++i) party.push_back(new Warrior("Test Warrior","Just a test warrior"));
+    CombatRoom* test = new CombatRoom("Arena", "A test arena.", "Done.");
+    Enemy* skeleton = eFactory.generate(10001);
+    Enemy* rat = eFactory.generate(10002);
+    test->addEnemy(skeleton);
+    test->addEnemy(rat);
+    test->linkParty(party);
+    test->startCombat();
+    test->updateTurn();
+
+    //somebody has to be ready to act, but nobody could have been ready a tick earlier
+    std::vector<Entity*> everyone(party.begin(), party.end());
+    everyone.push_back(skeleton);
+    everyone.push_back(rat);
+    bool someoneReady = false;
+    for (auto e : everyone) {
+        if (e->getTurnBar() >= MAX_TURN_BAR) someoneReady = true;
+        EXPECT_LT(e->getTurnBar() - e->getSpeed(), MAX_TURN_BAR);
+    }
+    EXPECT_TRUE(someoneReady);
+    EXPECT_FALSE(test->combatOver());
+    test->printTurnBar();
+
+    delete test;
+    for (auto p : party) delete p;
+}
+
+//Check that a member who fell in an earlier room isn't penalized again by the next fight
+TEST(RoomSuite, FallenMembersPenalizedOnce) {
+    MutedOutput muted;
+    std::vector<Adventurer*> party;
+    for (unsigned i = 0; i < 2; ++i) party.push_back(new Warrior("Test Warrior","Just a test warrior"));
+    party[1]->setHealth(0);
+    int gold = party[1]->getGold();
+    CombatRoom* won = new CombatRoom("Arena", "A test arena.", "Done."); //nothing left to fight, so the party wins straight away
+    won->linkParty(party);
+    won->interact();
+    EXPECT_EQ(party[1]->getGold(), gold);
+
+    party[0]->setHealth(0);
+    CombatRoom* lost = new CombatRoom("Arena", "A test arena.", "Done."); //nobody left standing to fight it
+    lost->addEnemy(eFactory.generate(10001));
+    lost->linkParty(party);
+    lost->interact();
+    EXPECT_EQ(party[1]->getGold(), gold);
+
+    delete won;
+    delete lost;
+    for (auto p : party) delete p;
+}
+
+//Check that a practice bout puts the party back but not the dice, so it can't be used to see a real fight's rolls ahead
+TEST(RoomSuite, PracticeLeavesDiceRolled) {
+    MutedOutput muted;
+    Adventurer* hero = new Warrior("Test Warrior","Just a test warrior");
+    hero->applyLevels(9);
+    std::vector<Adventurer*> party{hero};
+    CombatRoom* yard = new CombatRoom("Training Yard", "A test yard.", "Done.");
+    yard->addEnemy(eFactory.generate(10002));
+    yard->linkParty(party);
+    yard->setPractice(true);
+    int health = hero->getCurrentHealth();
+
+    //attack the first target and go on every time the fight asks
+    std::string answers;
+    for (int i = 0; i < 2000; ++i) answers += "1\n";
+    std::istringstream input(answers);
+    std::streambuf* keyboard = std::cin.rdbuf(input.rdbuf());
+    combatDice().seed(11);
+    yard->interact();
+    std::cin.rdbuf(keyboard);
+
+    EXPECT_EQ(hero->getCurrentHealth(), health);
+    EXPECT_NE(combatDice(), CombatDice(11)); //a real fight now picks up where the bout left off
+    delete yard;
+    delete hero;
+}
+
+//Check that a snapshot puts a whole fight back, rolls included, and that branches and later snapshots share what didn't change
+TEST(RoomSuite, CombatSnapshotBranches) {
+    MutedOutput muted;
+    ItemFactory items;
+    Adventurer* hero = new Samurai("Test Samurai","Just a test samurai");
+    hero->applyLevels(9);
+    hero->addItem(items.generate(20004));
+    hero->addItem(items.generate(20004));
+    Item* knife = items.generate(20013);
+    hero->addItem(knife);
+    std::vector<Adventurer*> party{hero};
+    std::vector<Enemy*> foes{eFactory.generate(10001), eFactory.generate(10004), eFactory.generate(10002)};
+    for (auto e : foes) e->initializeOrigStats();
+    hero->initializeOrigStats();
+    knife->ability(hero, nullptr); //unsheathed, the knife now carries state
+    knife = nullptr; //restoring may make the bag over again
+    CombatTally tally;
+    combatDice().seed(7);
+
+    //plays a few rounds out the way CombatRoom would, then drinks both potions, and describes how it went
+    auto play = [&]() {
+        for (int round = 0; round < 6 && hero->isAlive() && !foes.empty(); ++round) {
+            for (auto e : foes) e->turn(hero);
+            hero->autoTurn(foes);
+            for (std::vector<Enemy*>::iterator it = foes.begin(); it != foes.end(); ) {
+                if ((*it)->isAlive()) { ++it; continue; }
+                tally.goldReward += (*it)->getGoldReward();
+                tally.drops.push_back((*it)->rollDrop());
+                delete *it;
+                it = foes.erase(it);
+            }
+            ++tally.turn;
+        }
+        SaveGame::loseItems(hero, 20004, 0, 2);
+        std::vector<int> outcome{hero->getCurrentHealth(), hero->getInvSize(), tally.goldReward, (int)tally.drops.size()};
+        for (auto e : foes) outcome.push_back(e->getCurrentHealth());
+        outcome.push_back(combatDice()());
+        return outcome;
+    };
+
+    CombatSnapshot start = CombatSnapshot::take(party, foes, tally);
+    EXPECT_EQ(start.pieces(), 6u);
+    std::vector<int> first = play();
+    EXPECT_EQ(first[1], 1); //only the knife is left
+
+    //everything comes back: stats, class resources, cooldowns, the bag and the knife's state, fallen enemies and the totals
+    start.restore(party, foes, tally);
+    EXPECT_TRUE(hero->captureCombatState() == start.hero(0));
+    EXPECT_EQ(hero->getInvSize(), 3);
+    EXPECT_EQ(foes.size(), 3u);
+    EXPECT_EQ(tally.turn, 1);
+    EXPECT_EQ(tally.goldReward, 0);
+
+    //and the same choices roll the same way
+    EXPECT_EQ(play(), first);
+
+    //branching only copies pointers
+    start.restore(party, foes, tally);
+    std::vector<CombatSnapshot> branches(2000, start);
+    EXPECT_EQ(branches.back().sharedWith(start), start.pieces());
+
+    //a snapshot based on an earlier one only owns what changed
+    foes[1]->turn(hero); //the Shield Skeleton puts its shield up
+    CombatSnapshot later = CombatSnapshot::take(party, foes, tally, &start);
+    EXPECT_EQ(later.sharedWith(start), start.pieces() - 1);
+    start.restore(party, foes, tally);
+    EXPECT_EQ(foes[1]->dealPDamage(10), 10); //no shield to soak it up
+    later.restore(party, foes, tally);
+    EXPECT_EQ(foes[1]->dealPDamage(10), 0);
+
+    for (auto p : party) delete p;
+    for (auto e : foes) delete e;
+}
+
+//Check if encounter tables only hand out entries inside their level brackets
+TEST(RoomSuite, EncounterTableLevelBrackets) {
+    EncounterTable table({{1, 1, 1, 3}, {2, 1, 2}});
+    bool seen[3] = {false, false, false};
+    for (unsigned i = 0; i < 200; ++i) {
+        EXPECT_EQ(table.sample(1), 1);
+        EXPECT_EQ(table.sample(LEVEL_CAP), 2);
+        seen[table.sample(3)] = true;
+    }
+    EXPECT_TRUE(seen[1] && seen[2]); //both are allowed at level 3
+    EXPECT_FALSE(EncounterTable({{1, 1, 5}}).available(4));
+}
+
+//Check if generated dungeons are connected, deterministic, and keep locked areas behind their gates
+TEST(RoomSuite, DungeonGeneratorLayout) {
+    for (unsigned rooms : {10u, 1000u, 100000u}) {
+        DungeonParams params{rooms, rooms / 5, rooms / 50 + 1, rooms / 10, rooms / 10};
+        DungeonGraph dungeon = generateDungeon(params, 34);
+        ASSERT_EQ(dungeon.roomCount(), rooms);
+        EXPECT_TRUE(dungeon.validate());
+        EXPECT_EQ(dungeon.kind(dungeon.boss), ROOM_BOSS);
+        EXPECT_EQ(dungeon.exitCount(dungeon.boss), 0);
+        EXPECT_EQ(generateDungeon(params, 34).targets, dungeon.targets); //same seed, same dungeon
+
+        std::vector<unsigned> route = dungeon.routeToBoss();
+        ASSERT_GE(route.size(), 2u);
+        EXPECT_EQ(route.front(), dungeon.start);
+        EXPECT_EQ(route.back(), dungeon.boss);
+        for (unsigned i = 1; i < route.size(); ++i) {
+            bool linked = false;
+            for (unsigned k = 0; k < dungeon.exitCount(route[i - 1]); ++k) linked |= dungeon.exit(route[i - 1], k) == route[i];
+            EXPECT_TRUE(linked);
+            EXPECT_NE(dungeon.kind(route[i]), ROOM_GATE); //side areas are never on the way
+        }
+
+        unsigned gate = rooms;
+        for (unsigned i = 0; i < rooms && gate == rooms; ++i) {
+            if (dungeon.kind(i) == ROOM_GATE) gate = i;
+        }
+        ASSERT_NE(gate, rooms);
+        std::vector<bool> seen = dungeon.reachable(gate);
+        for (unsigned i = 0; i < rooms; ++i) {
+            if (dungeon.areas[i] == gate) {
+                EXPECT_FALSE(seen[i]); //no way in without going through the gate
+            }
+        }
+    }
+}
+
+//Check if biome quests always follow their layout rules
+TEST(RoomSuite, BiomeQuestsFollowLayout) {
+    for (const Biome& biome : biomeCatalog()) {
+        for (int level : {1, 10, LEVEL_CAP}) {
+            ASSERT_TRUE(biome.enemies.available(level));
+            Quest quest(100, eFactory.generate(10001), "Test ", biome, level);
+            //walk every room the player could reach
+            std::vector<unsigned> frontier(1, quest.start());
+            std::unordered_set<unsigned> seen(frontier.begin(), frontier.end());
+            unsigned arenas = 0, gates = 0, bosses = 0;
+            while (!frontier.empty()) {
+                unsigned at = frontier.back();
+                frontier.pop_back();
+                Room* room = quest.enter(at);
+                if (room->getName() == "Arena") ++arenas;
+                if (room->getName() == "Guarded gate") ++gates;
+                if (room->getName() == "Boss Arena") ++bosses;
+                for (unsigned k = 0; k < quest.layout().exitCount(at); ++k) {
+                    unsigned next = quest.exitTo(at, quest.layout().exitLabel(at, k));
+                    ASSERT_NE(next, Quest::NO_ROOM);
+                    if (seen.insert(next).second) frontier.push_back(next);
+                }
+                quest.leave(at);
+            }
+            EXPECT_EQ(seen.size(), biome.layout.dungeon.rooms);
+            EXPECT_EQ(arenas, biome.layout.dungeon.arenas);
+            EXPECT_EQ(gates, biome.layout.dungeon.lockedAreas);
+            EXPECT_EQ(bosses, 1);
+        }
+    }
+}
+
+//Check that quest rooms are only built when entered, come out the same every time, and plain ones are freed on leaving
+TEST(RoomSuite, QuestRoomsBuiltOnEntry) {
+    const Biome& biome = biomeCatalog()[2];
+    Quest quest(100, eFactory.generate(10001), "Test ", biome, 5);
+    EXPECT_EQ(quest.roomsBuilt(), 0);
+    EXPECT_EQ(quest.roomCount(), biome.layout.dungeon.rooms);
+
+    for (unsigned i = 0; i < quest.roomCount(); ++i) {
+        std::string expected = quest.roomName(i); //worked out without building the room
+        EXPECT_EQ(quest.roomsBuilt(), 0);
+        EXPECT_EQ(quest.enter(i)->getName(), expected);
+        EXPECT_EQ(quest.roomsBuilt(), 1);
+        quest.leave(i);
+        if (quest.layout().kind(i) == ROOM_AMBIENT) {
+            EXPECT_EQ(quest.roomsBuilt(), 0);
+            EXPECT_EQ(quest.enter(i)->getName(), expected); //built again the same way
+            quest.leave(i);
+            EXPECT_EQ(quest.roomsBuilt(), 0);
+        } else {
+            EXPECT_EQ(quest.roomsBuilt(), 1); //fights and oddities remember what happened in them
+            Quest* fresh = new Quest(100, eFactory.generate(10001), "Test ", biome, 5);
+            delete fresh; //an unbuilt boss room still cleans up its boss
+            break;
+        }
+    }
+    EXPECT_EQ(quest.exitTo(quest.start(), "0"), Quest::NO_ROOM);
+    EXPECT_EQ(quest.exitTo(quest.start(), "north"), Quest::NO_ROOM);
+    EXPECT_EQ(quest.exitTo(quest.start(), "1"), quest.layout().exit(quest.start(), 0));
+}
+
+//The search should see that finishing off a nearly dead enemy beats hitting a fresh one, and leave the fight untouched
+TEST(RoomSuite, CombatSearchFinishesTheWeakOne) {
+    MutedOutput muted;
+    Adventurer* hero = new Warrior("Test Warrior","Just a test warrior");
+    std::vector<Enemy*> foes{eFactory.generate(10001), eFactory.generate(10001)};
+    for (auto e : foes) e->initializeOrigStats();
+    hero->initializeOrigStats();
+    hero->setHealth(80);
+    hero->setTurnBar(MAX_TURN_BAR);
+    EnemyState weak = foes[1]->captureEnemyState();
+    weak.entity.health = 1;
+    foes[1]->restoreEnemyState(weak);
+    combatDice().seed(3);
+    HeroState before = hero->captureCombatState();
+    uint64_t position = CombatSearch::positionHash(hero, foes);
+
+    CombatSearch search(hero, foes);
+    SearchResult result = search.run(std::chrono::milliseconds(5000), 1, 3000);
+    ASSERT_FALSE(result.empty());
+    EXPECT_GE(result.playouts, 3000u);
+    EXPECT_EQ(result.best().target, 1);
+    EXPECT_GT(search.positions(), 1u);
+    //every playout starts with one of the moves, and the moves are all there is to do
+    unsigned visits = 0;
+    for (const ActionScore& score : result.scores) visits += score.visits;
+    EXPECT_EQ(visits, result.playouts);
+    EXPECT_EQ(result.scores.size(), legalActions(hero, foes).size());
+
+    EXPECT_TRUE(hero->captureCombatState() == before);
+    EXPECT_EQ(CombatSearch::positionHash(hero, foes), position);
+    EXPECT_EQ(combatDice()(), CombatDice(3)());
+    for (auto e : foes) delete e;
+    delete hero;
+}
+
+//Used as the player, the search wins a fight on its own, and can use items as well as abilities
+TEST(RoomSuite, CombatSearchPlaysAFight) {
+    MutedOutput muted;
+    ItemFactory items;
+    Adventurer* hero = new Samurai("Test Samurai","Just a test samurai");
+    hero->applyLevels(9);
+    hero->addItem(items.generate(20004));
+    std::vector<Enemy*> foes{eFactory.generate(10002), eFactory.generate(10001), eFactory.generate(10002)};
+    for (auto e : foes) e->initializeOrigStats();
+    hero->initializeOrigStats();
+    combatDice().seed(11);
+    std::vector<CombatAction> moves = legalActions(hero, foes);
+    EXPECT_TRUE(std::find_if(moves.begin(), moves.end(), [](const CombatAction& a) { return a.kind == CombatAction::ITEM && a.target == -1; }) != moves.end());
+
+    int turns = 0;
+    while (hero->isAlive() && !foes.empty() && turns < 100) {
+        hero->setTurnBar(MAX_TURN_BAR);
+        searchTurn(hero, foes, std::chrono::milliseconds(10), 2);
+        hero->updateBuffs();
+        for (std::vector<Enemy*>::iterator it = foes.begin(); it != foes.end(); ) {
+            if ((*it)->isAlive()) { ++it; continue; }
+            delete *it;
+            it = foes.erase(it);
+        }
+        for (auto e : foes) if (hero->isAlive()) e->turn(hero);
+        ++turns;
+    }
+    EXPECT_TRUE(hero->isAlive());
+    EXPECT_TRUE(foes.empty());
+    for (auto e : foes) delete e;
+    delete hero;
+}
+
+//The solver's odds are what playing the fight out thousands of times comes to, and chance() rolls like roll(100) did
+TEST(RoomSuite, CombatSolverMatchesPlayouts) {
+    combatDice().seed(5);
+    std::vector<bool> rolled;
+    for (int i = 0; i < 50; ++i) rolled.push_back(roll(100) < 30);
+    combatDice().seed(5);
+    for (int i = 0; i < 50; ++i) EXPECT_EQ(chance(30), rolled[i]);
+
+    Adventurer* hero = new Warrior("Test Warrior","Just a test warrior");
+    hero->setHealth(40);
+    std::vector<Enemy*> foes{eFactory.generate(10007), eFactory.generate(10009)};
+    CombatSolver solver;
+    FightOdds odds = solver.solve(hero, foes);
+    EXPECT_TRUE(odds.exact);
+    EXPECT_GT(odds.winChance, 0.05);
+    EXPECT_LT(odds.winChance, 0.95);
+    EXPECT_GE(odds.expectedTurns, 1.0);
+
+    //solving it again only looks up what was worked out the first time
+    FightOdds again = solver.solve(hero, foes);
+    EXPECT_DOUBLE_EQ(again.winChance, odds.winChance);
+    EXPECT_LT(again.branches, odds.branches);
+
+    const int runs = 4000;
+    int wins = 0;
+    {
+        MutedOutput muted;
+        for (int i = 0; i < runs; ++i) {
+            Adventurer* copy = hero->clone();
+            std::vector<Enemy*> fight;
+            CombatTally tally;
+            CombatSnapshot::take(std::vector<Adventurer*>{hero}, foes, tally).restore(std::vector<Adventurer*>{copy}, fight, tally);
+            combatDice().seed(i + 1);
+            wins += simulateFight(copy, fight);
+            delete copy;
+        }
+    }
+    //well within four standard deviations of the playouts
+    double spread = 4 * sqrt(odds.winChance * (1 - odds.winChance) / runs);
+    EXPECT_NEAR((double)wins / runs, odds.winChance, spread);
+    for (auto e : foes) delete e;
+    delete hero;
+}
+
+//Seeding both generators plays a fight out the same way again, and the turns it took are counted
+TEST(RoomSuite, SeededFightsRepeat) {
+    Adventurer* hero = new Warrior("Test Warrior","Just a test warrior");
+    unsigned turns[2] = {0, 0};
+    int health[2], speed[2];
+    for (int i = 0; i < 2; ++i) {
+        MutedOutput muted;
+        spawnDice().seed(7);
+        combatDice().seed(11);
+        std::vector<Enemy*> fight{eFactory.generate(10002), eFactory.generate(10009)};
+        speed[i] = fight[0]->getSpeed();
+        Adventurer* copy = hero->clone();
+        simulateFight(copy, fight, &turns[i]);
+        health[i] = copy->getCurrentHealth();
+        delete copy;
+    }
+    EXPECT_EQ(speed[0], speed[1]);
+    EXPECT_EQ(health[0], health[1]);
+    EXPECT_EQ(turns[0], turns[1]);
+    EXPECT_GT(turns[0], 1u);
+    EXPECT_LE(turns[0], SIM_TURN_LIMIT);
+    delete hero;
+}
+
+//The preview fills in every move in the background, without touching the fight, and stops when told to
+TEST(RoomSuite, TurnPreviewFillsInMoves) {
+    ItemFactory items;
+    Adventurer* hero = new Warrior("Test Warrior","Just a test warrior");
+    hero->addItem(items.generate(20004));
+    std::vector<Enemy*> foes{eFactory.generate(10001), eFactory.generate(10002)};
+    for (auto e : foes) e->initializeOrigStats();
+    hero->initializeOrigStats();
+    hero->setTurnBar(MAX_TURN_BAR);
+    combatDice().seed(9);
+    HeroState before = hero->captureCombatState();
+
+    CombatAction hit, potion, nothing;
+    hit.target = 1;
+    potion.kind = CombatAction::ITEM;
+    potion.index = 0;
+    nothing.kind = CombatAction::ABILITY;
+    nothing.index = 3;
+    TurnPreview preview(hero, foes);
+    for (int wait = 0; wait < 500 && preview.tries(potion) < PREVIEW_MIN_TRIES; ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_FALSE(preview.note(hit).empty());
+    EXPECT_NE(preview.note(potion).find("0% kill, 100% safe"), std::string::npos);
+    EXPECT_TRUE(preview.note(nothing).empty());
+    EXPECT_EQ(preview.tries(nothing), 0u);
+
+    preview.stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    unsigned settled = preview.tries(hit);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(preview.tries(hit), settled);
+    EXPECT_LT(settled, PREVIEW_MAX_TRIES);
+
+    EXPECT_TRUE(hero->captureCombatState() == before);
+    EXPECT_EQ(foes[0]->getCurrentHealth(), foes[0]->getMaxHealth());
+    EXPECT_EQ(combatDice()(), CombatDice(9)());
+    for (auto e : foes) delete e;
+    delete hero;
+}
+
+//Check that an endless run only ever holds a few floors, however deep it goes, and gets harder on the way down
+TEST(RoomSuite, EndlessQuestBoundedWindow) {
+    Warrior* player = new Warrior("Test Warrior","Just a test warrior");
+    EndlessQuest quest(20, 1);
+    quest.linkPlayers(player);
+    unsigned at = quest.start();
+    EXPECT_EQ(quest.enter(at)->getName(), "The top of the stairs");
+    for (unsigned floor = 1; floor <= 200; ++floor) {
+        EXPECT_EQ(quest.exitTo(at, "9"), Quest::NO_ROOM);
+        unsigned next = quest.exitTo(at, "1");
+        ASSERT_NE(next, Quest::NO_ROOM);
+        at = next;
+        Room* room = quest.enter(at);
+        ASSERT_TRUE(room != nullptr);
+        if (floor % 5 == 0) {
+            EXPECT_EQ(room->getName(), "Guarded stairs");
+        }
+        EXPECT_EQ(quest.getDepth(), floor);
+        EXPECT_LE(quest.roomsHeld(), 1 + ENDLESS_AHEAD * ENDLESS_LANES);
+    }
+    EXPECT_LT(quest.levelAt(1), quest.levelAt(200));
+    EXPECT_EQ(quest.getReward(), 20 * 200);
+    EXPECT_TRUE(quest.enter(quest.exitTo(at, "0"))->isEnd());
+    delete player;
+}
+
+//Check that a run's floors come out the same from the same seed, down to the enemies' stats, and that leaving doesn't sum up twice
+TEST(RoomSuite, EndlessQuestSameSeedSameFloors) {
+    Warrior* player = new Warrior("Test Warrior","Just a test warrior");
+    EndlessQuest first(20, 1, 1234), second(20, 1, 1234);
+    first.linkPlayers(player);
+    second.linkPlayers(player);
+    unsigned at = first.start();
+    for (unsigned floor = 1; floor <= 30; ++floor) {
+        std::string lane = std::to_string(1 + floor % 2);
+        unsigned next = first.exitTo(at, lane);
+        if (next == Quest::NO_ROOM) { lane = "1"; next = first.exitTo(at, lane); }
+        ASSERT_EQ(second.exitTo(at, lane), next);
+        at = next;
+        Room* a = first.enter(at);
+        Room* b = second.enter(at);
+        ASSERT_EQ(a->getName(), b->getName());
+        CombatRoom* fightA = dynamic_cast<CombatRoom*>(a);
+        CombatRoom* fightB = dynamic_cast<CombatRoom*>(b);
+        ASSERT_EQ(fightA == nullptr, fightB == nullptr);
+        if (fightA != nullptr) {
+            ASSERT_EQ(fightA->getEnemies().size(), fightB->getEnemies().size());
+            for (unsigned e = 0; e < fightA->getEnemies().size(); ++e) {
+                EXPECT_EQ(fightA->getEnemies()[e]->getID(), fightB->getEnemies()[e]->getID());
+                EXPECT_EQ(fightA->getEnemies()[e]->getSpeed(), fightB->getEnemies()[e]->getSpeed());
+            }
+        }
+    }
+    unsigned out = first.exitTo(at, "0");
+    EXPECT_FALSE(first.replaysEnd(out));
+    EXPECT_TRUE(first.replaysEnd(at));
+    delete player;
+}
+
+//Stand-in player for running events without a real adventurer
+class TestActor : public EventActor {
+public:
+    int stats[NUM_EVENT_STATS] = {50, 50, 100, 0, 100, 100, 1};
+    std::vector<int> items;
+    std::string name() { return "Tester"; }
+    int stat(EventStat s) { return stats[s]; }
+    int apply(EventEffect effect, int amount) {
+        if (effect == EFFECT_GOLD) stats[STAT_GOLD] += amount;
+        if (effect == EFFECT_PDAMAGE || effect == EFFECT_MDAMAGE) stats[STAT_HEALTH] -= amount;
+        if (effect == EFFECT_ITEM) items.push_back(amount);
+        return amount;
+    }
+};
+
+//Check that the oddity events compile and follow their choices, stat checks and counters
+TEST(RoomSuite, OddityEventGraphs) {
+    const EventPack& pack = oddityEvents();
+    EXPECT_EQ(pack.eventCount(), NUM_ODDITY_ROOMS);
+    std::mt19937 rng(39);
+
+    TestActor smasher;
+    ScriptedChooser smash({2});
+    runEvent(pack, 30001, smasher, smash, rng, nullptr);
+    EXPECT_GE(smasher.stats[STAT_GOLD], 100);
+    EXPECT_LE(smasher.stats[STAT_GOLD], 299);
+
+    TestActor slow, fast;
+    fast.stats[STAT_SPEED] = 150;
+    ScriptedChooser none({});
+    runEvent(pack, 30002, slow, none, rng, nullptr);
+    runEvent(pack, 30002, fast, none, rng, nullptr);
+    EXPECT_EQ(slow.stats[STAT_HEALTH], 70);
+    EXPECT_EQ(fast.stats[STAT_HEALTH], 100);
+
+    //twelve ties, the thirteenth throw wins, then press and clasp the reflection's hand
+    TestActor player;
+    std::vector<int> keys(1, 2);
+    for (unsigned i = 0; i < 13; ++i) keys.push_back(1 + i % 3);
+    keys.insert(keys.end(), {1, 1, 1});
+    ScriptedChooser script(keys);
+    unsigned steps = runEvent(pack, 30004, player, script, rng, nullptr);
+    ASSERT_EQ(player.items.size(), 1);
+    EXPECT_EQ(player.items[0], 20013);
+    EXPECT_GT(steps, 26);
+
+    //bots have to be able to finish every event
+    for (unsigned e = 0; e < pack.eventCount(); ++e) {
+        for (unsigned seed = 0; seed < 50; ++seed) {
+            TestActor bot;
+            RandomChooser chooser(seed);
+            EXPECT_LT(runEvent(pack, pack.eventAt(e).id, bot, chooser, rng, nullptr), EVENT_STEP_LIMIT);
+        }
+    }
+}
+
+//Check that broken packs are turned away with the line that's wrong
+TEST(RoomSuite, EventPackErrors) {
+    std::string error;
+    std::istringstream missing("event 1 Test\nnode start\ngoto nowhere\n");
+    EXPECT_FALSE(EventPack().parse(missing, error));
+    EXPECT_NE(error.find("nowhere"), std::string::npos);
+    std::istringstream unknown("event 1 Test\nnode start\ndance 3\n");
+    EXPECT_FALSE(EventPack().parse(unknown, error));
+    EXPECT_EQ(error.find("line 3"), 0);
+    std::istringstream fine("# a comment\nevent 1 Test\nnode start\nsay Hi {name}\n");
+    EventPack pack;
+    EXPECT_TRUE(pack.parse(fine, error));
+    EXPECT_EQ(pack.event(1).name, "Test");
+}
 #endif
@@ -2,6 +2,8 @@
 #define __TOWN_TESTS__
 
 #include "./../headers/Town.hpp"
+#include "./../headers/SaveGame.hpp"
+#include "./../headers/Journal.hpp"
 #include "./../source/Quest.cpp"
 #include "./../source/Warrior.cpp"
 
@@ -19,6 +21,318 @@ TEST(TownSuite, ConstructDestructTown) {
     delete test;
 }
 
+//Check that a town built in the background gets handed over, and that a town comes out of take() either way
+TEST(TownSuite, TownBuilderHandsOver) {
+    TownBuilder builder;
+    Town* fresh = builder.take(); //nothing started, built on the spot
+    EXPECT_TRUE(fresh != nullptr);
+    delete fresh;
+    builder.start(40);
+    builder.start(41); //the first town is thrown away
+    Town* built = builder.take();
+    EXPECT_TRUE(built != nullptr);
+    delete built;
+    builder.start(42); //never taken, cleaned up with the builder
+}
+
+//Check that the board's views come out sorted and filtered, that paging covers a view, and that accepting builds the posted quest
+TEST(TownSuite, QuestBoardViews) {
+    std::mt19937 rng(7);
+    QuestBoard board(100, rng);
+    ASSERT_EQ(board.size(), 100u);
+    Town sized(7, 30);
+    EXPECT_EQ(sized.getBoard().size(), 30u);
+
+    std::vector<unsigned> risky = board.view(SORT_RISK);
+    ASSERT_EQ(risky.size(), 100u);
+    for (unsigned i = 1; i < risky.size(); ++i) EXPECT_LE(board.at(risky[i - 1]).risk, board.at(risky[i]).risk);
+    std::vector<unsigned> value = board.view(SORT_REWARD_PER_RISK);
+    for (unsigned i = 1; i < value.size(); ++i) EXPECT_GE(board.at(value[i - 1]).rewardPerRisk(), board.at(value[i]).rewardPerRisk());
+    for (unsigned i = 0; i < board.size(); ++i) {
+        EXPECT_GE(board.at(i).reward, 50u);
+        EXPECT_LE(board.at(i).reward, 150u);
+    }
+
+    //the same seed posts the same quests on any thread, whatever that thread's spawnDice() was seeded with
+    std::mt19937 again(7);
+    QuestBoard* copy = nullptr;
+    std::thread([&]() { spawnDice().seed(99); copy = new QuestBoard(100, again); }).join();
+    for (unsigned i = 0; i < board.size(); ++i) {
+        EXPECT_EQ(copy->at(i).risk, board.at(i).risk);
+        EXPECT_EQ(copy->at(i).reward, board.at(i).reward);
+    }
+    delete copy;
+
+    unsigned total = 0;
+    for (unsigned boss = BOARD_FIRST_BOSS; boss < BOARD_FIRST_BOSS + BOARD_BOSS_KINDS; ++boss) {
+        std::vector<unsigned> only = board.view(SORT_RISK, boss);
+        for (unsigned i = 0; i < only.size(); ++i) EXPECT_EQ(board.at(only[i]).boss, boss);
+        total += only.size();
+    }
+    EXPECT_EQ(total, 100u);
+
+    unsigned pages = QuestBoard::pageCount(risky, 15), seen = 0;
+    EXPECT_EQ(pages, 7u);
+    for (unsigned p = 0; p < pages; ++p) {
+        std::vector<unsigned> page = QuestBoard::page(risky, p, 15);
+        for (unsigned i = 0; i < page.size(); ++i) EXPECT_EQ(page[i], risky[seen + i]);
+        seen += page.size();
+    }
+    EXPECT_EQ(seen, 100u);
+    EXPECT_TRUE(QuestBoard::page(risky, pages, 15).empty());
+
+    Quest* quest = board.accept(risky[0], 1);
+    EXPECT_EQ(quest->getBoss()->getName(), bossProfile(board.at(risky[0]).boss).name);
+    EXPECT_EQ(quest->getReward(), (int)board.at(risky[0]).reward);
+    EXPECT_EQ(quest->roomsBuilt(), 0u);
+    delete quest;
+}
+
+//Check that quests get played out for the hero, that the estimates are remembered, and that the board pays by them
+TEST(TownSuite, QuestEstimatesCalibrateRewards) {
+    Adventurer* hero = new Warrior("Test Warrior","Just a test warrior");
+    QuestEstimator estimator;
+    std::chrono::milliseconds plenty(2000);
+    std::vector<QuestPlan> plans{
+        QuestPlan{{10005}}, //a single Strange Fairy
+        QuestPlan{std::vector<unsigned>(12, 10008), std::vector<unsigned>(12, 10008)} //a swarm of Vampire Whelps, twice
+    };
+    std::vector<QuestEstimate> first = estimator.estimate(*hero, plans, plenty, 2);
+    ASSERT_EQ(first.size(), 2u);
+    EXPECT_EQ(first[0].runs, SIM_RUNS_PER_QUEST);
+    EXPECT_EQ(first[1].runs, SIM_RUNS_PER_QUEST);
+    EXPECT_EQ(first[0].winChance(), 1.0);
+    EXPECT_LT(first[1].winChance(), 0.1);
+    EXPECT_GT(first[1].averageHpLost(), first[0].averageHpLost());
+    EXPECT_EQ(hero->getCurrentHealth(), hero->getMaxHealth()); //only copies did the fighting
+    EXPECT_EQ(estimator.cached(), 2u);
+
+    std::vector<QuestEstimate> again = estimator.estimate(*hero, plans, plenty, 2);
+    EXPECT_EQ(again[1].wins, first[1].wins); //straight from the cache
+    hero->setHealth(0.5);
+    std::vector<QuestEstimate> hurt = estimator.estimate(*hero, plans, plenty, 2);
+    EXPECT_EQ(estimator.cached(), 2u); //quests are always played at full health, so being hurt doesn't change the price
+    EXPECT_EQ(hurt[1].wins, first[1].wins);
+    EXPECT_DOUBLE_EQ(hurt[1].hpLost, first[1].hpLost);
+
+    EXPECT_LT(calibratedReward(100, first[0], hero->getMaxHealth()), calibratedReward(100, first[1], hero->getMaxHealth()));
+
+    //an estimate the budget cut short is topped up by the next call instead of being handed back as it was
+    QuestEstimator hurried;
+    std::vector<QuestPlan> swarm{plans[1]};
+    QuestEstimate cut = hurried.estimate(*hero, swarm, std::chrono::milliseconds(1), 1)[0];
+    EXPECT_LE(cut.runs, SIM_RUNS_PER_QUEST);
+    QuestEstimate topped = hurried.estimate(*hero, swarm, plenty, 1)[0];
+    EXPECT_EQ(topped.runs, SIM_RUNS_PER_QUEST);
+    EXPECT_GE(topped.hpLost, cut.hpLost);
+
+    std::mt19937 rng(11);
+    QuestBoard board(6, rng);
+    board.calibrate(hero, std::vector<unsigned>{0, 2}, plenty);
+    EXPECT_EQ(board.at(1).estimate.runs, 0u); //quests that weren't asked for aren't built
+    EXPECT_EQ(board.at(1).reward, board.at(1).postedReward);
+    unsigned before = board.at(0).estimate.runs;
+    board.calibrate(hero, std::vector<unsigned>{0}, plenty);
+    EXPECT_EQ(board.at(0).estimate.runs, before); //already calibrated for this build
+    board.calibrate(hero, board.view(SORT_POSTED), plenty);
+    for (unsigned i = 0; i < board.size(); ++i) {
+        const QuestStub& q = board.at(i);
+        EXPECT_GT(q.estimate.runs, 0u);
+        EXPECT_EQ(q.reward, calibratedReward(q.postedReward, q.estimate, hero->getMaxHealth()));
+    }
+    std::vector<unsigned> value = board.view(SORT_REWARD_PER_RISK);
+    for (unsigned i = 1; i < value.size(); ++i) EXPECT_GE(board.at(value[i - 1]).rewardPerRisk(), board.at(value[i]).rewardPerRisk());
+    delete hero;
+}
+
+//Check that a save brings back the character, their bag, the town and their quest, and that broken saves are turned away
+TEST(TownSuite, SaveFileRoundTrip) {
+    const char* path = "test_save.sav";
+    ItemFactory items;
+    Adventurer* hero = new Samurai("TestSammy","Just a test sammy");
+    hero->applyLevels(5);
+    hero->addGold(123);
+    hero->setHealth(0.5);
+    for (int i = 0; i < 3; ++i) hero->addItem(items.generate(20004)); //one stack of three potions
+    Item* knife = items.generate(20013);
+    knife->ability(hero, nullptr); //unsheathed, which changes the knife
+    hero->addItem(knife);
+    Item* watch = items.generate(20016);
+    watch->setCooldown(3);
+    hero->addItem(watch);
+    for (int i = 0; i < 2000; ++i) hero->addItem(items.generate(20001)); //a slot each
+    Town* town = new Town(77);
+    town->restoreQuest(2, 6, 321);
+
+    ASSERT_TRUE(SaveGame::write(path, hero, town, 4567));
+    {
+        SaveFile save(path);
+        ASSERT_TRUE(save.valid()) << save.error();
+        EXPECT_EQ(save.header().score, 4567u);
+        EXPECT_EQ(save.slotCount(), 2003u);
+        Adventurer* back = SaveGame::hero(save);
+        EXPECT_EQ(back->getName(), hero->getName());
+        EXPECT_EQ(back->getLevel(), hero->getLevel());
+        EXPECT_EQ(back->getGold(), hero->getGold());
+        EXPECT_EQ(back->getCurrentHealth(), hero->getCurrentHealth());
+        EXPECT_EQ(back->getMaxHealth(), hero->getMaxHealth());
+        EXPECT_EQ(back->getPAtk(), hero->getPAtk());
+        EXPECT_EQ(back->getSpeed(), hero->getSpeed());
+        EXPECT_EQ(back->getInvSize(), hero->getInvSize());
+        EXPECT_EQ(back->itemsOnCooldown(), 1u);
+        EXPECT_TRUE(dynamic_cast<Samurai*>(back) != nullptr);
+        Town* backTown = SaveGame::town(save);
+        EXPECT_EQ(backTown->getSeed(), 77u);
+        EXPECT_EQ(backTown->getPicked(), 2);
+        EXPECT_EQ(backTown->getPickedReward(), 321u);
+        EXPECT_EQ(backTown->getBoard().at(2).seed, town->getBoard().at(2).seed);
+        delete backTown;
+        delete back;
+    }
+    MirrorKnife fresh;
+    fresh.loadState(knife->saveState());
+    EXPECT_EQ(fresh.getAbilityName(), knife->getAbilityName());
+    EXPECT_EQ(fresh.getPAtk(), knife->getPAtk());
+
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::string broken = bytes.substr(0, bytes.size() - 1);
+    std::ofstream(path, std::ios::binary).write(broken.data(), broken.size());
+    EXPECT_FALSE(SaveFile(path).valid());
+    broken = bytes;
+    broken[4] = 99; //the version
+    std::ofstream(path, std::ios::binary).write(broken.data(), broken.size());
+    SaveFile old(path);
+    EXPECT_FALSE(old.valid());
+    EXPECT_TRUE(old.exists());
+    broken = bytes;
+    uint32_t hugeBoard = 4000000000u; //a board nobody should try to post
+    memcpy(&broken[offsetof(SaveHeader, town) + offsetof(SavedTown, boardSize)], &hugeBoard, sizeof(hugeBoard));
+    std::ofstream(path, std::ios::binary).write(broken.data(), broken.size());
+    EXPECT_FALSE(SaveFile(path).valid());
+    EXPECT_FALSE(SaveFile("no_such_save.sav").exists());
+
+    remove(path);
+    delete town;
+    delete hero;
+}
+
+//Check that the journal replays on top of the save, that a torn or damaged tail is cut off, and that compaction folds it into the save
+TEST(TownSuite, AutosaveJournalReplay) {
+    const std::string path = "test_autosave.sav";
+    ItemFactory items;
+    Adventurer* hero = new Warrior("TestWarrior","Just a test warrior");
+    Town* town = new Town(5);
+    uint64_t score = 10;
+    {
+        Autosave autosave(path);
+        ASSERT_TRUE(autosave.compact(hero, town, score));
+        EXPECT_EQ(autosave.journalEntries(), 0u);
+        hero->addGold(50);
+        hero->addItem(items.generate(20004));
+        hero->addItem(items.generate(20004));
+        hero->addItem(items.generate(20008));
+        autosave.changed(hero, town);
+        town->restoreQuest(1, hero->getLevel(), 99);
+        autosave.questStarted(hero, town);
+        hero->addExp(5000);
+        autosave.roomCleared(hero, 3);
+        hero->setHealth(7);
+        autosave.roomCleared(hero, 7);
+        EXPECT_TRUE(autosave.active());
+        EXPECT_GT(autosave.journalEntries(), 5u);
+    }
+
+    std::string journal;
+    {
+        std::ifstream in(path + ".jnl", std::ios::binary);
+        journal.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto load = [&](JournalProgress& progress, Adventurer*& back, Town*& backTown, uint64_t& backScore) {
+        Autosave autosave(path);
+        ASSERT_TRUE(autosave.resume(back, backTown, backScore, progress));
+    };
+    auto same = [&](Adventurer* back, Town* backTown, uint64_t backScore) {
+        EXPECT_EQ(back->getGold(), hero->getGold());
+        EXPECT_EQ(back->getLevel(), hero->getLevel());
+        EXPECT_EQ(back->getMaxHealth(), hero->getMaxHealth());
+        EXPECT_EQ(back->getPDef(), hero->getPDef());
+        EXPECT_EQ(back->getInvSize(), hero->getInvSize());
+        EXPECT_EQ(backTown->getSeed(), 5u);
+        EXPECT_EQ(backTown->getPicked(), 1);
+        EXPECT_EQ(backTown->getPickedReward(), 99u);
+        EXPECT_EQ(backScore, score);
+    };
+
+    //the whole journal
+    JournalProgress progress;
+    Adventurer* back = nullptr;
+    Town* backTown = nullptr;
+    uint64_t backScore = 0;
+    load(progress, back, backTown, backScore);
+    same(back, backTown, backScore);
+    EXPECT_EQ(back->getCurrentHealth(), 7);
+    EXPECT_TRUE(progress.inQuest);
+    EXPECT_EQ(progress.cleared, std::vector<unsigned>({3, 7}));
+    EXPECT_FALSE(progress.torn);
+    delete back;
+    delete backTown;
+
+    //a half written entry at the end is thrown away and cut off
+    std::ofstream(path + ".jnl", std::ios::binary | std::ios::app).write("\x2a\x00\x00\x00\x0a\x00", 6);
+    load(progress, back, backTown, backScore);
+    EXPECT_TRUE(progress.torn);
+    EXPECT_EQ(progress.cleared, std::vector<unsigned>({3, 7}));
+    EXPECT_EQ(back->getCurrentHealth(), 7);
+    delete back;
+    delete backTown;
+    {
+        std::ifstream in(path + ".jnl", std::ios::binary | std::ios::ate);
+        EXPECT_EQ((size_t)in.tellg(), journal.size());
+    }
+
+    //a damaged last entry takes the last room with it
+    std::string damaged = journal;
+    damaged[damaged.size() - 1] ^= 0x40;
+    std::ofstream(path + ".jnl", std::ios::binary | std::ios::trunc).write(damaged.data(), damaged.size());
+    load(progress, back, backTown, backScore);
+    EXPECT_TRUE(progress.torn);
+    EXPECT_EQ(progress.cleared, std::vector<unsigned>({3}));
+    EXPECT_EQ(back->getCurrentHealth(), 7); //written down before the room was
+    delete back;
+    delete backTown;
+
+    //compaction puts everything into the save, and the old journal no longer matches it
+    std::ofstream(path + ".jnl", std::ios::binary | std::ios::trunc).write(journal.data(), journal.size());
+    {
+        Autosave autosave(path);
+        ASSERT_TRUE(autosave.resume(back, backTown, backScore, progress));
+        uint32_t generation = autosave.getGeneration();
+        score = 120;
+        autosave.questEnded(back, score);
+        ASSERT_TRUE(autosave.compact(back, backTown, score));
+        EXPECT_EQ(autosave.getGeneration(), generation + 1);
+        EXPECT_EQ(autosave.journalEntries(), 0u);
+        delete back;
+        delete backTown;
+    }
+    std::ofstream(path + ".jnl", std::ios::binary | std::ios::trunc).write(journal.data(), journal.size());
+    load(progress, back, backTown, backScore);
+    same(back, backTown, backScore);
+    EXPECT_FALSE(progress.inQuest);
+    EXPECT_EQ(progress.entries, 0u);
+    delete back;
+    delete backTown;
+
+    remove(path.c_str());
+    remove((path + ".jnl").c_str());
+    delete town;
+    delete hero;
+}
+
 //No expects are possible, needs player input.
 TEST(TownSuite, /*DISABLED_*/TownInputs) {
     Adventurer* testPlayer = new Warrior("Test Warrior","Just a test warrior");
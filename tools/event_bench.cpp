@@ -0,0 +1,57 @@
+/*
+ * event_bench: runs the oddity events over and over with a random bot and reports how many node transitions
+ * the interpreter gets through per second. Nothing gets printed while it runs.
+ * usage: event_bench [transitions] [pack file]
+ * Without a pack file it runs the pack that ships with the game.
+ */
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+#include "./../headers/Event.hpp"
+#include "./../headers/OddityEvents.hpp"
+
+// a player that never runs out of health or gold, so the bot can keep going
+class BenchActor : public EventActor {
+public:
+    int stats[NUM_EVENT_STATS] = {80, 120, 100, 0, 100, 100, 10};
+    std::string name() { return "Bench"; }
+    int stat(EventStat s) { return stats[s]; }
+    int apply(EventEffect /* effect */, int amount) { return amount; }
+};
+
+int main(int argc, char** argv) {
+    unsigned long long target = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000000ULL;
+    EventPack loaded;
+    const EventPack* pack = &oddityEvents();
+    if (argc > 2) {
+        std::string error;
+        if (!loaded.load(argv[2], error)) {
+            std::cout << "Could not load " << argv[2] << ", " << error << "\n";
+            return 1;
+        }
+        pack = &loaded;
+    }
+    if (pack->eventCount() == 0) {
+        std::cout << "The pack has no events.\n";
+        return 1;
+    }
+
+    BenchActor actor;
+    RandomChooser bot(1);
+    std::mt19937 rng(1);
+    unsigned long long transitions = 0, runs = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (transitions < target) {
+        transitions += runEvent(*pack, pack->eventAt(runs % pack->eventCount()).id, actor, bot, rng, nullptr);
+        ++runs;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << runs << " events, " << transitions << " transitions in " << seconds << "s\n"
+              << (unsigned long long)(transitions / seconds) << " transitions per second\n";
+    return 0;
+}
@@ -0,0 +1,447 @@
+/*
+ * seed_search: scans a range of town seeds for the ones that stand out. It builds the town for each seed, plays every quest on its
+ * board out a few times with a hero on autoTurn(), and keeps the most extreme of what it finds: the hardest and easiest quests and
+ * towns, the longest fights, the longest runs of unlikely rolls, fights that never end and quests that throw.
+ * Everything a seed does is rolled from the seed alone, so any line of the results can be played again and comes out the same.
+ * usage: seed_search [first seed] [seeds] [results file] [Warrior|Wizard|Samurai] [level] [runs per quest]
+ *        seed_search --check [results file]
+ * The results file starts with the settings it was made with and an index of where each category's lines are. --check plays
+ * every line of a results file again and reports the ones that don't come out the same, for regression testing.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <cstdlib>
+
+#include "./../headers/Town.hpp"
+#include "./../headers/Simulation.hpp"
+#include "./../headers/Console.hpp"
+#include "./../headers/Dice.hpp"
+#include "./../source/Warrior.cpp"
+#include "./../source/Wizard.cpp"
+#include "./../source/Samurai.cpp"
+
+// how many of each kind of find are kept
+const unsigned SEARCH_KEEP = 20;
+// how many seeds a thread takes at a time
+const unsigned SEARCH_CHUNK = 64;
+// a daily challenge should be hard, but a town the hero makes it back from less often than this is just unfair
+const double CHALLENGE_FLOOR = 0.3;
+
+const char* CLASS_NAMES[] = {"Warrior", "Wizard", "Samurai"};
+
+enum Category {HARDEST_QUEST, EASIEST_QUEST, HARDEST_TOWN, EASIEST_TOWN, CHALLENGE, LONGEST_FIGHT, UNLIKELY_STREAK,
+               STALEMATE, ERROR, NUM_CATEGORIES};
+const char* CATEGORY_NAMES[] = {"hardest-quest", "easiest-quest", "hardest-town", "easiest-town", "challenge", "longest-fight",
+                                "unlikely-streak", "stalemate", "error"};
+
+/**
+ * StreakWatch: rolls exactly what the dice would, while keeping track of the longest run of unlikely outcomes in a row:
+ * chance() rolls that went the way they usually don't. Since a script is in charge, flavorRoll() doesn't use up a roll, which
+ * only changes which lines of flavour text nobody is reading.
+ * */
+class StreakWatch : public DiceScript {
+private:
+    unsigned current = 0, longest = 0;
+
+public:
+    int roll(int sides){
+        return combatDice()() % sides;
+    }
+
+    bool chance(int percent){
+        bool happened = (int)(combatDice()() % 100) < percent;
+        bool unlikely = percent >= 50 ? !happened : happened;
+        current = unlikely ? current + 1 : 0;
+        longest = std::max(longest, current);
+        return happened;
+    }
+
+    unsigned longestStreak() const {
+        return longest;
+    }
+};
+
+/**
+ * QuestReport: how one quest on a town's board went over every run.
+ * */
+struct QuestReport {
+    unsigned runs = 0, wins = 0, stalemates = 0;
+    unsigned longestFight = 0, longestStreak = 0;
+    double hpLost = 0; // summed over every run, see QuestEstimate
+    std::string error; // what went wrong, if anything did
+
+    double winChance() const {
+        return runs == 0 ? 0 : (double)wins / runs;
+    }
+
+    double averageHpLost() const {
+        return runs == 0 ? 0 : hpLost / runs;
+    }
+};
+
+/**
+ * TownReport: how every quest on a town's board went.
+ * */
+struct TownReport {
+    unsigned seed;
+    std::vector<QuestReport> quests;
+
+    double winChance() const {
+        double sum = 0;
+        for (const QuestReport& quest : quests) sum += quest.winChance();
+        return quests.empty() ? 0 : sum / quests.size();
+    }
+};
+
+/**
+ * Finding: one thing worth remembering about a seed. quest is the position on the board, or -1 for the whole town.
+ * measure is what was found, written out the same way every time so a replay can be compared with it.
+ * */
+struct Finding {
+    double score; // higher is more extreme
+    unsigned seed;
+    int quest;
+    std::string measure;
+
+    /** Whether this finding ranks above another. Ties go to the lower seed, so the results don't depend on thread timing. */
+    bool operator<(const Finding& other) const {
+        if (score != other.score) return score > other.score;
+        if (seed != other.seed) return seed < other.seed;
+        return quest < other.quest;
+    }
+};
+
+/**
+ * Leaderboard: the SEARCH_KEEP most extreme findings of one category. Each thread fills its own, and they get merged once the
+ * threads are done, so nothing is ever shared while searching.
+ * */
+class Leaderboard {
+private:
+    std::vector<Finding> kept; // a heap with the least extreme finding on top
+
+public:
+    void offer(const Finding& finding){
+        if (kept.size() == SEARCH_KEEP && !(finding < kept.front())) return;
+        kept.push_back(finding);
+        std::push_heap(kept.begin(), kept.end());
+        if (kept.size() > SEARCH_KEEP){
+            std::pop_heap(kept.begin(), kept.end());
+            kept.pop_back();
+        }
+    }
+
+    void merge(const Leaderboard& other){
+        for (const Finding& finding : other.kept) offer(finding);
+    }
+
+    /** Returns the findings, most extreme first. */
+    std::vector<Finding> ranked() const {
+        std::vector<Finding> sorted = kept;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted;
+    }
+};
+
+/**
+ * SearchSettings: the hero every seed is tried with. Kept in the results file so --check plays it again the same way.
+ * */
+struct SearchSettings {
+    int heroClass = 0, level = 1;
+    unsigned runs = 4;
+};
+
+/** Makes the hero for a search, without printing the level-up summary. */
+Adventurer* makeHero(const SearchSettings& settings){
+    MutedOutput muted;
+    Adventurer* hero;
+    switch (settings.heroClass){
+        case 0: hero = new Warrior("Seeker", ""); break;
+        case 1: hero = new Wizard("Seeker", ""); break;
+        default: hero = new Samurai("Seeker", ""); break;
+    }
+    hero->applyLevels(settings.level - 1);
+    return hero;
+}
+
+/** Seeds both of the current thread's generators for one run of one quest. */
+void seedDice(unsigned town, unsigned quest, unsigned run){
+    std::seed_seq seq{town, quest, run};
+    unsigned seeds[2];
+    seq.generate(seeds, seeds + 2);
+    combatDice().seed(seeds[0]);
+    spawnDice().seed(seeds[1]);
+}
+
+/**
+ * playQuest(): plays one quest of a town out a number of times, every fight in a row like simulateQuest() does.
+ * args: town (the town), position (the quest on its board), hero (who takes it, left untouched), settings (how many runs)
+ * outputs: how it went. Anything the quest throws is caught and written into the report
+ * */
+QuestReport playQuest(const Town& town, unsigned position, const Adventurer& hero, const SearchSettings& settings){
+    QuestReport report;
+    try {
+        seedDice(town.getSeed(), position, ~0u);
+        Quest* quest = town.getBoard().accept(position, settings.level);
+        QuestPlan plan = quest->encounters();
+        delete quest;
+        if (plan.empty() || plan.back().empty()) throw std::runtime_error("the quest has no boss fight");
+
+        EnemyFactory enemies;
+        for (unsigned r = 0; r < settings.runs; ++r){
+            seedDice(town.getSeed(), position, r);
+            StreakWatch watch;
+            diceScript() = &watch;
+            Adventurer* copy = hero.clone();
+            int startHealth = copy->getCurrentHealth();
+            bool won = true;
+            for (unsigned f = 0; f < plan.size() && won; ++f){
+                std::vector<Enemy*> fight;
+                for (unsigned id : plan[f]){
+                    Enemy* e = enemies.generate(id);
+                    if (e == nullptr) throw std::runtime_error("there is no enemy " + std::to_string(id));
+                    fight.push_back(e);
+                }
+                unsigned turns = 0;
+                won = simulateFight(copy, fight, &turns);
+                report.longestFight = std::max(report.longestFight, turns);
+                report.stalemates += turns >= SIM_TURN_LIMIT;
+            }
+            diceScript() = nullptr;
+            report.runs++;
+            report.wins += won;
+            report.hpLost += won ? startHealth - std::max(0, copy->getCurrentHealth()) : startHealth;
+            report.longestStreak = std::max(report.longestStreak, watch.longestStreak());
+            delete copy;
+        }
+    }
+    catch (const std::exception& e){
+        diceScript() = nullptr;
+        report.error = e.what();
+    }
+    return report;
+}
+
+/** Builds the town for a seed and plays out every quest on its board. */
+TownReport playTown(unsigned seed, const Adventurer& hero, const SearchSettings& settings){
+    TownReport report;
+    report.seed = seed;
+    Town town(seed);
+    for (unsigned q = 0; q < town.getBoard().size(); ++q) report.quests.push_back(playQuest(town, q, hero, settings));
+    return report;
+}
+
+/** Writes a win chance and health lost out the way every measure has them. */
+std::string odds(double win, double hpLost){
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(1) << "win=" << win * 100 << "% hp=" << hpLost;
+    return text.str();
+}
+
+/**
+ * findings(): everything in a town's report worth ranking, by category.
+ * args: report (the town), found (filled in, one list per category)
+ * outputs: none
+ * */
+void findings(const TownReport& report, std::vector<std::vector<Finding> >& found){
+    found.assign(NUM_CATEGORIES, std::vector<Finding>());
+    double townWin = report.winChance(), townHp = 0;
+    for (unsigned q = 0; q < report.quests.size(); ++q){
+        const QuestReport& quest = report.quests[q];
+        townHp += quest.averageHpLost() / report.quests.size();
+        if (!quest.error.empty()){
+            found[ERROR].push_back(Finding{1, report.seed, (int)q, quest.error});
+            continue;
+        }
+        std::string measure = odds(quest.winChance(), quest.averageHpLost());
+        // health lost only breaks ties between quests that are won as often
+        found[HARDEST_QUEST].push_back(Finding{1 - quest.winChance() + quest.averageHpLost() * 1e-6, report.seed, (int)q, measure});
+        found[EASIEST_QUEST].push_back(Finding{quest.winChance() - quest.averageHpLost() * 1e-6, report.seed, (int)q, measure});
+        found[LONGEST_FIGHT].push_back(Finding{(double)quest.longestFight, report.seed, (int)q, "turns=" + std::to_string(quest.longestFight)});
+        found[UNLIKELY_STREAK].push_back(Finding{(double)quest.longestStreak, report.seed, (int)q, "streak=" + std::to_string(quest.longestStreak)});
+        if (quest.stalemates > 0){
+            found[STALEMATE].push_back(Finding{(double)quest.stalemates, report.seed, (int)q, "stalemates=" + std::to_string(quest.stalemates)});
+        }
+    }
+    std::string measure = odds(townWin, townHp);
+    found[HARDEST_TOWN].push_back(Finding{1 - townWin + townHp * 1e-6, report.seed, -1, measure});
+    found[EASIEST_TOWN].push_back(Finding{townWin - townHp * 1e-6, report.seed, -1, measure});
+    if (townWin >= CHALLENGE_FLOOR) found[CHALLENGE].push_back(Finding{1 - townWin + townHp * 1e-6, report.seed, -1, measure});
+}
+
+/**
+ * search(): plays every seed in a range on every core. Each thread takes SEARCH_CHUNK seeds at a time off a shared counter
+ * and ranks what it finds on its own leaderboards, which are merged once every thread is done.
+ * args: first, count (the seeds), hero (who plays them), settings (how), boards (filled in, one per category)
+ * outputs: none
+ * */
+void search(unsigned first, unsigned count, const Adventurer& hero, const SearchSettings& settings, std::vector<Leaderboard>& boards){
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::atomic<unsigned> next(0);
+    std::vector<std::vector<Leaderboard> > local(threads, std::vector<Leaderboard>(NUM_CATEGORIES));
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t){
+        workers.push_back(std::thread([&, t](){
+            MutedOutput muted;
+            std::vector<std::vector<Finding> > found;
+            for (unsigned start = next.fetch_add(SEARCH_CHUNK); start < count; start = next.fetch_add(SEARCH_CHUNK)){
+                for (unsigned i = start; i < count && i < start + SEARCH_CHUNK; ++i){
+                    findings(playTown(first + i, hero, settings), found);
+                    for (unsigned c = 0; c < NUM_CATEGORIES; ++c){
+                        for (const Finding& finding : found[c]) local[t][c].offer(finding);
+                    }
+                }
+            }
+        }));
+    }
+    for (auto& worker : workers) worker.join();
+
+    boards.assign(NUM_CATEGORIES, Leaderboard());
+    for (unsigned t = 0; t < threads; ++t){
+        for (unsigned c = 0; c < NUM_CATEGORIES; ++c) boards[c].merge(local[t][c]);
+    }
+}
+
+/**
+ * writeResults(): writes the results file. After the settings comes an index, one line per category with the line its findings
+ * start on and how many there are. Findings are tab separated: category, rank, town seed, quest (-1 for the town), measure.
+ * args: path (where to write), settings (the hero the seeds were played with), first, count (the seeds), boards (the findings)
+ * outputs: whether the file could be written
+ * */
+bool writeResults(const std::string& path, const SearchSettings& settings, unsigned first, unsigned count,
+                  const std::vector<Leaderboard>& boards){
+    std::ofstream file(path);
+    if (!file) return false;
+    file << "# seed_search " << CLASS_NAMES[settings.heroClass] << " " << settings.level << " " << settings.runs
+         << " seeds " << first << " to " << (unsigned long long)first + count - 1 << "\n";
+    unsigned line = 2 + NUM_CATEGORIES;
+    for (unsigned c = 0; c < NUM_CATEGORIES; ++c){
+        unsigned found = boards[c].ranked().size();
+        file << "# index " << CATEGORY_NAMES[c] << " " << (found > 0 ? line : 0) << " " << found << "\n";
+        line += found;
+    }
+    for (unsigned c = 0; c < NUM_CATEGORIES; ++c){
+        std::vector<Finding> ranked = boards[c].ranked();
+        for (unsigned r = 0; r < ranked.size(); ++r){
+            file << CATEGORY_NAMES[c] << "\t" << r + 1 << "\t" << ranked[r].seed << "\t" << ranked[r].quest << "\t" << ranked[r].measure << "\n";
+        }
+    }
+    return (bool)file;
+}
+
+/**
+ * check(): plays every finding in a results file again and compares what comes out with what was written down.
+ * args: path (the results file)
+ * outputs: the exit code, 0 if every finding came out the same
+ * */
+int check(const std::string& path){
+    std::ifstream file(path);
+    std::string line, word;
+    SearchSettings settings;
+    if (!file || !std::getline(file, line)){
+        std::cout << "Could not read " << path << "\n";
+        return 1;
+    }
+    std::istringstream header(line);
+    std::string className;
+    header >> word >> word >> className >> settings.level >> settings.runs;
+    settings.heroClass = -1;
+    for (int c = 0; c < 3; ++c) if (className == CLASS_NAMES[c]) settings.heroClass = c;
+    if (settings.heroClass == -1 || settings.level < 1 || settings.runs == 0){
+        std::cout << path << " doesn't start with seed_search's settings\n";
+        return 1;
+    }
+
+    Adventurer* hero = makeHero(settings);
+
+    MutedOutput muted;
+    unsigned checked = 0, differ = 0;
+    std::vector<std::vector<Finding> > found;
+    while (std::getline(file, line)){
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string category, rank, seed, quest, measure;
+        std::getline(fields, category, '\t');
+        std::getline(fields, rank, '\t');
+        std::getline(fields, seed, '\t');
+        std::getline(fields, quest, '\t');
+        std::getline(fields, measure);
+        unsigned c = std::find(CATEGORY_NAMES, CATEGORY_NAMES + NUM_CATEGORIES, category) - CATEGORY_NAMES;
+        if (c == NUM_CATEGORIES){
+            std::cout << "Unknown category on: " << line << "\n";
+            ++differ;
+            continue;
+        }
+
+        findings(playTown(std::strtoul(seed.c_str(), nullptr, 10), *hero, settings), found);
+        int position = std::atoi(quest.c_str());
+        std::string now = "(not found)";
+        for (const Finding& finding : found[c]) if (finding.quest == position) now = finding.measure;
+        ++checked;
+        if (now != measure){
+            std::cout << category << " seed " << seed << " quest " << quest << ": was " << measure << ", now " << now << "\n";
+            ++differ;
+        }
+    }
+    delete hero;
+    std::cout << checked << " findings played again, " << differ << " came out differently\n";
+    return differ == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv){
+    if (argc > 1 && std::string(argv[1]) == "--check") return check(argc > 2 ? argv[2] : "seed_search.tsv");
+
+    unsigned first = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+    unsigned count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    std::string path = argc > 3 ? argv[3] : "seed_search.tsv";
+    SearchSettings settings;
+    if (argc > 4){
+        settings.heroClass = std::find(CLASS_NAMES, CLASS_NAMES + 3, std::string(argv[4])) - CLASS_NAMES;
+    }
+    if (argc > 5) settings.level = std::atoi(argv[5]);
+    if (argc > 6) settings.runs = std::strtoul(argv[6], nullptr, 10);
+    if (count == 0 || settings.heroClass == 3 || settings.level < 1 || settings.level > LEVEL_CAP || settings.runs == 0){
+        std::cout << "usage: seed_search [first seed] [seeds] [results file] [Warrior|Wizard|Samurai] [level] [runs per quest]\n"
+                  << "       seed_search --check [results file]\n";
+        return 1;
+    }
+
+    Adventurer* hero = makeHero(settings);
+
+    std::vector<Leaderboard> boards;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    search(first, count, *hero, settings, boards);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    delete hero;
+
+    std::cout << count << " towns, " << (unsigned long long)count * Town::BOARD_SIZE * settings.runs << " quest runs in "
+              << seconds << "s (" << (unsigned)(count / seconds) << " towns/s)\n";
+    for (unsigned c = 0; c < NUM_CATEGORIES; ++c){
+        std::vector<Finding> ranked = boards[c].ranked();
+        std::cout << "\n" << CATEGORY_NAMES[c] << ":" << (ranked.empty() ? " none" : "") << "\n";
+        for (unsigned r = 0; r < ranked.size() && r < 3; ++r){
+            std::cout << "  town " << ranked[r].seed;
+            if (ranked[r].quest >= 0) std::cout << ", quest " << ranked[r].quest + 1;
+            std::cout << ": " << ranked[r].measure << "\n";
+        }
+    }
+    std::vector<Finding> challenge = boards[CHALLENGE].ranked();
+    if (!challenge.empty()) std::cout << "\nDaily challenge: town " << challenge.front().seed << "\n";
+
+    if (!writeResults(path, settings, first, count, boards)){
+        std::cout << "Could not write " << path << "\n";
+        return 1;
+    }
+    std::cout << "Results written to " << path << "\n";
+    return 0;
+}
@@ -0,0 +1,480 @@
+/*
+ * tuner: searches for enemy stats and class growth numbers that make fights come out the way they are meant to.
+ * It reads a list of target win rates, plays every fight out headless a few hundred times for each candidate, and evolves
+ * the candidates with a (mu + lambda) evolution strategy. Candidates are scored on all cores and remembered, so the parents
+ * that carry over from one generation to the next cost nothing.
+ * usage: tuner [targets file] [generations] [runs per fight]
+ * A targets file has one fight per line, '#' starts a comment:
+ *     <Warrior|Wizard|Samurai> <level> <enemy id>... = <percent>[-<percent>]
+ * for example "Warrior 1 10001 = 95" or "Samurai 3 10004 10001 = 60-70". Without a file it tunes a small built-in set.
+ * Only the enemies that show up in a target and the growth of classes that are tried past level 1 get changed.
+ * At the end it prints the proposed values, ready to be copied into the Enemy.cpp constructors and the *_GROWTH constants.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#include "./../headers/Factory.hpp"
+#include "./../headers/Console.hpp"
+#include "./../headers/Simulation.hpp"
+#include "./../source/Warrior.cpp"
+#include "./../source/Wizard.cpp"
+#include "./../source/Samurai.cpp"
+
+// how many candidates survive each generation, and how many children they have between them
+const unsigned TUNER_PARENTS = 8;
+const unsigned TUNER_CHILDREN = 32;
+// how far a mutation moves a value, as a fraction of it. It grows while nothing better turns up and shrinks when something does
+const double TUNER_STEP_START = 0.2, TUNER_STEP_MIN = 0.02, TUNER_STEP_MAX = 1.5;
+// how much staying close to the current numbers counts for, next to hitting the targets
+const double TUNER_STAY_CLOSE = 0.002;
+
+const char* CLASS_NAMES[] = {"Warrior", "Wizard", "Samurai"};
+const char* GROWTH_NAMES[] = {"WARRIOR_GROWTH", "WIZARD_GROWTH", "SAMURAI_GROWTH"};
+const char* STAT_NAMES[] = {"maxHealth", "physAtk", "physDef", "magAtk", "magDef", "speed"};
+const int STATS = 6;
+
+/**
+ * Target: one fight and the win rate it should have.
+ * */
+struct Target {
+    int heroClass, level;
+    std::vector<unsigned> enemies;
+    double low, high;
+    std::string line;
+};
+
+/**
+ * Genome: every value being tuned. Enemy stats are in the order of STAT_NAMES, growth in the order of StatGrowth.
+ * Enemy speed is the middle of the range the constructor rolls in, the jitter is added back on when a fight is set up.
+ * */
+struct Genome {
+    std::vector<int> values;
+
+    bool operator==(const Genome& other) const {
+        return values == other.values;
+    }
+};
+
+struct GenomeHash {
+    size_t operator()(const Genome& genome) const {
+        size_t seed = genome.values.size();
+        for (int v : genome.values) seed ^= std::hash<int>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
+/**
+ * Layout: which value in a genome is which.
+ * */
+struct Layout {
+    std::vector<unsigned> enemies; // the enemy IDs being tuned, STATS values each
+    std::vector<int> classes; // the classes whose growth is being tuned, STATS values each, after the enemies
+    std::map<unsigned, int> enemyAt; // enemy ID -> position of its first value
+    std::map<int, int> classAt; // class -> position of its first value
+    std::vector<int> floor; // the smallest each value may go
+};
+
+/** Makes a level 1 hero of a class. */
+Adventurer* makeHero(int heroClass){
+    switch (heroClass){
+        case 0: return new Warrior("Tuner", "");
+        case 1: return new Wizard("Tuner", "");
+        default: return new Samurai("Tuner", "");
+    }
+}
+
+/** Parses "95" or "60-70" into a range of win rates. */
+bool parseRange(const std::string& text, double& low, double& high){
+    std::size_t dash = text.find('-');
+    char* end = nullptr;
+    low = std::strtod(text.substr(0, dash).c_str(), &end) / 100;
+    if (*end != '\0' && *end != '%') return false;
+    high = low;
+    if (dash != std::string::npos){
+        high = std::strtod(text.substr(dash + 1).c_str(), &end) / 100;
+        if (*end != '\0' && *end != '%') return false;
+    }
+    return low >= 0 && high <= 1 && low <= high;
+}
+
+/**
+ * parseTargets(): reads targets, one per line.
+ * args: in (where to read from), targets (filled in), error (set to what went wrong)
+ * outputs: whether every line made sense
+ * */
+bool parseTargets(std::istream& in, std::vector<Target>& targets, std::string& error){
+    std::string line;
+    for (unsigned number = 1; std::getline(in, line); ++number){
+        std::string text = line.substr(0, line.find('#'));
+        std::istringstream words(text);
+        std::string name;
+        if (!(words >> name)) continue;
+
+        Target target;
+        target.line = text.substr(0, text.find_last_not_of(" \t\r") + 1);
+        target.heroClass = -1;
+        for (int c = 0; c < 3; ++c) if (name == CLASS_NAMES[c]) target.heroClass = c;
+        std::string word;
+        bool ranged = false;
+        if (target.heroClass != -1 && words >> target.level){
+            while (words >> word){
+                if (word == "="){
+                    ranged = words >> word && parseRange(word, target.low, target.high);
+                    break;
+                }
+                unsigned id = std::strtoul(word.c_str(), nullptr, 10);
+                if (id < 10001 || id >= 10001 + NUM_ENEMIES) break;
+                target.enemies.push_back(id);
+            }
+        }
+        if (!ranged || target.enemies.empty() || target.level < 1 || target.level > LEVEL_CAP){
+            error = "line " + std::to_string(number) + " should look like \"Warrior 1 10001 = 95\"";
+            return false;
+        }
+        targets.push_back(target);
+    }
+    if (targets.empty()) error = "there are no targets";
+    return !targets.empty();
+}
+
+/**
+ * Tuner: scores genomes against the targets and evolves them.
+ * */
+class Tuner {
+private:
+    std::vector<Target> targets;
+    Layout layout;
+    Genome original;
+    unsigned runs;
+    std::unordered_map<Genome, double, GenomeHash> scored;
+    unsigned long fights = 0;
+    std::vector<Adventurer*> recruits; // a level 1 hero for each target, made up front so workers only ever copy them
+
+    /** Plays one target out (runs) times with the values in a genome. Every genome gets the same dice, run for run. */
+    double winRate(const Genome& genome, unsigned t, EnemyFactory& factory) const {
+        const Target& target = targets[t];
+        Adventurer* hero = recruits[t]->clone();
+        std::map<int, int>::const_iterator growthAt = layout.classAt.find(target.heroClass);
+        if (growthAt != layout.classAt.end()){
+            const int* g = &genome.values[growthAt->second];
+            hero->setGrowth(StatGrowth{g[0], g[1], g[2], g[3], g[4], g[5]});
+        }
+        hero->applyLevels(target.level - 1); // prints to gameOut(), which the workers have muted
+
+        unsigned wins = 0;
+        for (unsigned r = 0; r < runs; ++r){
+            std::minstd_rand dice(t * 1000003u + r + 1);
+            std::vector<Enemy*> enemies;
+            for (unsigned id : target.enemies){
+                Enemy* e = factory.generate(id);
+                const int* v = &genome.values[layout.enemyAt.at(id)];
+                EnemyState state = e->captureEnemyState();
+                state.entity.maxHealth = state.entity.health = v[0];
+                state.entity.physAtk = v[1];
+                state.entity.physDef = v[2];
+                state.entity.magAtk = v[3];
+                state.entity.magDef = v[4];
+                state.entity.speed = v[5] + (int)(dice() % 10) - 5;
+                e->restoreEnemyState(state);
+                enemies.push_back(e);
+            }
+            combatDice().seed(dice());
+            Adventurer* copy = hero->clone();
+            wins += simulateFight(copy, enemies);
+            delete copy;
+        }
+        delete hero;
+        return (double)wins / runs;
+    }
+
+    /** How far off the targets a genome is, plus a little for every value it moved. Lower is better. */
+    double score(const Genome& genome, std::vector<double>* rates, EnemyFactory& factory) const {
+        double miss = 0;
+        for (unsigned t = 0; t < targets.size(); ++t){
+            double rate = winRate(genome, t, factory);
+            if (rates != nullptr) rates->push_back(rate);
+            double off = rate < targets[t].low ? targets[t].low - rate : rate > targets[t].high ? rate - targets[t].high : 0;
+            miss += off * off;
+        }
+        double moved = 0;
+        for (unsigned i = 0; i < genome.values.size(); ++i){
+            if (original.values[i] == genome.values[i]) continue;
+            double ratio = std::log((genome.values[i] + 1.0) / (original.values[i] + 1.0));
+            moved += ratio * ratio;
+        }
+        return miss + TUNER_STAY_CLOSE * moved;
+    }
+
+public:
+    Tuner(const std::vector<Target>& targets, unsigned runs) : targets(targets), runs(runs) {
+        for (const Target& target : targets) recruits.push_back(makeHero(target.heroClass));
+        EnemyFactory factory;
+        for (const Target& target : targets){
+            for (unsigned id : target.enemies){
+                if (layout.enemyAt.count(id) > 0) continue;
+                layout.enemyAt[id] = original.values.size();
+                layout.enemies.push_back(id);
+                // the constructors roll speed from (middle - 5) to (middle + 4), so the slowest of a few hundred is 5 under the middle
+                int slowest = 1 << 30;
+                for (int i = 0; i < 500; ++i){
+                    Enemy* e = factory.generate(id);
+                    slowest = std::min(slowest, e->getSpeed());
+                    if (i == 0){
+                        int stats[] = {e->getMaxHealth(), e->getPAtk(), e->getPDef(), e->getMAtk(), e->getMDef()};
+                        original.values.insert(original.values.end(), stats, stats + 5);
+                    }
+                    delete e;
+                }
+                original.values.push_back(slowest + 5);
+                int floor[] = {1, 0, 0, 0, 0, 6};
+                layout.floor.insert(layout.floor.end(), floor, floor + STATS);
+            }
+        }
+        for (const Target& target : targets){
+            if (target.level <= 1 || layout.classAt.count(target.heroClass) > 0) continue;
+            layout.classAt[target.heroClass] = original.values.size();
+            layout.classes.push_back(target.heroClass);
+            Adventurer* hero = makeHero(target.heroClass);
+            const StatGrowth& g = hero->getGrowth();
+            int growth[] = {g.hp, g.pAtk, g.pDef, g.mAtk, g.mDef, g.spd};
+            original.values.insert(original.values.end(), growth, growth + STATS);
+            layout.floor.insert(layout.floor.end(), STATS, 0);
+            delete hero;
+        }
+    }
+
+    ~Tuner(){
+        for (auto hero : recruits) delete hero;
+    }
+
+    Tuner(const Tuner&) = delete;
+    Tuner& operator=(const Tuner&) = delete;
+
+    const Genome& start() const {
+        return original;
+    }
+
+    /** Returns how many fights have been played out so far. */
+    unsigned long played() const {
+        return fights;
+    }
+
+    /**
+     * evaluate(): scores a batch of genomes on every core. Genomes scored before are looked up rather than played again.
+     * args: batch (the genomes)
+     * outputs: their scores, in the same order
+     * */
+    std::vector<double> evaluate(const std::vector<Genome>& batch){
+        std::vector<double> result(batch.size());
+        std::vector<unsigned> pending;
+        for (unsigned i = 0; i < batch.size(); ++i){
+            std::unordered_map<Genome, double, GenomeHash>::iterator it = scored.find(batch[i]);
+            if (it != scored.end()) result[i] = it->second;
+            else if (std::find_if(pending.begin(), pending.end(), [&](unsigned p){ return batch[p] == batch[i]; }) == pending.end()){
+                pending.push_back(i);
+            }
+        }
+
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        std::atomic<unsigned> next(0);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t){
+            workers.push_back(std::thread([&](){
+                MutedOutput muted;
+                EnemyFactory factory;
+                for (unsigned job = next++; job < pending.size(); job = next++){
+                    result[pending[job]] = score(batch[pending[job]], nullptr, factory);
+                }
+            }));
+        }
+        for (auto& worker : workers) worker.join();
+
+        for (unsigned i : pending) scored[batch[i]] = result[i];
+        for (unsigned i = 0; i < batch.size(); ++i) result[i] = scored[batch[i]];
+        fights += (unsigned long)pending.size() * targets.size() * runs;
+        return result;
+    }
+
+    /** Plays every target out for a genome and returns the win rates. */
+    std::vector<double> rates(const Genome& genome){
+        MutedOutput muted;
+        EnemyFactory factory;
+        std::vector<double> found;
+        score(genome, &found, factory);
+        return found;
+    }
+
+    /**
+     * mutate(): makes a child of a genome. Half the time one enemy or class gets all of its values scaled together, so it gets
+     * stronger or weaker as a whole. Otherwise a few values move on their own. Either way they move by a random fraction of
+     * themselves, at least by 1.
+     * args: parent (the genome), step (how big the fractions are, as a standard deviation in log space), rng (the dice)
+     * outputs: the child, which always differs from the parent
+     * */
+    Genome mutate(const Genome& parent, double step, std::mt19937& rng) const {
+        Genome child = parent;
+        std::normal_distribution<double> jump(0, step);
+        std::vector<double> scale(child.values.size(), 0);
+        if (rng() % 2 == 0){
+            unsigned block = rng() % (child.values.size() / STATS);
+            double together = jump(rng);
+            for (int s = 0; s < STATS; ++s) scale[block * STATS + s] = together;
+        }
+        else {
+            std::bernoulli_distribution change(std::min(1.0, 3.0 / child.values.size()));
+            for (unsigned i = 0; i < child.values.size(); ++i) scale[i] = change(rng) ? jump(rng) : 0;
+        }
+
+        bool changed = false;
+        for (unsigned i = 0; i < child.values.size(); ++i){
+            if (scale[i] == 0) continue;
+            int old = child.values[i];
+            int moved = (int)std::lround(old * std::exp(scale[i]));
+            if (moved == old) moved += scale[i] < 0 ? -1 : 1;
+            child.values[i] = std::max(layout.floor[i], moved);
+            changed = changed || child.values[i] != old;
+        }
+        return changed ? child : mutate(parent, step, rng);
+    }
+
+    /**
+     * printPatch(): prints the values that differ from the original, laid out to match the source they go back into.
+     * args: best (the best genome found), reached (whether it hits every target)
+     * outputs: none
+     * */
+    void printPatch(const Genome& best, bool reached) const {
+        EnemyFactory factory;
+        bool any = false;
+        for (unsigned id : layout.enemies){
+            int at = layout.enemyAt.at(id);
+            Enemy* e = factory.generate(id);
+            std::string changes;
+            for (int s = 0; s < STATS; ++s){
+                int before = original.values[at + s], after = best.values[at + s];
+                if (before == after) continue;
+                changes += "    " + std::string(STAT_NAMES[s]) + " = " + std::to_string(after);
+                if (s == 5) changes += " + (int)(spawnDice()() % 10) - 5";
+                changes += ";    // was " + std::to_string(before) + "\n";
+            }
+            if (!changes.empty()){
+                std::cout << "source/Enemy.cpp, " << e->getName() << " (" << id << "):\n" << changes;
+                any = true;
+            }
+            delete e;
+        }
+        for (int heroClass : layout.classes){
+            int at = layout.classAt.at(heroClass);
+            std::string before, after;
+            for (int s = 0; s < STATS; ++s){
+                before += (s ? ", " : "") + std::to_string(original.values[at + s]);
+                after += (s ? ", " : "") + std::to_string(best.values[at + s]);
+            }
+            if (before == after) continue;
+            std::cout << "source/" << CLASS_NAMES[heroClass] << ".cpp:\n"
+                      << "const StatGrowth " << GROWTH_NAMES[heroClass] << " = {" << after << "};    // was {" << before << "}\n";
+            any = true;
+        }
+        if (!reached) std::cout << (any ? "These come closest, but " : "Nothing found did better than the current values, and ")
+                                << "not every target was reached.\n";
+        else if (!any) std::cout << "Nothing needs to change.\n";
+    }
+
+    const std::vector<Target>& getTargets() const {
+        return targets;
+    }
+};
+
+/** The targets tuned when no file is given. */
+const char* DEFAULT_TARGETS =
+    "Warrior 1 10001 = 95\n"
+    "Wizard 1 10001 = 90-97\n"
+    "Samurai 1 10002 10009 = 85-95\n"
+    "Warrior 3 10004 10001 = 60-70\n"
+    "Samurai 3 10007 10002 = 60-70\n";
+
+int main(int argc, char** argv){
+    std::vector<Target> targets;
+    std::string error;
+    bool parsed;
+    if (argc > 1){
+        std::ifstream file(argv[1]);
+        if (!file){
+            std::cout << "Could not open " << argv[1] << "\n";
+            return 1;
+        }
+        parsed = parseTargets(file, targets, error);
+    }
+    else {
+        std::istringstream builtIn(DEFAULT_TARGETS);
+        parsed = parseTargets(builtIn, targets, error);
+    }
+    if (!parsed){
+        std::cout << "Could not read the targets, " << error << "\n";
+        return 1;
+    }
+    unsigned generations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 40;
+    unsigned runs = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 400;
+    if (generations == 0 || runs == 0){
+        std::cout << "usage: tuner [targets file] [generations] [runs per fight]\n";
+        return 1;
+    }
+
+    Tuner tuner(targets, runs);
+    std::vector<double> startRates = tuner.rates(tuner.start());
+
+    std::mt19937 rng(1);
+    std::vector<Genome> parents(1, tuner.start());
+    std::vector<double> parentScores;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    double step = TUNER_STEP_START;
+    for (unsigned gen = 0; gen < generations; ++gen){
+        std::vector<Genome> batch = parents;
+        for (unsigned c = 0; c < TUNER_CHILDREN; ++c) batch.push_back(tuner.mutate(parents[rng() % parents.size()], step, rng));
+
+        std::vector<double> scores = tuner.evaluate(batch);
+
+        // the best few go on, parents included, so a generation never does worse than the one before
+        std::vector<unsigned> order(batch.size());
+        for (unsigned i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b){ return scores[a] < scores[b]; });
+        double previous = parentScores.empty() ? 1e9 : parentScores.front();
+        parents.clear();
+        parentScores.clear();
+        for (unsigned i = 0; i < order.size() && parents.size() < TUNER_PARENTS; ++i){
+            if (std::find(parents.begin(), parents.end(), batch[order[i]]) != parents.end()) continue;
+            parents.push_back(batch[order[i]]);
+            parentScores.push_back(scores[order[i]]);
+        }
+        step = parentScores.front() < previous ? std::max(TUNER_STEP_MIN, step * 0.8) : std::min(TUNER_STEP_MAX, step * 1.3);
+        std::cout << "generation " << gen + 1 << ": best score " << parentScores.front() << "\n";
+        if (parentScores.front() == 0) break;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<double> endRates = tuner.rates(parents.front());
+
+    std::cout << "\n" << tuner.played() << " fights in " << seconds << "s\n\nWin rates, before -> after:\n";
+    bool reached = true;
+    for (unsigned t = 0; t < targets.size(); ++t){
+        bool hit = endRates[t] >= targets[t].low && endRates[t] <= targets[t].high;
+        reached = reached && hit;
+        std::cout << "  " << targets[t].line << ":\t" << (int)std::lround(startRates[t] * 100) << "% -> "
+                  << (int)std::lround(endRates[t] * 100) << "%" << (hit ? "" : "\t(missed)") << "\n";
+    }
+    std::cout << "\nProposed values:\n";
+    tuner.printPatch(parents.front(), reached);
+    return 0;
+}